@@ -30,6 +30,7 @@ public class LyraNPC : ModuleRules
 				"AIModule",
 				"GameplayTasks",
 				"GameplayTags",
+				"DeveloperSettings",
 				"NavigationSystem",
 				"Niagara",
 				"UMG",
@@ -4,6 +4,7 @@
 #include "AIController.h"
 #include "Core/LyraNPCCharacter.h"
 #include "Components/LyraNPCNeedsComponent.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 #include "LyraNPCModule.h"
 
 ULyraNPCBTDecorator_CheckNeed::ULyraNPCBTDecorator_CheckNeed()
@@ -13,6 +14,7 @@ ULyraNPCBTDecorator_CheckNeed::ULyraNPCBTDecorator_CheckNeed()
 
 bool ULyraNPCBTDecorator_CheckNeed::CalculateRawConditionValue(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
 {
+	LYRANPC_SCOPE_FRAME_COST(&OwnerComp);
 	AAIController* AIController = OwnerComp.GetAIOwner();
 	if (!AIController)
 	{
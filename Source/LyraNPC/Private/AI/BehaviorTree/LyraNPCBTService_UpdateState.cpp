@@ -3,6 +3,7 @@
 #include "AI/BehaviorTree/LyraNPCBTService_UpdateState.h"
 #include "BehaviorTree/BlackboardComponent.h"
 #include "AI/Controllers/LyraNPCAIController.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 #include "LyraNPCModule.h"
 
 ULyraNPCBTService_UpdateState::ULyraNPCBTService_UpdateState()
@@ -16,6 +17,7 @@ ULyraNPCBTService_UpdateState::ULyraNPCBTService_UpdateState()
 
 void ULyraNPCBTService_UpdateState::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
 {
+	LYRANPC_SCOPE_FRAME_COST(&OwnerComp);
 	Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
 
 	ALyraNPCAIController* AIController = Cast<ALyraNPCAIController>(OwnerComp.GetAIOwner());
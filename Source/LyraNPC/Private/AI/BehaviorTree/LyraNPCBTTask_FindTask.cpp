@@ -8,19 +8,30 @@
 #include "Components/LyraNPCScheduleComponent.h"
 #include "Tasks/LyraNPCTaskActor.h"
 #include "Systems/LyraNPCWorldSubsystem.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 #include "LyraNPCModule.h"
 
 ULyraNPCBTTask_FindTask::ULyraNPCBTTask_FindTask()
 {
 	NodeName = "Find Best Task";
+	bNotifyTaskFinished = true;
 
 	// Setup blackboard key filters
 	TargetTaskKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(ULyraNPCBTTask_FindTask, TargetTaskKey), UObject::StaticClass());
 	TaskLocationKey.AddVectorFilter(this, GET_MEMBER_NAME_CHECKED(ULyraNPCBTTask_FindTask, TaskLocationKey));
 }
 
+uint16 ULyraNPCBTTask_FindTask::GetInstanceMemorySize() const
+{
+	return sizeof(FTaskMemory);
+}
+
 EBTNodeResult::Type ULyraNPCBTTask_FindTask::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
+	LYRANPC_SCOPE_FRAME_COST(&OwnerComp);
+	FTaskMemory* Memory = reinterpret_cast<FTaskMemory*>(NodeMemory);
+	Memory->SearchRequestId = 0;
+
 	ALyraNPCAIController* AIController = Cast<ALyraNPCAIController>(OwnerComp.GetAIOwner());
 	if (!AIController)
 	{
@@ -33,6 +44,80 @@ EBTNodeResult::Type ULyraNPCBTTask_FindTask::ExecuteTask(UBehaviorTreeComponent&
 		return EBTNodeResult::Failed;
 	}
 
+	const FGameplayTag SearchTag = GetSearchTag(NPC);
+
+	// Use world subsystem for optimized search
+	ULyraNPCWorldSubsystem* WorldSubsystem = NPC->GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>();
+	if (!WorldSubsystem)
+	{
+		// Fallback to controller's search
+		return ApplyFoundTask(OwnerComp, NPC, AIController->FindBestTask(SearchTag));
+	}
+
+	if (bUseBatchedSearch)
+	{
+		Memory->SearchRequestId = WorldSubsystem->RequestBestTaskForNPC(NPC, SearchTag, SearchRadius,
+			FLyraNPCTaskSearchDelegate::CreateUObject(this, &ULyraNPCBTTask_FindTask::OnBatchedSearchComplete, TWeakObjectPtr<UBehaviorTreeComponent>(&OwnerComp), NodeMemory));
+		return EBTNodeResult::InProgress;
+	}
+
+	// Immediate searches follow the same assignment setting as queued ones
+	ULyraNPCTaskActor* BestTask = WorldSubsystem->bAssignQueuedTaskSearches
+		? WorldSubsystem->AssignTaskToNPC(NPC, SearchTag, SearchRadius)
+		: WorldSubsystem->FindBestTaskForNPC(NPC, SearchTag, SearchRadius);
+	return ApplyFoundTask(OwnerComp, NPC, BestTask);
+}
+
+EBTNodeResult::Type ULyraNPCBTTask_FindTask::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FTaskMemory* Memory = reinterpret_cast<FTaskMemory*>(NodeMemory);
+
+	if (Memory->SearchRequestId != 0)
+	{
+		if (ULyraNPCWorldSubsystem* WorldSubsystem = OwnerComp.GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>())
+		{
+			WorldSubsystem->CancelTaskSearch(Memory->SearchRequestId);
+		}
+		Memory->SearchRequestId = 0;
+	}
+
+	return EBTNodeResult::Aborted;
+}
+
+void ULyraNPCBTTask_FindTask::OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult)
+{
+	Super::OnTaskFinished(OwnerComp, NodeMemory, TaskResult);
+
+	// A task assigned but not handed on to the tree would otherwise stay reserved until it times out
+	if (TaskResult != EBTNodeResult::Succeeded)
+	{
+		ReleaseTaskReservation(OwnerComp);
+	}
+}
+
+void ULyraNPCBTTask_FindTask::OnBatchedSearchComplete(ULyraNPCTaskActor* BestTask, TWeakObjectPtr<UBehaviorTreeComponent> OwnerComp, uint8* NodeMemory)
+{
+	UBehaviorTreeComponent* OwnerCompPtr = OwnerComp.Get();
+	if (!OwnerCompPtr) return;
+
+	reinterpret_cast<FTaskMemory*>(NodeMemory)->SearchRequestId = 0;
+
+	ALyraNPCCharacter* NPC = OwnerCompPtr->GetAIOwner() ? Cast<ALyraNPCCharacter>(OwnerCompPtr->GetAIOwner()->GetPawn()) : nullptr;
+	FinishLatentTask(*OwnerCompPtr, NPC ? ApplyFoundTask(*OwnerCompPtr, NPC, BestTask) : EBTNodeResult::Failed);
+}
+
+void ULyraNPCBTTask_FindTask::ReleaseTaskReservation(UBehaviorTreeComponent& OwnerComp)
+{
+	ALyraNPCCharacter* NPC = OwnerComp.GetAIOwner() ? Cast<ALyraNPCCharacter>(OwnerComp.GetAIOwner()->GetPawn()) : nullptr;
+	ULyraNPCWorldSubsystem* WorldSubsystem = OwnerComp.GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>();
+	if (NPC && WorldSubsystem)
+	{
+		WorldSubsystem->ReleaseTaskReservation(NPC);
+	}
+}
+
+FGameplayTag ULyraNPCBTTask_FindTask::GetSearchTag(const ALyraNPCCharacter* NPC) const
+{
 	// Determine task type to search for
 	FGameplayTag SearchTag = TaskTypeFilter;
 
@@ -62,20 +147,11 @@ EBTNodeResult::Type ULyraNPCBTTask_FindTask::ExecuteTask(UBehaviorTreeComponent&
 		}
 	}
 
-	// Use world subsystem for optimized search
-	ULyraNPCWorldSubsystem* WorldSubsystem = NPC->GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>();
-	ULyraNPCTaskActor* BestTask = nullptr;
-
-	if (WorldSubsystem)
-	{
-		BestTask = WorldSubsystem->FindBestTaskForNPC(NPC, SearchTag);
-	}
-	else
-	{
-		// Fallback to controller's search
-		BestTask = AIController->FindBestTask(SearchTag);
-	}
+	return SearchTag;
+}
 
+EBTNodeResult::Type ULyraNPCBTTask_FindTask::ApplyFoundTask(UBehaviorTreeComponent& OwnerComp, ALyraNPCCharacter* NPC, ULyraNPCTaskActor* BestTask) const
+{
 	if (BestTask)
 	{
 		// Store in blackboard
@@ -103,9 +179,17 @@ FString ULyraNPCBTTask_FindTask::GetStaticDescription() const
 	{
 		Description += FString::Printf(TEXT(" of type: %s"), *TaskTypeFilter.ToString());
 	}
+	if (SearchRadius > 0.0f)
+	{
+		Description += FString::Printf(TEXT(" within %.0f"), SearchRadius);
+	}
 	if (bUseScheduleForTaskType)
 	{
 		Description += TEXT(" (uses schedule)");
 	}
+	if (bUseBatchedSearch)
+	{
+		Description += TEXT(" (batched)");
+	}
 	return Description;
 }
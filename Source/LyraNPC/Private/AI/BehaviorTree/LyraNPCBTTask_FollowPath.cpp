@@ -6,6 +6,7 @@
 #include "Core/LyraNPCCharacter.h"
 #include "Navigation/LyraNPCPathFollowingComponent.h"
 #include "Components/LyraNPCIdentityComponent.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 #include "LyraNPCModule.h"
 
 ULyraNPCBTTask_FollowPath::ULyraNPCBTTask_FollowPath()
@@ -21,6 +22,7 @@ uint16 ULyraNPCBTTask_FollowPath::GetInstanceMemorySize() const
 
 EBTNodeResult::Type ULyraNPCBTTask_FollowPath::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
+	LYRANPC_SCOPE_FRAME_COST(&OwnerComp);
 	FPathMemory* Memory = reinterpret_cast<FPathMemory*>(NodeMemory);
 	Memory->PointsVisited = 0;
 
@@ -63,6 +65,7 @@ EBTNodeResult::Type ULyraNPCBTTask_FollowPath::ExecuteTask(UBehaviorTreeComponen
 
 void ULyraNPCBTTask_FollowPath::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
 {
+	LYRANPC_SCOPE_FRAME_COST(&OwnerComp);
 	FPathMemory* Memory = reinterpret_cast<FPathMemory*>(NodeMemory);
 
 	AAIController* AIController = OwnerComp.GetAIOwner();
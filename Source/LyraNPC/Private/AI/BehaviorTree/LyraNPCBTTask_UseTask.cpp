@@ -6,12 +6,15 @@
 #include "AI/Controllers/LyraNPCAIController.h"
 #include "Core/LyraNPCCharacter.h"
 #include "Tasks/LyraNPCTaskActor.h"
+#include "Systems/LyraNPCWorldSubsystem.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 #include "LyraNPCModule.h"
 
 ULyraNPCBTTask_UseTask::ULyraNPCBTTask_UseTask()
 {
 	NodeName = "Use Task";
 	bNotifyTick = true;
+	bNotifyTaskFinished = true;
 
 	TaskKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(ULyraNPCBTTask_UseTask, TaskKey), UObject::StaticClass());
 }
@@ -23,6 +26,7 @@ uint16 ULyraNPCBTTask_UseTask::GetInstanceMemorySize() const
 
 EBTNodeResult::Type ULyraNPCBTTask_UseTask::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
 {
+	LYRANPC_SCOPE_FRAME_COST(&OwnerComp);
 	FTaskMemory* Memory = reinterpret_cast<FTaskMemory*>(NodeMemory);
 	Memory->bTaskStarted = false;
 	Memory->RemainingTime = 0.0f;
@@ -61,6 +65,7 @@ EBTNodeResult::Type ULyraNPCBTTask_UseTask::ExecuteTask(UBehaviorTreeComponent&
 
 void ULyraNPCBTTask_UseTask::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
 {
+	LYRANPC_SCOPE_FRAME_COST(&OwnerComp);
 	FTaskMemory* Memory = reinterpret_cast<FTaskMemory*>(NodeMemory);
 
 	if (!Memory->bTaskStarted)
@@ -100,6 +105,23 @@ EBTNodeResult::Type ULyraNPCBTTask_UseTask::AbortTask(UBehaviorTreeComponent& Ow
 	return EBTNodeResult::Aborted;
 }
 
+void ULyraNPCBTTask_UseTask::OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult)
+{
+	Super::OnTaskFinished(OwnerComp, NodeMemory, TaskResult);
+
+	// Never started (the task refused the NPC, or the node was aborted first): free the slot assigned to it
+	FTaskMemory* Memory = reinterpret_cast<FTaskMemory*>(NodeMemory);
+	if (!Memory->bTaskStarted)
+	{
+		ALyraNPCCharacter* NPC = OwnerComp.GetAIOwner() ? Cast<ALyraNPCCharacter>(OwnerComp.GetAIOwner()->GetPawn()) : nullptr;
+		ULyraNPCWorldSubsystem* WorldSubsystem = OwnerComp.GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>();
+		if (NPC && WorldSubsystem)
+		{
+			WorldSubsystem->ReleaseTaskReservation(NPC);
+		}
+	}
+}
+
 FString ULyraNPCBTTask_UseTask::GetStaticDescription() const
 {
 	FString Duration = OverrideDuration > 0.0f
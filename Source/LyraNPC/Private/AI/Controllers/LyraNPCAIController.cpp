@@ -1,6 +1,8 @@
 // Copyright LyraNPC Framework. All Rights Reserved.
 
 #include "AI/Controllers/LyraNPCAIController.h"
+#include "Core/LyraNPCCharacter.h"
+#include "Navigation/LyraNPCRailMovementComponent.h"
 #include "BehaviorTree/BehaviorTree.h"
 #include "BehaviorTree/BehaviorTreeComponent.h"
 #include "BehaviorTree/BlackboardComponent.h"
@@ -12,9 +14,12 @@
 #include "Components/LyraNPCNeedsComponent.h"
 #include "Components/LyraNPCScheduleComponent.h"
 #include "Tasks/LyraNPCTaskActor.h"
+#include "Systems/LyraNPCWorldSubsystem.h"
+#include "Core/LyraNPCSettings.h"
+#include "Core/LyraNPCTickStagger.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 #include "Net/UnrealNetwork.h"
 #include "LyraNPCModule.h"
-#include "Kismet/GameplayStatics.h"
 
 ALyraNPCAIController::ALyraNPCAIController(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -72,30 +77,73 @@ void ALyraNPCAIController::OnPossess(APawn* InPawn)
 		StartBehaviorTree(DefaultBehaviorTree);
 	}
 
-	// Set initial AI LOD
+	// Set initial AI LOD; SetAILOD only reapplies settings on a change, so apply the current ones to the new pawn first
+	ApplyLODSettings();
 	UpdateAILOD();
 
+	// Controllers possessed together would otherwise all run their LOD check on the same frames
+	TimeSinceLastLODCheck = LODCheckInterval * LyraNPCTickStagger::GetPhase(this, 1);
+
 	UE_LOG(LogLyraNPC, Log, TEXT("LyraNPCAIController possessed pawn: %s"), *InPawn->GetName());
 }
 
 void ALyraNPCAIController::OnUnPossess()
 {
+	if (ALyraNPCCharacter* NPCChar = Cast<ALyraNPCCharacter>(GetPawn()))
+	{
+		if (NPCChar->RailMovementComponent)
+		{
+			NPCChar->RailMovementComponent->SetRailAllowed(false);
+		}
+	}
+
 	StopBehaviorTree();
 	StopUsingCurrentTask();
 
 	Super::OnUnPossess();
 }
 
+void ALyraNPCAIController::OnPawnPooled()
+{
+	StopUsingCurrentTask();
+	StopBehaviorTree();
+	SetAILOD(ELyraNPCAILOD::Dormant);
+
+	// Otherwise the LOD check would keep running against the hidden pawn and could promote it
+	SetActorTickEnabled(false);
+}
+
+void ALyraNPCAIController::OnPawnUnpooled()
+{
+	SetActorTickEnabled(PrimaryActorTick.bStartWithTickEnabled);
+
+	// The pawn carries a different NPC now
+	UpdateBlackboardFromComponents();
+	if (DefaultBehaviorTree)
+	{
+		StartBehaviorTree(DefaultBehaviorTree);
+	}
+
+	// Starting the tree does not honour the current LOD, so reapply it before looking for a new one
+	ApplyLODSettings();
+	UpdateAILOD();
+	TimeSinceLastLODCheck = LODCheckInterval * LyraNPCTickStagger::GetPhase(this, 1);
+}
+
 void ALyraNPCAIController::Tick(float DeltaTime)
 {
+	LYRANPC_SCOPE_FRAME_COST(this);
 	Super::Tick(DeltaTime);
 
-	// Update AI LOD periodically
-	TimeSinceLastLODCheck += DeltaTime;
-	if (TimeSinceLastLODCheck >= LODCheckInterval)
+	// Update AI LOD periodically, unless the subsystem does it for the whole population
+	if (!IsLODManagedBySubsystem())
 	{
-		UpdateAILOD();
-		TimeSinceLastLODCheck = 0.0f;
+		TimeSinceLastLODCheck += DeltaTime;
+		if (TimeSinceLastLODCheck >= LODCheckInterval)
+		{
+			UpdateAILOD();
+			TimeSinceLastLODCheck = 0.0f;
+		}
 	}
 
 	// Update task timer
@@ -107,8 +155,10 @@ void ALyraNPCAIController::Tick(float DeltaTime)
 		UpdatePerception();
 	}
 
-	// Update Blackboard periodically
-	if (CurrentAILOD != ELyraNPCAILOD::Dormant)
+	// Update Blackboard periodically; under frame governor pressure only Full NPCs keep theirs live
+	const ULyraNPCWorldSubsystem* Subsystem = GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>();
+	const bool bDeferBlackboard = Subsystem && Subsystem->GetFrameGovernor().ShouldDeferNonCriticalWork() && CurrentAILOD != ELyraNPCAILOD::Full;
+	if (CurrentAILOD != ELyraNPCAILOD::Dormant && !bDeferBlackboard)
 	{
 		UpdateBlackboardFromComponents();
 	}
@@ -164,24 +214,52 @@ void ALyraNPCAIController::SetupPerception()
 
 void ALyraNPCAIController::UpdateAILOD()
 {
-	float Distance = GetDistanceToNearestPlayer();
+	// Prefer the subsystem's viewers: they add spectators, registered view points and per-view weights.
+	// Before its first gather there are none, so fall back to player pawns.
+	const ULyraNPCWorldSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>() : nullptr;
+	const APawn* ControlledPawn = GetPawn();
+	if (Subsystem && ControlledPawn && Subsystem->GetLODManager().GetViewers().Num() > 0)
+	{
+		const float Scale = Subsystem->GetLODManager().LODDistanceScale;
+		const float Distance = Subsystem->GetLODManager().GetDistanceToNearestViewer(ControlledPawn->GetActorLocation(), (MinimalLODDistance + MinimalLODHysteresis) * Scale);
+		SetAILOD(GetLODForDistance(Distance / Scale));
+		return;
+	}
+
+	const float Scale = Subsystem ? Subsystem->GetLODManager().LODDistanceScale : 1.0f;
+	SetAILOD(GetLODForDistance(GetDistanceToNearestPlayer() / Scale));
+}
 
-	ELyraNPCAILOD NewLOD = ELyraNPCAILOD::Dormant;
+ELyraNPCAILOD ALyraNPCAIController::GetLODForDistance(float Distance) const
+{
+	// Boundaries the NPC is inside of move out by their margin and boundaries it is beyond move in,
+	// so it has to cross a boundary by the margin to change LOD
+	auto Boundary = [this](ELyraNPCAILOD Band, float Threshold, float Margin)
+	{
+		return Band >= CurrentAILOD ? Threshold + Margin : Threshold - Margin;
+	};
 
-	if (Distance <= FullLODDistance)
+	if (Distance <= Boundary(ELyraNPCAILOD::Full, FullLODDistance, FullLODHysteresis))
 	{
-		NewLOD = ELyraNPCAILOD::Full;
+		return ELyraNPCAILOD::Full;
 	}
-	else if (Distance <= ReducedLODDistance)
+	if (Distance <= Boundary(ELyraNPCAILOD::Reduced, ReducedLODDistance, ReducedLODHysteresis))
 	{
-		NewLOD = ELyraNPCAILOD::Reduced;
+		return ELyraNPCAILOD::Reduced;
 	}
-	else if (Distance <= MinimalLODDistance)
+	if (Distance <= Boundary(ELyraNPCAILOD::Minimal, MinimalLODDistance, MinimalLODHysteresis))
 	{
-		NewLOD = ELyraNPCAILOD::Minimal;
+		return ELyraNPCAILOD::Minimal;
 	}
+	return ELyraNPCAILOD::Dormant;
+}
+
+bool ALyraNPCAIController::IsLODManagedBySubsystem() const
+{
+	if (!bUseSubsystemLOD) return false;
 
-	SetAILOD(NewLOD);
+	const ULyraNPCWorldSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>() : nullptr;
+	return Subsystem && Subsystem->bCentralizedLOD;
 }
 
 void ALyraNPCAIController::SetAILOD(ELyraNPCAILOD NewLOD)
@@ -191,16 +269,32 @@ void ALyraNPCAIController::SetAILOD(ELyraNPCAILOD NewLOD)
 		ELyraNPCAILOD OldLOD = CurrentAILOD;
 		CurrentAILOD = NewLOD;
 
+		// Bring state up to date before the pawn starts ticking faster
+		if (NewLOD < OldLOD)
+		{
+			if (ALyraNPCCharacter* NPCChar = Cast<ALyraNPCCharacter>(GetPawn()))
+			{
+				NPCChar->CatchUpSimulation();
+			}
+		}
+
 		ApplyLODSettings();
 
+		bool bBroadcast = false;
 		if (APawn* ControlledPawn = GetPawn())
 		{
 			if (ALyraNPCCharacter* NPCChar = Cast<ALyraNPCCharacter>(ControlledPawn))
 			{
+				bBroadcast = OnAILODChanged.IsBound();
 				OnAILODChanged.Broadcast(NPCChar, NewLOD);
 			}
 		}
 
+		if (ULyraNPCWorldSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>() : nullptr)
+		{
+			Subsystem->NotifyAILODChanged(bBroadcast);
+		}
+
 		UE_LOG(LogLyraNPC, Verbose, TEXT("AI LOD changed from %d to %d"), static_cast<int32>(OldLOD), static_cast<int32>(NewLOD));
 	}
 }
@@ -228,19 +322,7 @@ float ALyraNPCAIController::GetDistanceToNearestPlayer() const
 
 void ALyraNPCAIController::ApplyLODSettings()
 {
-	// Adjust tick rate
-	float* TickRate = LODUpdateRates.Find(CurrentAILOD);
-	if (TickRate)
-	{
-		if (*TickRate > 0.0f)
-		{
-			PrimaryActorTick.TickInterval = *TickRate;
-		}
-		else
-		{
-			PrimaryActorTick.TickInterval = 0.0f;
-		}
-	}
+	ApplyLODTickRates();
 
 	// Adjust perception based on LOD
 	if (AIPerceptionComponent)
@@ -266,6 +348,42 @@ void ALyraNPCAIController::ApplyLODSettings()
 	}
 }
 
+void ALyraNPCAIController::ApplyLODTickRates()
+{
+	// The frame governor stretches every interval while LyraNPC is over its frame budget
+	const ULyraNPCWorldSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>() : nullptr;
+	const float IntervalScale = Subsystem ? Subsystem->GetFrameGovernor().GetTickIntervalScale() : 1.0f;
+
+	// Adjust tick rate, phase-shifted per controller
+	float* TickRate = LODUpdateRates.Find(CurrentAILOD);
+	if (TickRate)
+	{
+		LyraNPCTickStagger::SetTickInterval(PrimaryActorTick, FMath::Max(*TickRate, 0.0f) * IntervalScale, LyraNPCTickStagger::GetPhase(this));
+	}
+
+	const ULyraNPCSettings* Settings = GetDefault<ULyraNPCSettings>();
+	ALyraNPCCharacter* NPCChar = Cast<ALyraNPCCharacter>(GetPawn());
+	ULyraNPCRailMovementComponent* Rail = NPCChar ? NPCChar->RailMovementComponent.Get() : nullptr;
+	const bool bUseRail = Settings->bUseRailMovementAtMinimalLOD && CurrentAILOD == ELyraNPCAILOD::Minimal;
+
+	// Leave the rail before the tick profile sets up character movement again, join it after
+	if (Rail && !bUseRail)
+	{
+		Rail->SetRailAllowed(false);
+	}
+
+	// Throttle the pawn's own ticks
+	if (NPCChar && Settings->bApplyLODTickProfiles)
+	{
+		NPCChar->ApplyLODTickProfile(Settings->GetTickProfile(CurrentAILOD), IntervalScale);
+	}
+
+	if (Rail && bUseRail)
+	{
+		Rail->SetRailAllowed(true);
+	}
+}
+
 bool ALyraNPCAIController::StartBehaviorTree(UBehaviorTree* TreeToRun)
 {
 	if (!TreeToRun || !BehaviorTreeComponent) return false;
@@ -382,38 +500,12 @@ void ALyraNPCAIController::ClearBlackboardTask()
 
 ULyraNPCTaskActor* ALyraNPCAIController::FindBestTask(FGameplayTag TaskType)
 {
-	TArray<AActor*> TaskActors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AActor::StaticClass(), TaskActors);
-
-	ULyraNPCTaskActor* BestTask = nullptr;
-	float BestScore = 0.0f;
-
 	ALyraNPCCharacter* NPCPawn = Cast<ALyraNPCCharacter>(GetPawn());
 	if (!NPCPawn) return nullptr;
 
-	for (AActor* Actor : TaskActors)
-	{
-		TArray<ULyraNPCTaskActor*> TaskComponents;
-		Actor->GetComponents<ULyraNPCTaskActor>(TaskComponents);
-
-		for (ULyraNPCTaskActor* TaskComponent : TaskComponents)
-		{
-			// Filter by task type if specified
-			if (TaskType.IsValid() && !TaskComponent->TaskType.MatchesTag(TaskType))
-			{
-				continue;
-			}
-
-			float Score = TaskComponent->GetScoreForNPC(NPCPawn);
-			if (Score > BestScore)
-			{
-				BestScore = Score;
-				BestTask = TaskComponent;
-			}
-		}
-	}
-
-	return BestTask;
+	// Task components register themselves with the subsystem, so no world scan is needed
+	ULyraNPCWorldSubsystem* WorldSubsystem = GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>();
+	return WorldSubsystem ? WorldSubsystem->FindBestTaskForNPC(NPCPawn, TaskType) : nullptr;
 }
 
 bool ALyraNPCAIController::StartUsingTask(ULyraNPCTaskActor* Task)
@@ -428,13 +520,15 @@ bool ALyraNPCAIController::StartUsingTask(ULyraNPCTaskActor* Task)
 		CurrentTask = Task;
 		CurrentTaskRemainingTime = Task->GetRandomDuration();
 
-		// Apply needs satisfaction
+		// Apply needs satisfaction: an initial boost, then the per-minute amounts as rates for as long
+		// as the task is in use
+		RemoveTaskNeedModifiers();
 		if (NeedsComponent)
 		{
 			for (const auto& Pair : Task->NeedsSatisfaction)
 			{
-				// Initial satisfaction boost
 				NeedsComponent->SatisfyNeed(Pair.Key, Pair.Value * 0.1f);
+				TaskNeedModifiers.Add(NeedsComponent->AddNeedModifier(Pair.Key, Pair.Value));
 			}
 		}
 
@@ -452,6 +546,8 @@ bool ALyraNPCAIController::StartUsingTask(ULyraNPCTaskActor* Task)
 
 void ALyraNPCAIController::StopUsingCurrentTask()
 {
+	RemoveTaskNeedModifiers();
+
 	if (CurrentTask.IsValid())
 	{
 		ALyraNPCCharacter* NPCPawn = Cast<ALyraNPCCharacter>(GetPawn());
@@ -472,21 +568,28 @@ void ALyraNPCAIController::UpdateTaskTimer(float DeltaTime)
 	{
 		CurrentTaskRemainingTime -= DeltaTime;
 
-		// Apply continuous needs satisfaction
-		if (NeedsComponent)
+		if (CurrentTaskRemainingTime <= 0.0f)
 		{
-			float MinuteFraction = DeltaTime / 60.0f;
-			for (const auto& Pair : CurrentTask->NeedsSatisfaction)
-			{
-				NeedsComponent->SatisfyNeed(Pair.Key, Pair.Value * MinuteFraction);
-			}
+			StopUsingCurrentTask();
 		}
+	}
+	else if (!CurrentTask.IsValid() && TaskNeedModifiers.Num() > 0)
+	{
+		// The task went away without being stopped
+		RemoveTaskNeedModifiers();
+	}
+}
 
-		if (CurrentTaskRemainingTime <= 0.0f)
+void ALyraNPCAIController::RemoveTaskNeedModifiers()
+{
+	if (NeedsComponent)
+	{
+		for (const int32 Handle : TaskNeedModifiers)
 		{
-			StopUsingCurrentTask();
+			NeedsComponent->RemoveNeedModifier(Handle);
 		}
 	}
+	TaskNeedModifiers.Reset();
 }
 
 float ALyraNPCAIController::CalculateActionScore(FGameplayTag ActionType) const
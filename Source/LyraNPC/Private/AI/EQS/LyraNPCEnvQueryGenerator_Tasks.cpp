@@ -7,6 +7,7 @@
 #include "Tasks/LyraNPCTaskActor.h"
 #include "Systems/LyraNPCWorldSubsystem.h"
 #include "AIController.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 
 ULyraNPCEnvQueryGenerator_Tasks::ULyraNPCEnvQueryGenerator_Tasks()
 {
@@ -16,6 +17,7 @@ ULyraNPCEnvQueryGenerator_Tasks::ULyraNPCEnvQueryGenerator_Tasks()
 
 void ULyraNPCEnvQueryGenerator_Tasks::GenerateItems(FEnvQueryInstance& QueryInstance) const
 {
+	LYRANPC_SCOPE_FRAME_COST(QueryInstance.Owner.Get());
 	UObject* QuerierObject = QueryInstance.Owner.Get();
 	if (!QuerierObject)
 	{
@@ -52,38 +54,27 @@ void ULyraNPCEnvQueryGenerator_Tasks::GenerateItems(FEnvQueryInstance& QueryInst
 		return;
 	}
 
-	// Get tasks within radius
-	TArray<ULyraNPCTaskActor*> Tasks = WorldSubsystem->GetTasksInRadius(NPC->GetActorLocation(), SearchRadius);
-
-	// Filter and sort tasks
+	// Visit only tasks of the filtered type within radius
 	TArray<TPair<ULyraNPCTaskActor*, float>> ScoredTasks;
 
-	for (ULyraNPCTaskActor* Task : Tasks)
+	WorldSubsystem->GetTaskIndex().ForEachTask(TaskTypeFilter, NPC->GetActorLocation(), FMath::Max(SearchRadius, 0.0f), [&](ULyraNPCTaskActor* Task)
 	{
-		if (!Task) continue;
-
-		// Filter by task type
-		if (TaskTypeFilter.IsValid() && !Task->TaskType.MatchesTag(TaskTypeFilter))
-		{
-			continue;
-		}
-
 		// Filter by availability
 		if (bOnlyAvailable && !Task->bIsAvailable)
 		{
-			continue;
+			return;
 		}
 
 		// Filter by NPC access
 		if (bCheckNPCAccess && !Task->CanNPCUseTask(NPC))
 		{
-			continue;
+			return;
 		}
 
 		// Calculate score
 		float Score = Task->GetScoreForNPC(NPC);
 		ScoredTasks.Add(TPair<ULyraNPCTaskActor*, float>(Task, Score));
-	}
+	});
 
 	// Sort by score (highest first)
 	ScoredTasks.Sort([](const TPair<ULyraNPCTaskActor*, float>& A, const TPair<ULyraNPCTaskActor*, float>& B)
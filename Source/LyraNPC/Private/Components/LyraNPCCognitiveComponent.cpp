@@ -1,9 +1,20 @@
 // Copyright LyraNPC Framework. All Rights Reserved.
 
 #include "Components/LyraNPCCognitiveComponent.h"
+#include "Core/LyraNPCTickStagger.h"
 #include "Net/UnrealNetwork.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 #include "LyraNPCModule.h"
 
+namespace LyraNPCCognitive
+{
+	// Clarity used to drop by Age * DecayRate on a 5 second cadence; the closed form keeps that curve
+	static constexpr float DecayStepsPerHour = 720.0f;
+
+	// Seconds between memory decay passes
+	static constexpr float MemoryDecayInterval = 5.0f;
+}
+
 ULyraNPCCognitiveComponent::ULyraNPCCognitiveComponent()
 {
 	PrimaryComponentTick.bCanEverTick = true;
@@ -21,6 +32,11 @@ void ULyraNPCCognitiveComponent::BeginPlay()
 
 	// Decision variance is inversely related to intelligence
 	DecisionVariance = 0.4f - (CognitiveSkill * 0.35f); // 0.05-0.4 variance
+
+	SimulationClock.Start(GetWorld());
+
+	// Start partway through the decay interval so NPCs spawned together decay on different frames
+	MemoryDecayAccumulator = LyraNPCCognitive::MemoryDecayInterval * LyraNPCTickStagger::GetPhase(this);
 }
 
 void ULyraNPCCognitiveComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
@@ -31,10 +47,18 @@ void ULyraNPCCognitiveComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProp
 
 void ULyraNPCCognitiveComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	LYRANPC_SCOPE_FRAME_COST(this);
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	UpdateAlertness(DeltaTime);
-	UpdateMemoryDecay(DeltaTime);
+	const float Elapsed = SimulationClock.Advance(GetWorld());
+	UpdateAlertness(Elapsed);
+	UpdateMemoryDecay(Elapsed);
+}
+
+void ULyraNPCCognitiveComponent::CatchUp()
+{
+	UpdateAlertness(SimulationClock.Advance(GetWorld()));
+	ForgetOldMemories();
 }
 
 void ULyraNPCCognitiveComponent::UpdateAlertness(float DeltaTime)
@@ -66,12 +90,11 @@ void ULyraNPCCognitiveComponent::UpdateAlertness(float DeltaTime)
 void ULyraNPCCognitiveComponent::UpdateMemoryDecay(float DeltaTime)
 {
 	// Update memory decay every few seconds
-	static float MemoryUpdateAccumulator = 0.0f;
-	MemoryUpdateAccumulator += DeltaTime;
+	MemoryDecayAccumulator += DeltaTime;
 
-	if (MemoryUpdateAccumulator >= 5.0f)
+	if (MemoryDecayAccumulator >= LyraNPCCognitive::MemoryDecayInterval)
 	{
-		MemoryUpdateAccumulator = 0.0f;
+		MemoryDecayAccumulator = 0.0f;
 		ForgetOldMemories();
 	}
 }
@@ -326,15 +349,22 @@ TArray<FLyraNPCMemory> ULyraNPCCognitiveComponent::GetMemoriesNearLocation(FVect
 
 void ULyraNPCCognitiveComponent::ForgetOldMemories()
 {
-	float CurrentTime = GetWorld()->GetTimeSeconds();
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	const float PreviousTime = LastMemoryDecayTime;
+	LastMemoryDecayTime = CurrentTime;
 
 	for (int32 i = Memories.Num() - 1; i >= 0; --i)
 	{
 		FLyraNPCMemory& Memory = Memories[i];
-		float TimePassed = (CurrentTime - Memory.Timestamp) / 3600.0f; // Convert to hours
 
-		// Decay clarity based on time and memory decay rate
-		float DecayAmount = TimePassed * MemoryDecayRate * (1.0f - (Memory.Importance / 200.0f));
+		// Age in hours at the previous decay and now
+		const float FromAge = FMath::Max(PreviousTime - Memory.Timestamp, 0.0f) / 3600.0f;
+		const float ToAge = FMath::Max(CurrentTime - Memory.Timestamp, 0.0f) / 3600.0f;
+
+		// Clarity is lost at a rate proportional to age, integrated over the gap, so the result
+		// does not depend on how often this runs
+		float DecayAmount = 0.5f * LyraNPCCognitive::DecayStepsPerHour * (ToAge * ToAge - FromAge * FromAge)
+			* MemoryDecayRate * (1.0f - (Memory.Importance / 200.0f));
 		Memory.Clarity -= DecayAmount;
 
 		// Remove completely forgotten memories
@@ -1,6 +1,9 @@
 // Copyright LyraNPC Framework. All Rights Reserved.
 
 #include "Components/LyraNPCIdentityComponent.h"
+#include "Core/LyraNPCCharacter.h"
+#include "Systems/LyraNPCWorldSubsystem.h"
+#include "Engine/World.h"
 #include "Net/UnrealNetwork.h"
 #include "LyraNPCModule.h"
 
@@ -91,6 +94,8 @@ void ULyraNPCIdentityComponent::InitializeIdentity(const FLyraNPCBiography& NewB
 		Biography.UniqueId = FGuid::NewGuid();
 	}
 
+	NotifyIdentityChanged();
+
 	UE_LOG(LogLyraNPC, Log, TEXT("NPC Identity Initialized: %s"), *Biography.GetFullName());
 }
 
@@ -173,10 +178,25 @@ void ULyraNPCIdentityComponent::GenerateRandomIdentity(ELyraNPCArchetype Archety
 		break;
 	}
 
+	NotifyIdentityChanged();
+
 	UE_LOG(LogLyraNPC, Log, TEXT("Generated Random NPC: %s, Age %d, %s"),
 		*Biography.GetFullName(), Biography.Age, *Biography.Occupation);
 }
 
+void ULyraNPCIdentityComponent::NotifyIdentityChanged()
+{
+	// Keeps the subsystem's id and name lookups in sync; unregistered NPCs are indexed on registration
+	ALyraNPCCharacter* NPCChar = Cast<ALyraNPCCharacter>(GetOwner());
+	UWorld* World = GetWorld();
+	if (!NPCChar || !World) return;
+
+	if (ULyraNPCWorldSubsystem* Subsystem = World->GetSubsystem<ULyraNPCWorldSubsystem>())
+	{
+		Subsystem->RefreshNPCIdentity(NPCChar);
+	}
+}
+
 void ULyraNPCIdentityComponent::SetLifeState(ELyraNPCLifeState NewState)
 {
 	if (CurrentLifeState != NewState)
@@ -1,13 +1,29 @@
 // Copyright LyraNPC Framework. All Rights Reserved.
 
 #include "Components/LyraNPCNeedsComponent.h"
+#include "Core/LyraNPCCharacter.h"
+#include "Core/LyraNPCNeedsProfile.h"
+#include "Core/LyraNPCSettings.h"
+#include "Systems/LyraNPCWorldSubsystem.h"
+#include "Systems/LyraNPCNeedsBatch.h"
+#include "Engine/World.h"
+#include "GameFramework/GameStateBase.h"
 #include "Net/UnrealNetwork.h"
 #include "LyraNPCModule.h"
 
+namespace LyraNPCNeeds
+{
+	// Crossings are scheduled for slightly past the threshold so float error cannot land them just short
+	static constexpr float ThresholdMargin = 0.01f;
+
+	// Value of a need type the NPC has no stored value for, and the most any need holds
+	static constexpr float SatisfiedValue = 100.0f;
+}
+
 ULyraNPCNeedsComponent::ULyraNPCNeedsComponent()
 {
-	PrimaryComponentTick.bCanEverTick = true;
-	PrimaryComponentTick.TickInterval = 1.0f; // Update every second
+	// Values are evaluated on read and threshold crossings come from the world subsystem
+	PrimaryComponentTick.bCanEverTick = false;
 	SetIsReplicatedByDefault(true);
 }
 
@@ -15,255 +31,698 @@ void ULyraNPCNeedsComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if (Needs.Num() == 0)
+	WorldSubsystem = GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>();
+	if (GetBaseTime() < 0.0)
+	{
+		SetBaseToNow();
+	}
+	RefreshClock();
+
+	if (NeedValues.Num() == 0)
+	{
+		InitializeDefaultNeeds(ProfileArchetype);
+	}
+	else
 	{
-		InitializeDefaultNeeds(ELyraNPCArchetype::Villager);
+		ResolveProfile();
+		OnNeedsChanged();
 	}
 }
 
+void ULyraNPCNeedsComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Normally done already when the NPC unregisters
+	DetachFromBatch();
+	Super::EndPlay(EndPlayReason);
+}
+
 void ULyraNPCNeedsComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-	DOREPLIFETIME(ULyraNPCNeedsComponent, Needs);
+	DOREPLIFETIME(ULyraNPCNeedsComponent, Profile);
+	DOREPLIFETIME(ULyraNPCNeedsComponent, ProfileArchetype);
+	DOREPLIFETIME(ULyraNPCNeedsComponent, ReplicatedNeeds);
+}
+
+void ULyraNPCNeedsComponent::OnRep_Needs()
+{
+	UWorld* World = GetWorld();
+	if (!World) return;
+
+	// Initial replication can arrive before BeginPlay
+	if (!WorldSubsystem.IsValid())
+	{
+		WorldSubsystem = World->GetSubsystem<ULyraNPCWorldSubsystem>();
+	}
+
+	// The server's line is moved onto this machine's clocks by how long ago it was stored. Clients
+	// resolve the archetype default profile themselves.
+	const double ServerTime = World->GetGameState() ? World->GetGameState()->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+	const double SecondsAgo = FMath::Max(ServerTime - ReplicatedNeeds.BaseTime, 0.0);
+
+	NeedValues = ReplicatedNeeds.Values;
+	ModifierRates = ReplicatedNeeds.ModifierRates;
+	StoreNeedValues();
+	RefreshClock();
+
+	const ULyraNPCWorldSubsystem* Subsystem = WorldSubsystem.Get();
+	const double GameHoursPerSecond = bDecayOnGameClock && Subsystem ? Subsystem->GlobalTimeScale / 3600.0 : 0.0;
+	SetBase(FMath::Max(World->GetTimeSeconds() - SecondsAgo, 0.0), GetGameClockHours() - SecondsAgo * GameHoursPerSecond);
+
+	ResolveProfile();
+	OnNeedsChanged();
 }
 
 void ULyraNPCNeedsComponent::InitializeDefaultNeeds(ELyraNPCArchetype Archetype)
 {
-	Needs.Empty();
+	ProfileArchetype = Archetype;
+	ResolveProfile();
+	ResetValues();
+
+	UE_LOG(LogLyraNPC, Log, TEXT("Initialized %d needs for archetype %d"), GetDefinitions().Num(), static_cast<int32>(Archetype));
+}
+
+void ULyraNPCNeedsComponent::SetProfile(ULyraNPCNeedsProfile* NewProfile)
+{
+	Profile = NewProfile;
+	ResolveProfile();
+	ResetValues();
+}
+
+void ULyraNPCNeedsComponent::CatchUp()
+{
+	Materialize();
+	RefreshClock();
+	ResolveProfile();
+	OnNeedsChanged();
+}
 
-	// Hunger - everyone needs to eat
-	FLyraNPCNeedState Hunger;
-	Hunger.NeedType = ELyraNPCNeedType::Hunger;
-	Hunger.CurrentValue = FMath::FRandRange(60.0f, 100.0f);
-	Hunger.DecayRatePerHour = 4.0f;
-	Hunger.PriorityWeight = 1.2f;
-	Hunger.UrgentThreshold = 25.0f;
-	Hunger.CriticalThreshold = 10.0f;
-	Needs.Add(Hunger);
-
-	// Energy - everyone needs rest
-	FLyraNPCNeedState Energy;
-	Energy.NeedType = ELyraNPCNeedType::Energy;
-	Energy.CurrentValue = FMath::FRandRange(70.0f, 100.0f);
-	Energy.DecayRatePerHour = 6.0f;
-	Energy.PriorityWeight = 1.3f;
-	Energy.UrgentThreshold = 20.0f;
-	Energy.CriticalThreshold = 5.0f;
-	Needs.Add(Energy);
-
-	// Social - varies by archetype
-	FLyraNPCNeedState Social;
-	Social.NeedType = ELyraNPCNeedType::Social;
-	Social.CurrentValue = FMath::FRandRange(50.0f, 100.0f);
-	Social.DecayRatePerHour = Archetype == ELyraNPCArchetype::Traveler ? 1.0f : 3.0f;
-	Social.PriorityWeight = 0.8f;
-	Social.UrgentThreshold = 20.0f;
-	Social.CriticalThreshold = 5.0f;
-	Needs.Add(Social);
-
-	// Safety
-	FLyraNPCNeedState Safety;
-	Safety.NeedType = ELyraNPCNeedType::Safety;
-	Safety.CurrentValue = 100.0f;
-	Safety.DecayRatePerHour = 0.0f; // Only decays from events
-	Safety.PriorityWeight = 2.0f; // High priority when low
-	Safety.UrgentThreshold = 50.0f;
-	Safety.CriticalThreshold = 25.0f;
-	Needs.Add(Safety);
-
-	// Comfort
-	FLyraNPCNeedState Comfort;
-	Comfort.NeedType = ELyraNPCNeedType::Comfort;
-	Comfort.CurrentValue = FMath::FRandRange(60.0f, 100.0f);
-	Comfort.DecayRatePerHour = 2.0f;
-	Comfort.PriorityWeight = 0.6f;
-	Comfort.UrgentThreshold = 30.0f;
-	Comfort.CriticalThreshold = 10.0f;
-	Needs.Add(Comfort);
-
-	// Entertainment
-	FLyraNPCNeedState Entertainment;
-	Entertainment.NeedType = ELyraNPCNeedType::Entertainment;
-	Entertainment.CurrentValue = FMath::FRandRange(40.0f, 100.0f);
-	Entertainment.DecayRatePerHour = 2.5f;
-	Entertainment.PriorityWeight = 0.5f;
-	Entertainment.UrgentThreshold = 15.0f;
-	Entertainment.CriticalThreshold = 5.0f;
-	Needs.Add(Entertainment);
-
-	// Purpose/Work - especially important for workers
-	FLyraNPCNeedState Purpose;
-	Purpose.NeedType = ELyraNPCNeedType::Purpose;
-	Purpose.CurrentValue = FMath::FRandRange(50.0f, 100.0f);
-	Purpose.DecayRatePerHour = Archetype == ELyraNPCArchetype::Worker ? 4.0f : 2.0f;
-	Purpose.PriorityWeight = Archetype == ELyraNPCArchetype::Worker ? 1.0f : 0.7f;
-	Purpose.UrgentThreshold = 25.0f;
-	Purpose.CriticalThreshold = 10.0f;
-	Needs.Add(Purpose);
-
-	UE_LOG(LogLyraNPC, Log, TEXT("Initialized %d needs for archetype %d"), Needs.Num(), static_cast<int32>(Archetype));
-}
-
-void ULyraNPCNeedsComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
-{
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
-	if (bSimulateNeeds)
-	{
-		UpdateNeeds(DeltaTime);
-		CheckCriticalNeeds();
-	}
-}
-
-void ULyraNPCNeedsComponent::UpdateNeeds(float DeltaTime)
-{
-	// Convert delta time to game hours
-	float GameHoursPassed = (DeltaTime / 3600.0f) * TimeScale;
-
-	for (FLyraNPCNeedState& Need : Needs)
-	{
-		float DecayAmount = Need.DecayRatePerHour * GameHoursPassed;
-		Need.CurrentValue = FMath::Max(0.0f, Need.CurrentValue - DecayAmount);
-	}
-}
-
-void ULyraNPCNeedsComponent::CheckCriticalNeeds()
-{
-	for (const FLyraNPCNeedState& Need : Needs)
-	{
-		if (Need.CurrentValue <= Need.CriticalThreshold)
+void ULyraNPCNeedsComponent::ResumeSimulationFrom(double WorldTime, double GameHours)
+{
+	SetBase(WorldTime, GameHours);
+	UrgentMask = 0;
+	CriticalMask = 0;
+	RefreshClock();
+	ResolveProfile();
+	StoreNeedValues();
+	UpdateReplicatedNeeds();
+}
+
+void ULyraNPCNeedsComponent::AttachToBatch(FLyraNPCNeedsBatch& Batch)
+{
+	if (NeedsBatch) return;
+
+	NeedsBatchSlot = Batch.Add(this);
+	Batch.SetBase(NeedsBatchSlot, SimulationClock.LastTime, BaseGameHours);
+	NeedsBatch = &Batch;
+	StoreNeedValues();
+}
+
+void ULyraNPCNeedsComponent::DetachFromBatch()
+{
+	if (!NeedsBatch) return;
+
+	NeedValues.SetNum(FLyraNPCNeedsBatch::NumNeedTypes);
+	for (int32 Type = 0; Type < FLyraNPCNeedsBatch::NumNeedTypes; ++Type)
+	{
+		NeedValues[Type] = NeedsBatch->GetValue(NeedsBatchSlot, Type);
+	}
+	SimulationClock.LastTime = NeedsBatch->GetBaseTime(NeedsBatchSlot);
+	BaseGameHours = NeedsBatch->GetBaseGameHours(NeedsBatchSlot);
+
+	NeedsBatch->Remove(NeedsBatchSlot);
+	NeedsBatch = nullptr;
+	NeedsBatchSlot = INDEX_NONE;
+}
+
+void ULyraNPCNeedsComponent::StoreNeedValues()
+{
+	if (!NeedsBatch) return;
+
+	for (int32 Type = 0; Type < FMath::Min(NeedValues.Num(), FLyraNPCNeedsBatch::NumNeedTypes); ++Type)
+	{
+		NeedsBatch->SetValue(NeedsBatchSlot, Type, NeedValues[Type]);
+	}
+}
+
+float ULyraNPCNeedsComponent::GetStoredValue(int32 Type) const
+{
+	if (NeedsBatch)
+	{
+		return Type < FLyraNPCNeedsBatch::NumNeedTypes ? NeedsBatch->GetValue(NeedsBatchSlot, Type) : LyraNPCNeeds::SatisfiedValue;
+	}
+	return NeedValues.IsValidIndex(Type) ? NeedValues[Type] : LyraNPCNeeds::SatisfiedValue;
+}
+
+void ULyraNPCNeedsComponent::SetStoredValue(int32 Type, float NewValue)
+{
+	if (NeedsBatch)
+	{
+		if (Type < FLyraNPCNeedsBatch::NumNeedTypes)
 		{
-			if (AActor* Owner = GetOwner())
-			{
-				if (ALyraNPCCharacter* NPCChar = Cast<ALyraNPCCharacter>(Owner))
-				{
-					OnNeedCritical.Broadcast(NPCChar, Need.NeedType);
-				}
-			}
+			NeedsBatch->SetValue(NeedsBatchSlot, Type, NewValue);
 		}
 	}
+	else if (NeedValues.IsValidIndex(Type))
+	{
+		NeedValues[Type] = NewValue;
+	}
 }
 
-FLyraNPCNeedState ULyraNPCNeedsComponent::GetNeed(ELyraNPCNeedType NeedType) const
+double ULyraNPCNeedsComponent::GetBaseTime() const
 {
-	const FLyraNPCNeedState* Found = FindNeed(NeedType);
-	return Found ? *Found : FLyraNPCNeedState();
+	return NeedsBatch ? NeedsBatch->GetBaseTime(NeedsBatchSlot) : SimulationClock.LastTime;
 }
 
-float ULyraNPCNeedsComponent::GetNeedValue(ELyraNPCNeedType NeedType) const
+double ULyraNPCNeedsComponent::GetBaseGameHours() const
 {
-	const FLyraNPCNeedState* Found = FindNeed(NeedType);
-	return Found ? Found->CurrentValue : 100.0f;
+	return NeedsBatch ? NeedsBatch->GetBaseGameHours(NeedsBatchSlot) : BaseGameHours;
 }
 
-void ULyraNPCNeedsComponent::SetNeedValue(ELyraNPCNeedType NeedType, float NewValue)
+void ULyraNPCNeedsComponent::SetBase(double WorldTime, double GameHours)
 {
-	if (FLyraNPCNeedState* Found = FindNeed(NeedType))
+	if (NeedsBatch)
+	{
+		NeedsBatch->SetBase(NeedsBatchSlot, WorldTime, GameHours);
+	}
+	else
 	{
-		Found->CurrentValue = FMath::Clamp(NewValue, 0.0f, 100.0f);
+		SimulationClock.LastTime = WorldTime;
+		BaseGameHours = GameHours;
 	}
 }
 
-void ULyraNPCNeedsComponent::ModifyNeed(ELyraNPCNeedType NeedType, float Delta)
+void ULyraNPCNeedsComponent::SetBaseToNow()
 {
-	if (FLyraNPCNeedState* Found = FindNeed(NeedType))
+	if (const UWorld* World = GetWorld())
 	{
-		Found->CurrentValue = FMath::Clamp(Found->CurrentValue + Delta, 0.0f, 100.0f);
+		SetBase(World->GetTimeSeconds(), GetGameClockHours());
 	}
 }
 
-void ULyraNPCNeedsComponent::SatisfyNeed(ELyraNPCNeedType NeedType, float Amount)
+void ULyraNPCNeedsComponent::HandleScheduledEvent()
 {
-	ModifyNeed(NeedType, Amount);
+	// Rates are constant along the stored line, so evaluating it past zero or full stays exact and
+	// nothing needs storing here
+	OnNeedsChanged();
 }
 
-bool ULyraNPCNeedsComponent::HasCriticalNeed() const
+void ULyraNPCNeedsComponent::RefreshClock()
 {
-	for (const FLyraNPCNeedState& Need : Needs)
+	ULyraNPCWorldSubsystem* Subsystem = WorldSubsystem.Get();
+	bDecayOnGameClock = bSimulateNeeds && Subsystem && !bOverrideTimeScale;
+	HoursPerSecond = bSimulateNeeds && !bDecayOnGameClock ? GetEffectiveTimeScale() / 3600.0f : 0.0f;
+	bHasModifierRates = ModifierRates.ContainsByPredicate([](float Rate) { return Rate != 0.0f; });
+
+	// Mixing world-time modifiers with game-clock decay ties the line to the current time scale
+	if (Subsystem)
 	{
-		if (Need.CurrentValue <= Need.CriticalThreshold)
+		Subsystem->SetNeedsScaleSensitive(this, bDecayOnGameClock && bHasModifierRates);
+	}
+}
+
+void ULyraNPCNeedsComponent::ResolveProfile()
+{
+	ULyraNPCNeedsProfile* Resolved = Profile ? Profile.Get() : GetDefault<ULyraNPCSettings>()->GetDefaultNeedsProfile(ProfileArchetype);
+	if (Resolved != ActiveProfile)
+	{
+#if WITH_EDITOR
+		if (ActiveProfile)
 		{
-			return true;
+			ActiveProfile->OnEdited.Remove(ProfileEditedHandle);
 		}
+		ProfileEditedHandle = Resolved ? Resolved->OnEdited.AddUObject(this, &ULyraNPCNeedsComponent::HandleProfileEdited) : FDelegateHandle();
+#endif
+		ActiveProfile = Resolved;
+	}
+
+	// Types the NPC has no value for yet (e.g. added to the profile later) start satisfied
+	while (NeedValues.Num() < static_cast<int32>(ELyraNPCNeedType::MAX))
+	{
+		NeedValues.Add(LyraNPCNeeds::SatisfiedValue);
+	}
+	if (ModifierRates.Num() < static_cast<int32>(ELyraNPCNeedType::MAX))
+	{
+		ModifierRates.SetNumZeroed(static_cast<int32>(ELyraNPCNeedType::MAX));
 	}
-	return false;
 }
 
-bool ULyraNPCNeedsComponent::HasUrgentNeed() const
+void ULyraNPCNeedsComponent::ResetValues()
+{
+	NeedValues.Init(LyraNPCNeeds::SatisfiedValue, static_cast<int32>(ELyraNPCNeedType::MAX));
+
+	for (const FLyraNPCNeedDefinition& Need : GetDefinitions())
+	{
+		if (FindNeed(Need.NeedType) != &Need) continue;
+
+		NeedValues[static_cast<int32>(Need.NeedType)] = FMath::FRandRange(Need.InitialValueMin, FMath::Max(Need.InitialValueMin, Need.InitialValueMax));
+	}
+	StoreNeedValues();
+
+	SetBaseToNow();
+	RefreshClock();
+	UrgentMask = 0;
+	CriticalMask = 0;
+	OnNeedsChanged();
+}
+
+int32 ULyraNPCNeedsComponent::AddNeedModifier(ELyraNPCNeedType NeedType, float ValuePerMinute)
+{
+	if (NeedType >= ELyraNPCNeedType::MAX) return INDEX_NONE;
+
+	// Values so far accrue under the old rates
+	Materialize();
+
+	const int32 Handle = NextModifierHandle++;
+	NeedModifiers.Add({ Handle, NeedType, ValuePerMinute / 60.0f });
+	RebuildModifierRates();
+	OnNeedsChanged();
+	return Handle;
+}
+
+void ULyraNPCNeedsComponent::RemoveNeedModifier(int32 Handle)
+{
+	const int32 Index = NeedModifiers.IndexOfByPredicate([Handle](const FNeedModifier& Modifier) { return Modifier.Handle == Handle; });
+	if (Index == INDEX_NONE) return;
+
+	Materialize();
+	NeedModifiers.RemoveAtSwap(Index);
+	RebuildModifierRates();
+	OnNeedsChanged();
+}
+
+void ULyraNPCNeedsComponent::RebuildModifierRates()
+{
+	ModifierRates.Init(0.0f, static_cast<int32>(ELyraNPCNeedType::MAX));
+	for (const FNeedModifier& Modifier : NeedModifiers)
+	{
+		ModifierRates[static_cast<int32>(Modifier.NeedType)] += Modifier.PerSecond;
+	}
+	RefreshClock();
+}
+
+#if WITH_EDITOR
+void ULyraNPCNeedsComponent::HandleProfileEdited(bool bFinished)
+{
+	if (!HasBegunPlay()) return;
+
+	if (bFinished)
+	{
+		OnNeedsChanged();
+	}
+	else
+	{
+		Materialize();
+	}
+}
+#endif
+
+float ULyraNPCNeedsComponent::GetSecondsSinceUpdate() const
+{
+	const UWorld* World = GetWorld();
+	const double BaseTime = GetBaseTime();
+	if (!World || BaseTime < 0.0) return 0.0f;
+
+	return static_cast<float>(FMath::Max(World->GetTimeSeconds() - BaseTime, 0.0));
+}
+
+float ULyraNPCNeedsComponent::GetHoursSinceUpdate() const
+{
+	if (!bDecayOnGameClock || GetBaseTime() < 0.0) return 0.0f;
+
+	return static_cast<float>(FMath::Max(GetGameClockHours() - GetBaseGameHours(), 0.0));
+}
+
+double ULyraNPCNeedsComponent::GetGameClockHours() const
+{
+	const ULyraNPCWorldSubsystem* Subsystem = WorldSubsystem.Get();
+	return Subsystem ? Subsystem->GetElapsedGameHours() : 0.0;
+}
+
+float ULyraNPCNeedsComponent::GetRatePerSecond(const FLyraNPCNeedDefinition& Need) const
+{
+	const int32 Type = static_cast<int32>(Need.NeedType);
+	const float Modifier = ModifierRates.IsValidIndex(Type) ? ModifierRates[Type] : 0.0f;
+	return Modifier - Need.DecayRatePerHour * HoursPerSecond;
+}
+
+float ULyraNPCNeedsComponent::GetRatePerHour(const FLyraNPCNeedDefinition& Need) const
+{
+	return bDecayOnGameClock ? -Need.DecayRatePerHour : 0.0f;
+}
+
+float ULyraNPCNeedsComponent::GetNetRate(const FLyraNPCNeedDefinition& Need) const
+{
+	if (AreEventsOnGameClock())
+	{
+		return GetRatePerHour(Need);
+	}
+
+	// Game-clock decay seen per world second at the current scale; a new scale re-bases these needs
+	const ULyraNPCWorldSubsystem* Subsystem = WorldSubsystem.Get();
+	const float GameHoursPerSecond = bDecayOnGameClock && Subsystem ? Subsystem->GlobalTimeScale / 3600.0f : 0.0f;
+	return GetRatePerSecond(Need) + GetRatePerHour(Need) * GameHoursPerSecond;
+}
+
+float ULyraNPCNeedsComponent::GetCurrentValue(const FLyraNPCNeedDefinition& Need) const
+{
+	// The rates are constant since the last update, so clamping the end value is exact
+	const float Change = GetRatePerSecond(Need) * GetSecondsSinceUpdate() + GetRatePerHour(Need) * GetHoursSinceUpdate();
+	return FMath::Clamp(GetStoredValue(static_cast<int32>(Need.NeedType)) + Change, 0.0f, LyraNPCNeeds::SatisfiedValue);
+}
+
+TArray<float> ULyraNPCNeedsComponent::GetCurrentValues() const
+{
+	TArray<float> Result;
+	Result.SetNumUninitialized(static_cast<int32>(ELyraNPCNeedType::MAX));
+	for (int32 Type = 0; Type < Result.Num(); ++Type)
+	{
+		Result[Type] = GetStoredValue(Type);
+	}
+	for (const FLyraNPCNeedDefinition& Need : GetDefinitions())
+	{
+		if (FindNeed(Need.NeedType) == &Need && Result.IsValidIndex(static_cast<int32>(Need.NeedType)))
+		{
+			Result[static_cast<int32>(Need.NeedType)] = GetCurrentValue(Need);
+		}
+	}
+	return Result;
+}
+
+void ULyraNPCNeedsComponent::GetWellbeingRates(float& OutPerSecond, float& OutPerGameHour) const
 {
-	for (const FLyraNPCNeedState& Need : Needs)
+	float TotalPerSecond = 0.0f;
+	float TotalPerHour = 0.0f;
+	float TotalWeight = 0.0f;
+
+	for (const FLyraNPCNeedDefinition& Need : GetDefinitions())
 	{
-		if (Need.CurrentValue <= Need.UrgentThreshold)
+		if (FindNeed(Need.NeedType) != &Need) continue;
+
+		// Needs pinned at zero or full stay there
+		const float Value = GetCurrentValue(Need);
+		const float Rate = GetNetRate(Need);
+		if ((Rate < 0.0f && Value > 0.0f) || (Rate > 0.0f && Value < LyraNPCNeeds::SatisfiedValue))
 		{
-			return true;
+			TotalPerSecond += GetRatePerSecond(Need) * Need.PriorityWeight;
+			TotalPerHour += GetRatePerHour(Need) * Need.PriorityWeight;
 		}
+		TotalWeight += Need.PriorityWeight;
 	}
-	return false;
+
+	OutPerSecond = TotalWeight > 0.0f ? TotalPerSecond / TotalWeight : 0.0f;
+	OutPerGameHour = TotalWeight > 0.0f ? TotalPerHour / TotalWeight : 0.0f;
 }
 
-ELyraNPCNeedType ULyraNPCNeedsComponent::GetMostUrgentNeed() const
+void ULyraNPCNeedsComponent::Materialize()
+{
+	const float Hours = GetHoursSinceUpdate();
+	const float Seconds = GetSecondsSinceUpdate();
+	SetBaseToNow();
+	if (Seconds <= 0.0f && Hours <= 0.0f) return;
+
+	for (const FLyraNPCNeedDefinition& Need : GetDefinitions())
+	{
+		const int32 Type = static_cast<int32>(Need.NeedType);
+		if (FindNeed(Need.NeedType) != &Need) continue;
+
+		const float Change = GetRatePerSecond(Need) * Seconds + GetRatePerHour(Need) * Hours;
+		SetStoredValue(Type, FMath::Clamp(GetStoredValue(Type) + Change, 0.0f, LyraNPCNeeds::SatisfiedValue));
+	}
+}
+
+void ULyraNPCNeedsComponent::UpdateReplicatedNeeds()
+{
+	const AActor* Owner = GetOwner();
+	if (!Owner || !Owner->HasAuthority()) return;
+
+	ReplicatedNeeds.Values.SetNum(static_cast<int32>(ELyraNPCNeedType::MAX));
+	for (int32 Type = 0; Type < ReplicatedNeeds.Values.Num(); ++Type)
+	{
+		ReplicatedNeeds.Values[Type] = GetStoredValue(Type);
+	}
+	ReplicatedNeeds.ModifierRates = ModifierRates;
+	ReplicatedNeeds.BaseTime = GetBaseTime();
+}
+
+void ULyraNPCNeedsComponent::OnNeedsChanged()
+{
+	UpdateReplicatedNeeds();
+	CheckThresholds();
+	const float ReorderTime = UpdateMostUrgentNeed();
+	NotifyWellbeingChanged();
+	ScheduleNextEvent(ReorderTime);
+}
+
+void ULyraNPCNeedsComponent::CheckThresholds()
 {
-	ELyraNPCNeedType MostUrgent = ELyraNPCNeedType::Hunger;
-	float HighestPriority = -1.0f;
+	// Masks are rebuilt from current values, so a need that recovered above a threshold is re-armed
+	// for the next crossing
+	uint32 Urgent = 0;
+	uint32 Critical = 0;
 
-	for (const FLyraNPCNeedState& Need : Needs)
+	for (const FLyraNPCNeedDefinition& Need : GetDefinitions())
 	{
-		float Priority = GetNeedPriority(Need.NeedType);
-		if (Priority > HighestPriority)
+		if (FindNeed(Need.NeedType) != &Need) continue;
+
+		const uint32 Bit = 1u << static_cast<uint32>(Need.NeedType);
+		const float Value = GetCurrentValue(Need);
+
+		if (Value <= Need.UrgentThreshold)
 		{
-			HighestPriority = Priority;
-			MostUrgent = Need.NeedType;
+			Urgent |= Bit;
+		}
+		if (Value <= Need.CriticalThreshold)
+		{
+			Critical |= Bit;
 		}
 	}
 
-	return MostUrgent;
+	const uint32 NewlyUrgent = Urgent & ~UrgentMask;
+	const uint32 NewlyCritical = Critical & ~CriticalMask;
+	UrgentMask = Urgent;
+	CriticalMask = Critical;
+
+	if ((NewlyUrgent | NewlyCritical) == 0) return;
+
+	// Listeners run after the masks are settled, so they may modify needs themselves
+	ALyraNPCCharacter* NPCChar = Cast<ALyraNPCCharacter>(GetOwner());
+	if (!NPCChar) return;
+
+	for (uint32 Type = 0; Type < static_cast<uint32>(ELyraNPCNeedType::MAX); ++Type)
+	{
+		if (NewlyUrgent & (1u << Type))
+		{
+			OnNeedUrgent.Broadcast(NPCChar, static_cast<ELyraNPCNeedType>(Type));
+		}
+		if (NewlyCritical & (1u << Type))
+		{
+			OnNeedCritical.Broadcast(NPCChar, static_cast<ELyraNPCNeedType>(Type));
+		}
+	}
 }
 
-float ULyraNPCNeedsComponent::GetOverallWellbeing() const
+float ULyraNPCNeedsComponent::UpdateMostUrgentNeed()
 {
-	if (Needs.Num() == 0) return 100.0f;
+	MostUrgentNeed = ELyraNPCNeedType::Hunger;
+	const FLyraNPCNeedDefinition* Top = nullptr;
+	float TopPriority = -1.0f;
 
-	float TotalValue = 0.0f;
-	float TotalWeight = 0.0f;
+	// Ties go to the earlier entry
+	for (const FLyraNPCNeedDefinition& Need : GetDefinitions())
+	{
+		if (FindNeed(Need.NeedType) != &Need) continue;
+
+		const float Priority = GetPriorityAtValue(Need, GetCurrentValue(Need));
+		if (Priority > TopPriority)
+		{
+			TopPriority = Priority;
+			Top = &Need;
+		}
+	}
 
-	for (const FLyraNPCNeedState& Need : Needs)
+	if (!Top) return TNumericLimits<float>::Max();
+	MostUrgentNeed = Top->NeedType;
+
+	// Priorities grow linearly until the next threshold crossing, which is scheduled anyway, so the
+	// order only changes where a faster growing need catches up with the top one
+	const float TopGrowth = GetPriorityGrowthAtValue(*Top, GetCurrentValue(*Top));
+	float ReorderTime = TNumericLimits<float>::Max();
+
+	for (const FLyraNPCNeedDefinition& Need : GetDefinitions())
 	{
-		TotalValue += Need.CurrentValue * Need.PriorityWeight;
-		TotalWeight += Need.PriorityWeight;
+		if (&Need == Top || FindNeed(Need.NeedType) != &Need) continue;
+
+		const float Value = GetCurrentValue(Need);
+		const float GrowthGap = GetPriorityGrowthAtValue(Need, Value) - TopGrowth;
+		if (GrowthGap > 0.0f)
+		{
+			const float PriorityGap = TopPriority - GetPriorityAtValue(Need, Value);
+			ReorderTime = FMath::Min(ReorderTime, (PriorityGap + LyraNPCNeeds::ThresholdMargin) / GrowthGap);
+		}
 	}
 
-	return TotalWeight > 0.0f ? TotalValue / TotalWeight : 100.0f;
+	return ReorderTime;
 }
 
-float ULyraNPCNeedsComponent::GetNeedPriority(ELyraNPCNeedType NeedType) const
+float ULyraNPCNeedsComponent::GetUrgencyMultiplier(const FLyraNPCNeedDefinition& Need, float Value)
 {
-	const FLyraNPCNeedState* Found = FindNeed(NeedType);
-	if (!Found) return 0.0f;
+	if (Value <= Need.CriticalThreshold)
+	{
+		return 3.0f;
+	}
+	if (Value <= Need.UrgentThreshold)
+	{
+		return 2.0f;
+	}
+	return 1.0f;
+}
 
+float ULyraNPCNeedsComponent::GetPriorityAtValue(const FLyraNPCNeedDefinition& Need, float Value)
+{
 	// Priority increases as need decreases (inverse relationship)
-	float Deficit = 100.0f - Found->CurrentValue;
+	return (100.0f - Value) * Need.PriorityWeight * GetUrgencyMultiplier(Need, Value);
+}
+
+float ULyraNPCNeedsComponent::GetPriorityGrowthAtValue(const FLyraNPCNeedDefinition& Need, float Value) const
+{
+	// Needs pinned at zero or full have stopped moving
+	const float Rate = GetNetRate(Need);
+	if ((Rate < 0.0f && Value <= 0.0f) || (Rate > 0.0f && Value >= LyraNPCNeeds::SatisfiedValue)) return 0.0f;
+
+	return -Rate * Need.PriorityWeight * GetUrgencyMultiplier(Need, Value);
+}
+
+void ULyraNPCNeedsComponent::ScheduleNextEvent(float MaxTime)
+{
+	++ScheduledEventSerial;
 
-	// Apply urgency multipliers
-	float UrgencyMultiplier = 1.0f;
-	if (Found->CurrentValue <= Found->CriticalThreshold)
+	ULyraNPCWorldSubsystem* Subsystem = WorldSubsystem.Get();
+	const UWorld* World = GetWorld();
+	if (!Subsystem || !World) return;
+
+	// Earliest time any need crosses its urgent or critical threshold in either direction, or reaches zero
+	// or full where wellbeing stops changing, unless the most urgent need changes before that
+	float NextTime = MaxTime;
+	for (const FLyraNPCNeedDefinition& Need : GetDefinitions())
+	{
+		const float Rate = GetNetRate(Need);
+		if (Rate == 0.0f || FindNeed(Need.NeedType) != &Need) continue;
+
+		const float Value = GetCurrentValue(Need);
+		for (const float Threshold : { Need.UrgentThreshold, Need.CriticalThreshold, 0.0f, LyraNPCNeeds::SatisfiedValue })
+		{
+			if (Rate < 0.0f && Value > Threshold)
+			{
+				NextTime = FMath::Min(NextTime, (Value - Threshold + LyraNPCNeeds::ThresholdMargin) / -Rate);
+			}
+			else if (Rate > 0.0f && Value <= Threshold && Value < LyraNPCNeeds::SatisfiedValue)
+			{
+				NextTime = FMath::Min(NextTime, (Threshold - Value + LyraNPCNeeds::ThresholdMargin) / Rate);
+			}
+		}
+	}
+
+	if (NextTime < TNumericLimits<float>::Max())
 	{
-		UrgencyMultiplier = 3.0f;
+		const bool bGameClock = AreEventsOnGameClock();
+		const double Now = bGameClock ? GetGameClockHours() : World->GetTimeSeconds();
+		Subsystem->ScheduleNeedsEvent(this, Now + NextTime, ScheduledEventSerial, bGameClock);
 	}
-	else if (Found->CurrentValue <= Found->UrgentThreshold)
+}
+
+FLyraNPCNeedState ULyraNPCNeedsComponent::GetNeed(ELyraNPCNeedType NeedType) const
+{
+	const FLyraNPCNeedDefinition* Found = FindNeed(NeedType);
+	if (!Found) return FLyraNPCNeedState();
+
+	FLyraNPCNeedState Need;
+	Need.NeedType = NeedType;
+	Need.CurrentValue = GetCurrentValue(*Found);
+	Need.DecayRatePerHour = Found->DecayRatePerHour;
+	Need.PriorityWeight = Found->PriorityWeight;
+	Need.UrgentThreshold = Found->UrgentThreshold;
+	Need.CriticalThreshold = Found->CriticalThreshold;
+	return Need;
+}
+
+float ULyraNPCNeedsComponent::GetNeedValue(ELyraNPCNeedType NeedType) const
+{
+	const FLyraNPCNeedDefinition* Found = FindNeed(NeedType);
+	return Found ? GetCurrentValue(*Found) : LyraNPCNeeds::SatisfiedValue;
+}
+
+void ULyraNPCNeedsComponent::SetNeedValue(ELyraNPCNeedType NeedType, float NewValue)
+{
+	const int32 Type = static_cast<int32>(NeedType);
+	if (FindNeed(NeedType))
+	{
+		Materialize();
+		SetStoredValue(Type, FMath::Clamp(NewValue, 0.0f, 100.0f));
+		OnNeedsChanged();
+	}
+}
+
+void ULyraNPCNeedsComponent::ModifyNeed(ELyraNPCNeedType NeedType, float Delta)
+{
+	const int32 Type = static_cast<int32>(NeedType);
+	if (FindNeed(NeedType))
+	{
+		Materialize();
+		SetStoredValue(Type, FMath::Clamp(GetStoredValue(Type) + Delta, 0.0f, 100.0f));
+		OnNeedsChanged();
+	}
+}
+
+void ULyraNPCNeedsComponent::SatisfyNeed(ELyraNPCNeedType NeedType, float Amount)
+{
+	ModifyNeed(NeedType, Amount);
+}
+
+bool ULyraNPCNeedsComponent::HasCriticalNeed() const
+{
+	return CriticalMask != 0;
+}
+
+bool ULyraNPCNeedsComponent::HasUrgentNeed() const
+{
+	return UrgentMask != 0;
+}
+
+ELyraNPCNeedType ULyraNPCNeedsComponent::GetMostUrgentNeed() const
+{
+	return MostUrgentNeed;
+}
+
+float ULyraNPCNeedsComponent::GetOverallWellbeing() const
+{
+	float TotalValue = 0.0f;
+	float TotalWeight = 0.0f;
+
+	for (const FLyraNPCNeedDefinition& Need : GetDefinitions())
 	{
-		UrgencyMultiplier = 2.0f;
+		if (FindNeed(Need.NeedType) != &Need) continue;
+
+		TotalValue += GetCurrentValue(Need) * Need.PriorityWeight;
+		TotalWeight += Need.PriorityWeight;
 	}
 
-	return Deficit * Found->PriorityWeight * UrgencyMultiplier;
+	return TotalWeight > 0.0f ? TotalValue / TotalWeight : 100.0f;
+}
+
+float ULyraNPCNeedsComponent::GetNeedPriority(ELyraNPCNeedType NeedType) const
+{
+	const FLyraNPCNeedDefinition* Found = FindNeed(NeedType);
+	return Found ? GetPriorityAtValue(*Found, GetCurrentValue(*Found)) : 0.0f;
 }
 
 TArray<ELyraNPCNeedType> ULyraNPCNeedsComponent::GetNeedsBelowThreshold(float Threshold) const
 {
 	TArray<ELyraNPCNeedType> Result;
 
-	for (const FLyraNPCNeedState& Need : Needs)
+	for (const FLyraNPCNeedDefinition& Need : GetDefinitions())
 	{
-		if (Need.CurrentValue < Threshold)
+		if (FindNeed(Need.NeedType) == &Need && GetCurrentValue(Need) < Threshold)
 		{
 			Result.Add(Need.NeedType);
 		}
@@ -272,26 +731,35 @@ TArray<ELyraNPCNeedType> ULyraNPCNeedsComponent::GetNeedsBelowThreshold(float Th
 	return Result;
 }
 
-FLyraNPCNeedState* ULyraNPCNeedsComponent::FindNeed(ELyraNPCNeedType NeedType)
+float ULyraNPCNeedsComponent::GetEffectiveTimeScale() const
 {
-	for (FLyraNPCNeedState& Need : Needs)
+	if (!bOverrideTimeScale)
 	{
-		if (Need.NeedType == NeedType)
+		if (const ULyraNPCWorldSubsystem* Subsystem = WorldSubsystem.Get())
 		{
-			return &Need;
+			return Subsystem->GlobalTimeScale;
 		}
 	}
-	return nullptr;
+	return TimeScale;
 }
 
-const FLyraNPCNeedState* ULyraNPCNeedsComponent::FindNeed(ELyraNPCNeedType NeedType) const
+void ULyraNPCNeedsComponent::NotifyWellbeingChanged()
 {
-	for (const FLyraNPCNeedState& Need : Needs)
+	if (OnWellbeingChangedNative.IsBound())
 	{
-		if (Need.NeedType == NeedType)
-		{
-			return &Need;
-		}
+		float PerSecond, PerGameHour;
+		GetWellbeingRates(PerSecond, PerGameHour);
+		OnWellbeingChangedNative.Broadcast(GetOverallWellbeing(), PerSecond, PerGameHour);
 	}
-	return nullptr;
+}
+
+const TArray<FLyraNPCNeedDefinition>& ULyraNPCNeedsComponent::GetDefinitions() const
+{
+	static const TArray<FLyraNPCNeedDefinition> NoNeeds;
+	return ActiveProfile ? ActiveProfile->Needs : NoNeeds;
+}
+
+const FLyraNPCNeedDefinition* ULyraNPCNeedsComponent::FindNeed(ELyraNPCNeedType NeedType) const
+{
+	return ActiveProfile ? ActiveProfile->FindNeed(NeedType) : nullptr;
 }
@@ -1,6 +1,9 @@
 // Copyright LyraNPC Framework. All Rights Reserved.
 
 #include "Components/LyraNPCScheduleComponent.h"
+#include "Systems/LyraNPCWorldSubsystem.h"
+#include "Engine/World.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 #include "LyraNPCModule.h"
 
 ULyraNPCScheduleComponent::ULyraNPCScheduleComponent()
@@ -13,6 +16,9 @@ void ULyraNPCScheduleComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
+	WorldSubsystem = GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>();
+	SimulationClock.Start(GetWorld());
+
 	if (DailySchedule.Num() == 0)
 	{
 		InitializeDefaultSchedule(ELyraNPCArchetype::Villager);
@@ -23,9 +29,19 @@ void ULyraNPCScheduleComponent::BeginPlay()
 
 void ULyraNPCScheduleComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	LYRANPC_SCOPE_FRAME_COST(this);
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	UpdateGameTime(DeltaTime);
+	CatchUp();
+}
+
+void ULyraNPCScheduleComponent::CatchUp()
+{
+	const float Elapsed = SimulationClock.Advance(GetWorld());
+	if (!GetClock())
+	{
+		UpdateGameTime(Elapsed);
+	}
 	UpdateCurrentScheduleBlock();
 }
 
@@ -236,12 +252,13 @@ void ULyraNPCScheduleComponent::UpdateGameTime(float DeltaTime)
 
 void ULyraNPCScheduleComponent::UpdateCurrentScheduleBlock()
 {
-	FLyraNPCScheduleBlock NewBlock = FindScheduleBlockForHour(CurrentGameHour);
+	const float Hour = GetCurrentGameHour();
+	FLyraNPCScheduleBlock NewBlock = FindScheduleBlockForHour(Hour);
 	if (!NewBlock.ActivityTag.MatchesTagExact(CurrentScheduleBlock.ActivityTag))
 	{
 		CurrentScheduleBlock = NewBlock;
 		UE_LOG(LogLyraNPC, Verbose, TEXT("Schedule changed to: %s at hour %.1f"),
-			*CurrentScheduleBlock.ActivityTag.ToString(), CurrentGameHour);
+			*CurrentScheduleBlock.ActivityTag.ToString(), Hour);
 	}
 }
 
@@ -264,12 +281,13 @@ FLyraNPCScheduleBlock ULyraNPCScheduleComponent::GetNextScheduledActivity() cons
 {
 	if (DailySchedule.Num() == 0) return FLyraNPCScheduleBlock();
 
+	const float Hour = GetCurrentGameHour();
 	float SmallestTimeDiff = 24.0f;
 	FLyraNPCScheduleBlock NextBlock;
 
 	for (const FLyraNPCScheduleBlock& Block : DailySchedule)
 	{
-		float TimeDiff = Block.StartHour - CurrentGameHour;
+		float TimeDiff = Block.StartHour - Hour;
 		if (TimeDiff <= 0.0f) TimeDiff += 24.0f; // Wrap to next day
 		if (TimeDiff > 0.0f && TimeDiff < SmallestTimeDiff)
 		{
@@ -326,23 +344,52 @@ bool ULyraNPCScheduleComponent::ShouldBeEating() const
 
 void ULyraNPCScheduleComponent::SetGameHour(float NewHour)
 {
-	CurrentGameHour = FMath::Fmod(NewHour, 24.0f);
+	if (const ULyraNPCWorldSubsystem* Clock = GetClock())
+	{
+		GameHourOffset = FMath::Fmod(NewHour - Clock->GlobalGameHour, 24.0f);
+	}
+	else
+	{
+		CurrentGameHour = FMath::Fmod(NewHour, 24.0f);
+	}
 	UpdateCurrentScheduleBlock();
 }
 
 void ULyraNPCScheduleComponent::AdvanceTime(float Hours)
 {
-	CurrentGameHour += Hours;
-	while (CurrentGameHour >= 24.0f)
+	if (GetClock())
 	{
-		CurrentGameHour -= 24.0f;
+		GameHourOffset = FMath::Fmod(GameHourOffset + Hours, 24.0f);
+	}
+	else
+	{
+		CurrentGameHour += Hours;
+		while (CurrentGameHour >= 24.0f)
+		{
+			CurrentGameHour -= 24.0f;
+		}
 	}
 	UpdateCurrentScheduleBlock();
 }
 
+float ULyraNPCScheduleComponent::GetCurrentGameHour() const
+{
+	const ULyraNPCWorldSubsystem* Clock = GetClock();
+	if (!Clock) return CurrentGameHour;
+
+	const float Hour = FMath::Fmod(Clock->GlobalGameHour + GameHourOffset, 24.0f);
+	return Hour < 0.0f ? Hour + 24.0f : Hour;
+}
+
+const ULyraNPCWorldSubsystem* ULyraNPCScheduleComponent::GetClock() const
+{
+	return bUseGlobalClock ? WorldSubsystem.Get() : nullptr;
+}
+
 bool ULyraNPCScheduleComponent::IsNightTime() const
 {
-	return CurrentGameHour < 6.0f || CurrentGameHour >= 20.0f;
+	const float Hour = GetCurrentGameHour();
+	return Hour < 6.0f || Hour >= 20.0f;
 }
 
 bool ULyraNPCScheduleComponent::IsDayTime() const
@@ -353,7 +400,7 @@ bool ULyraNPCScheduleComponent::IsDayTime() const
 float ULyraNPCScheduleComponent::GetTimeUntilNextActivity() const
 {
 	FLyraNPCScheduleBlock NextBlock = GetNextScheduledActivity();
-	float TimeDiff = NextBlock.StartHour - CurrentGameHour;
+	float TimeDiff = NextBlock.StartHour - GetCurrentGameHour();
 	if (TimeDiff <= 0.0f) TimeDiff += 24.0f;
 	return TimeDiff;
 }
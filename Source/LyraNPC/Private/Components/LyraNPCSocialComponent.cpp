@@ -3,7 +3,9 @@
 #include "Components/LyraNPCSocialComponent.h"
 #include "Core/LyraNPCCharacter.h"
 #include "Components/LyraNPCIdentityComponent.h"
+#include "Core/LyraNPCTickStagger.h"
 #include "Net/UnrealNetwork.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 #include "LyraNPCModule.h"
 
 ULyraNPCSocialComponent::ULyraNPCSocialComponent()
@@ -16,6 +18,10 @@ ULyraNPCSocialComponent::ULyraNPCSocialComponent()
 void ULyraNPCSocialComponent::BeginPlay()
 {
 	Super::BeginPlay();
+	SimulationClock.Start(GetWorld());
+
+	// Spread the minute-long decay cadence across NPCs spawned together
+	NextDecayAfter = 60.0f * LyraNPCTickStagger::GetPhase(this);
 }
 
 void ULyraNPCSocialComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
@@ -26,10 +32,24 @@ void ULyraNPCSocialComponent::GetLifetimeReplicatedProps(TArray<FLifetimePropert
 
 void ULyraNPCSocialComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	LYRANPC_SCOPE_FRAME_COST(this);
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	TimeSinceLastDecay += DeltaTime;
-	if (TimeSinceLastDecay >= 60.0f) // Decay every minute
+	TimeSinceLastDecay += SimulationClock.Advance(GetWorld());
+	if (TimeSinceLastDecay >= NextDecayAfter) // Decay every minute
+	{
+		DecayRelationships(TimeSinceLastDecay);
+		UpdateRelationshipTypes();
+		TimeSinceLastDecay = 0.0f;
+		NextDecayAfter = 60.0f;
+	}
+}
+
+void ULyraNPCSocialComponent::CatchUp()
+{
+	// Decay is linear and clamped at neutral, so one step over the whole gap is exact
+	TimeSinceLastDecay += SimulationClock.Advance(GetWorld());
+	if (TimeSinceLastDecay > 0.0f)
 	{
 		DecayRelationships(TimeSinceLastDecay);
 		UpdateRelationshipTypes();
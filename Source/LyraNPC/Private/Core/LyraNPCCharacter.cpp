@@ -6,8 +6,13 @@
 #include "Components/LyraNPCNeedsComponent.h"
 #include "Components/LyraNPCScheduleComponent.h"
 #include "Navigation/LyraNPCPathFollowingComponent.h"
+#include "Navigation/LyraNPCRailMovementComponent.h"
 #include "Components/LyraNPCSocialComponent.h"
+#include "Systems/LyraNPCWorldSubsystem.h"
+#include "Core/LyraNPCTickStagger.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/Controller.h"
 #include "Net/UnrealNetwork.h"
 #include "LyraNPCModule.h"
 
@@ -21,6 +26,7 @@ ALyraNPCCharacter::ALyraNPCCharacter(const FObjectInitializer& ObjectInitializer
 	ScheduleComponent = CreateDefaultSubobject<ULyraNPCScheduleComponent>(TEXT("ScheduleComponent"));
 	PathFollowingComponent = CreateDefaultSubobject<ULyraNPCPathFollowingComponent>(TEXT("PathFollowingComponent"));
 	SocialComponent = CreateDefaultSubobject<ULyraNPCSocialComponent>(TEXT("SocialComponent"));
+	RailMovementComponent = CreateDefaultSubobject<ULyraNPCRailMovementComponent>(TEXT("RailMovementComponent"));
 
 	// Set default AI controller class
 	AIControllerClass = nullptr; // Will be set to LyraNPCAIController in Blueprint or manually
@@ -50,10 +56,49 @@ void ALyraNPCCharacter::BeginPlay()
 	{
 		InitializeNPC();
 	}
+
+	if (ULyraNPCWorldSubsystem* Subsystem = GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>())
+	{
+		Subsystem->RegisterNPC(this);
+	}
+}
+
+void ALyraNPCCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		if (ULyraNPCWorldSubsystem* Subsystem = World->GetSubsystem<ULyraNPCWorldSubsystem>())
+		{
+			Subsystem->UnregisterNPC(this);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ALyraNPCCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	if (ULyraNPCWorldSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>() : nullptr)
+	{
+		Subsystem->RefreshNPCController(this);
+	}
+}
+
+void ALyraNPCCharacter::UnPossessed()
+{
+	Super::UnPossessed();
+
+	if (ULyraNPCWorldSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>() : nullptr)
+	{
+		Subsystem->RefreshNPCController(this);
+	}
 }
 
 void ALyraNPCCharacter::Tick(float DeltaTime)
 {
+	LYRANPC_SCOPE_FRAME_COST(this);
 	Super::Tick(DeltaTime);
 
 	// Apply cognitive skill effects to movement
@@ -206,6 +251,15 @@ void ALyraNPCCharacter::TakeDamage(float DamageAmount, AActor* DamageCauser)
 		NeedsComponent->ModifyNeed(ELyraNPCNeedType::Safety, -20.0f);
 	}
 
+	// Being attacked by a player counts as an interaction
+	const APawn* CauserPawn = Cast<APawn>(DamageCauser);
+	const AController* CauserController = CauserPawn ? CauserPawn->GetController()
+		: DamageCauser ? DamageCauser->GetInstigatorController() : nullptr;
+	if (CauserController && CauserController->IsPlayerController())
+	{
+		NotifyPlayerInteraction();
+	}
+
 	// Check for death
 	if (CombatStats.CurrentHealth <= 0.0f)
 	{
@@ -232,8 +286,161 @@ float ALyraNPCCharacter::GetHealthPercent() const
 	return (CombatStats.CurrentHealth / CombatStats.MaxHealth) * 100.0f;
 }
 
+void ALyraNPCCharacter::ApplyLODTickProfile(const FLyraNPCLODTickProfile& Profile, float IntervalScale)
+{
+	// Each tick gets its own hashed phase so NPCs changing LOD together do not tick together
+	auto ApplyToComponent = [IntervalScale](UActorComponent* Component, const FLyraNPCTickSetting& Setting)
+	{
+		if (!Component) return;
+		Component->SetComponentTickEnabled(Setting.bTickEnabled);
+		if (Setting.bTickEnabled)
+		{
+			LyraNPCTickStagger::SetTickInterval(Component->PrimaryComponentTick, Setting.TickInterval * IntervalScale, LyraNPCTickStagger::GetPhase(Component));
+		}
+	};
+
+	SetActorTickEnabled(Profile.Character.bTickEnabled);
+	if (Profile.Character.bTickEnabled)
+	{
+		LyraNPCTickStagger::SetTickInterval(PrimaryActorTick, Profile.Character.TickInterval * IntervalScale, LyraNPCTickStagger::GetPhase(this));
+	}
+
+	ApplyToComponent(GetCharacterMovement(), Profile.CharacterMovement);
+	ApplyToComponent(CognitiveComponent, Profile.Cognitive);
+	ApplyToComponent(ScheduleComponent, Profile.Schedule);
+	ApplyToComponent(SocialComponent, Profile.Social);
+	ApplyToComponent(PathFollowingComponent, Profile.PathFollowing);
+}
+
+void ALyraNPCCharacter::CatchUpSimulation()
+{
+	if (CognitiveComponent)
+	{
+		CognitiveComponent->CatchUp();
+	}
+	if (NeedsComponent)
+	{
+		NeedsComponent->CatchUp();
+	}
+	if (ScheduleComponent)
+	{
+		ScheduleComponent->CatchUp();
+	}
+	if (SocialComponent)
+	{
+		SocialComponent->CatchUp();
+	}
+}
+
+void ALyraNPCCharacter::WriteVirtualRecord(FLyraNPCVirtualRecord& OutRecord) const
+{
+	OutRecord.CharacterClass = GetClass();
+	OutRecord.Transform = GetActorTransform();
+	OutRecord.CombatStats = CombatStats;
+
+	if (IdentityComponent)
+	{
+		OutRecord.Biography = IdentityComponent->Biography;
+		OutRecord.LifeState = IdentityComponent->CurrentLifeState;
+		OutRecord.HomeLocation = IdentityComponent->HomeLocation;
+		OutRecord.WorkplaceLocation = IdentityComponent->WorkplaceLocation;
+		OutRecord.FavoritePlaces = IdentityComponent->FavoritePlaces;
+	}
+
+	if (CognitiveComponent)
+	{
+		OutRecord.CognitiveSkill = CognitiveComponent->CognitiveSkill;
+	}
+
+	if (NeedsComponent)
+	{
+		OutRecord.NeedsProfile = NeedsComponent->Profile;
+		OutRecord.NeedsProfileArchetype = NeedsComponent->ProfileArchetype;
+		OutRecord.NeedValues = NeedsComponent->GetCurrentValues();
+	}
+
+	if (ScheduleComponent)
+	{
+		OutRecord.DailySchedule = ScheduleComponent->DailySchedule;
+		OutRecord.bUseGlobalClock = ScheduleComponent->bUseGlobalClock;
+		OutRecord.GameHourOffset = ScheduleComponent->GameHourOffset;
+		OutRecord.LocalGameHour = ScheduleComponent->CurrentGameHour;
+	}
+
+	if (SocialComponent)
+	{
+		OutRecord.Relationships = SocialComponent->Relationships;
+	}
+}
+
+void ALyraNPCCharacter::ReadVirtualRecord(const FLyraNPCVirtualRecord& Record)
+{
+	CombatStats = Record.CombatStats;
+	InitialArchetype = Record.Biography.Archetype;
+	InitialCognitiveSkill = Record.CognitiveSkill;
+	LastPlayerInteractionTime = -1.0;
+
+	if (IdentityComponent)
+	{
+		IdentityComponent->Biography = Record.Biography;
+		IdentityComponent->CurrentLifeState = Record.LifeState;
+		IdentityComponent->CurrentEmotion = ELyraNPCEmotion::Neutral;
+		IdentityComponent->HomeLocation = Record.HomeLocation;
+		IdentityComponent->WorkplaceLocation = Record.WorkplaceLocation;
+		IdentityComponent->FavoritePlaces = Record.FavoritePlaces;
+	}
+
+	// Short-term cognition is not virtualized; a pooled actor must not keep its previous NPC's
+	if (CognitiveComponent)
+	{
+		CognitiveComponent->CognitiveSkill = Record.CognitiveSkill;
+		CognitiveComponent->Memories.Reset();
+		CognitiveComponent->SetAlertLevel(ELyraNPCAlertLevel::Unaware);
+	}
+
+	if (NeedsComponent)
+	{
+		NeedsComponent->Profile = Record.NeedsProfile;
+		NeedsComponent->ProfileArchetype = Record.NeedsProfileArchetype;
+		NeedsComponent->NeedValues = Record.NeedValues;
+		NeedsComponent->ResumeSimulationFrom(Record.VirtualizedAtTime, Record.VirtualizedAtGameHours);
+	}
+
+	if (ScheduleComponent)
+	{
+		ScheduleComponent->DailySchedule = Record.DailySchedule;
+		ScheduleComponent->bUseGlobalClock = Record.bUseGlobalClock;
+		ScheduleComponent->GameHourOffset = Record.GameHourOffset;
+		ScheduleComponent->CurrentGameHour = Record.LocalGameHour;
+		ScheduleComponent->ResumeSimulationFrom(Record.VirtualizedAtTime);
+	}
+
+	if (SocialComponent)
+	{
+		SocialComponent->Relationships = Record.Relationships;
+		SocialComponent->ResumeSimulationFrom(Record.VirtualizedAtTime);
+	}
+}
+
+void ALyraNPCCharacter::NotifyPlayerInteraction()
+{
+	if (const UWorld* World = GetWorld())
+	{
+		LastPlayerInteractionTime = World->GetTimeSeconds();
+	}
+}
+
+float ALyraNPCCharacter::GetTimeSincePlayerInteraction() const
+{
+	const UWorld* World = GetWorld();
+	if (!World || LastPlayerInteractionTime < 0.0) return MAX_FLT;
+
+	return static_cast<float>(World->GetTimeSeconds() - LastPlayerInteractionTime);
+}
+
 void ALyraNPCCharacter::SetMovementStyle(ELyraNPCMovementStyle Style)
 {
+	MovementStyle = Style;
 	if (UCharacterMovementComponent* MovementComp = GetCharacterMovement())
 	{
 		float NewSpeed = GetMovementSpeedForStyle(Style);
@@ -30,22 +30,8 @@ TArray<ALyraNPCCharacter*> ULyraNPCFunctionLibrary::GetNPCsInRadius(UObject* Wor
 
 ALyraNPCCharacter* ULyraNPCFunctionLibrary::GetClosestNPC(UObject* WorldContextObject, FVector Location)
 {
-	TArray<ALyraNPCCharacter*> AllNPCs = GetAllNPCs(WorldContextObject);
-
-	ALyraNPCCharacter* Closest = nullptr;
-	float ClosestDist = MAX_FLT;
-
-	for (ALyraNPCCharacter* NPC : AllNPCs)
-	{
-		float Dist = FVector::Dist(NPC->GetActorLocation(), Location);
-		if (Dist < ClosestDist)
-		{
-			ClosestDist = Dist;
-			Closest = NPC;
-		}
-	}
-
-	return Closest;
+	ULyraNPCWorldSubsystem* Subsystem = GetNPCWorldSubsystem(WorldContextObject);
+	return Subsystem ? Subsystem->FindNearestNPC(Location) : nullptr;
 }
 
 TArray<ALyraNPCCharacter*> ULyraNPCFunctionLibrary::GetNPCsByArchetype(UObject* WorldContextObject, ELyraNPCArchetype Archetype)
@@ -119,12 +105,7 @@ ALyraNPCCharacter* ULyraNPCFunctionLibrary::SpawnNPC(UObject* WorldContextObject
 		NewNPC->InitialCognitiveSkill = CognitiveSkill;
 		NewNPC->InitializeNPC();
 
-		// Register with world subsystem
-		ULyraNPCWorldSubsystem* Subsystem = GetNPCWorldSubsystem(WorldContextObject);
-		if (Subsystem)
-		{
-			Subsystem->RegisterNPC(NewNPC);
-		}
+		// Registration with the world subsystem happens in BeginPlay
 	}
 
 	return NewNPC;
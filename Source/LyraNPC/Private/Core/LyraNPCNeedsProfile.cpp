@@ -0,0 +1,118 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#include "Core/LyraNPCNeedsProfile.h"
+
+namespace LyraNPCNeedsProfile
+{
+	static FLyraNPCNeedDefinition MakeNeed(ELyraNPCNeedType NeedType, float InitialMin, float DecayRate, float Weight, float Urgent, float Critical)
+	{
+		FLyraNPCNeedDefinition Need;
+		Need.NeedType = NeedType;
+		Need.InitialValueMin = InitialMin;
+		Need.InitialValueMax = 100.0f;
+		Need.DecayRatePerHour = DecayRate;
+		Need.PriorityWeight = Weight;
+		Need.UrgentThreshold = Urgent;
+		Need.CriticalThreshold = Critical;
+		return Need;
+	}
+}
+
+const FLyraNPCNeedDefinition* ULyraNPCNeedsProfile::FindNeed(ELyraNPCNeedType NeedType) const
+{
+	const int32 Type = static_cast<int32>(NeedType);
+	if (Type >= UE_ARRAY_COUNT(Slots)) return nullptr;
+
+	// Needs may have changed without a rebuild (e.g. mid-edit), so the slot is checked before use
+	const int32 Index = Slots[Type];
+	return Needs.IsValidIndex(Index) && Needs[Index].NeedType == NeedType ? &Needs[Index] : nullptr;
+}
+
+ULyraNPCNeedsProfile* ULyraNPCNeedsProfile::CreateBuiltIn(UObject* Outer, ELyraNPCArchetype Archetype)
+{
+	using LyraNPCNeedsProfile::MakeNeed;
+
+	ULyraNPCNeedsProfile* Profile = NewObject<ULyraNPCNeedsProfile>(Outer, NAME_None, RF_Transient);
+
+	// Hunger and energy - everyone needs to eat and rest
+	Profile->Needs.Add(MakeNeed(ELyraNPCNeedType::Hunger, 60.0f, 4.0f, 1.2f, 25.0f, 10.0f));
+	Profile->Needs.Add(MakeNeed(ELyraNPCNeedType::Energy, 70.0f, 6.0f, 1.3f, 20.0f, 5.0f));
+
+	// Social - varies by archetype
+	Profile->Needs.Add(MakeNeed(ELyraNPCNeedType::Social, 50.0f, Archetype == ELyraNPCArchetype::Traveler ? 1.0f : 3.0f, 0.8f, 20.0f, 5.0f));
+
+	// Safety only decays from events, and is high priority when low
+	Profile->Needs.Add(MakeNeed(ELyraNPCNeedType::Safety, 100.0f, 0.0f, 2.0f, 50.0f, 25.0f));
+
+	Profile->Needs.Add(MakeNeed(ELyraNPCNeedType::Comfort, 60.0f, 2.0f, 0.6f, 30.0f, 10.0f));
+	Profile->Needs.Add(MakeNeed(ELyraNPCNeedType::Entertainment, 40.0f, 2.5f, 0.5f, 15.0f, 5.0f));
+
+	// Purpose/Work - especially important for workers
+	const bool bWorker = Archetype == ELyraNPCArchetype::Worker;
+	Profile->Needs.Add(MakeNeed(ELyraNPCNeedType::Purpose, 50.0f, bWorker ? 4.0f : 2.0f, bWorker ? 1.0f : 0.7f, 25.0f, 10.0f));
+
+	Profile->RebuildSlots();
+	return Profile;
+}
+
+void ULyraNPCNeedsProfile::PostInitProperties()
+{
+	Super::PostInitProperties();
+	RebuildSlots();
+}
+
+void ULyraNPCNeedsProfile::PostLoad()
+{
+	Super::PostLoad();
+	RebuildSlots();
+}
+
+#if WITH_EDITOR
+void ULyraNPCNeedsProfile::PreEditChange(FProperty* PropertyAboutToChange)
+{
+	Super::PreEditChange(PropertyAboutToChange);
+
+	// NPCs settle their values under the old rates before they change
+	OnEdited.Broadcast(false);
+}
+
+void ULyraNPCNeedsProfile::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	RebuildSlots();
+	OnEdited.Broadcast(true);
+}
+
+void ULyraNPCNeedsProfile::PreEditUndo()
+{
+	Super::PreEditUndo();
+	OnEdited.Broadcast(false);
+}
+
+void ULyraNPCNeedsProfile::PostEditUndo()
+{
+	Super::PostEditUndo();
+
+	RebuildSlots();
+	OnEdited.Broadcast(true);
+}
+#endif
+
+void ULyraNPCNeedsProfile::RebuildSlots()
+{
+	for (int8& Slot : Slots)
+	{
+		Slot = INDEX_NONE;
+	}
+
+	// The first entry of a duplicated type wins
+	for (int32 Index = FMath::Min(Needs.Num(), static_cast<int32>(MAX_int8) + 1) - 1; Index >= 0; --Index)
+	{
+		const int32 Type = static_cast<int32>(Needs[Index].NeedType);
+		if (Type < UE_ARRAY_COUNT(Slots))
+		{
+			Slots[Type] = static_cast<int8>(Index);
+		}
+	}
+}
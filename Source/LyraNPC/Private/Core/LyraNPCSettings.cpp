@@ -0,0 +1,65 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#include "Core/LyraNPCSettings.h"
+#include "Core/LyraNPCNeedsProfile.h"
+
+ULyraNPCSettings::ULyraNPCSettings()
+{
+	SectionName = TEXT("LyraNPC");
+
+	// Full keeps every component's own default rate
+	ReducedTickProfile.Character = FLyraNPCTickSetting(true, 0.2f);
+	ReducedTickProfile.Cognitive = FLyraNPCTickSetting(true, 0.25f);
+	ReducedTickProfile.Social = FLyraNPCTickSetting(true, 20.0f);
+	ReducedTickProfile.PathFollowing = FLyraNPCTickSetting(true, 0.2f);
+
+	// Minimal is schedule-driven: coarse movement, no moment-to-moment cognition
+	MinimalTickProfile.Character = FLyraNPCTickSetting(true, 1.0f);
+	MinimalTickProfile.CharacterMovement = FLyraNPCTickSetting(true, 0.1f);
+	MinimalTickProfile.Cognitive = FLyraNPCTickSetting(true, 1.0f);
+	MinimalTickProfile.Schedule = FLyraNPCTickSetting(true, 2.0f);
+	MinimalTickProfile.Social = FLyraNPCTickSetting(true, 30.0f);
+	MinimalTickProfile.PathFollowing = FLyraNPCTickSetting(true, 0.5f);
+
+	// Dormant preserves state and does no work
+	const FLyraNPCTickSetting Off(false, 0.0f);
+	DormantTickProfile.Character = Off;
+	DormantTickProfile.CharacterMovement = Off;
+	DormantTickProfile.Cognitive = Off;
+	DormantTickProfile.Schedule = Off;
+	DormantTickProfile.Social = Off;
+	DormantTickProfile.PathFollowing = Off;
+}
+
+const FLyraNPCLODTickProfile& ULyraNPCSettings::GetTickProfile(ELyraNPCAILOD LOD) const
+{
+	switch (LOD)
+	{
+	case ELyraNPCAILOD::Full:
+		return FullTickProfile;
+	case ELyraNPCAILOD::Reduced:
+		return ReducedTickProfile;
+	case ELyraNPCAILOD::Minimal:
+		return MinimalTickProfile;
+	default:
+		return DormantTickProfile;
+	}
+}
+
+ULyraNPCNeedsProfile* ULyraNPCSettings::GetDefaultNeedsProfile(ELyraNPCArchetype Archetype) const
+{
+	if (const TSoftObjectPtr<ULyraNPCNeedsProfile>* Assigned = DefaultNeedsProfiles.Find(Archetype))
+	{
+		if (ULyraNPCNeedsProfile* Profile = Assigned->LoadSynchronous())
+		{
+			return Profile;
+		}
+	}
+
+	TObjectPtr<ULyraNPCNeedsProfile>& BuiltIn = BuiltInNeedsProfiles.FindOrAdd(Archetype);
+	if (!BuiltIn)
+	{
+		BuiltIn = ULyraNPCNeedsProfile::CreateBuiltIn(const_cast<ULyraNPCSettings*>(this), Archetype);
+	}
+	return BuiltIn;
+}
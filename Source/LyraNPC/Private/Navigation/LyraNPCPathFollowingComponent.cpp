@@ -1,6 +1,7 @@
 // Copyright LyraNPC Framework. All Rights Reserved.
 
 #include "Navigation/LyraNPCPathFollowingComponent.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 #include "LyraNPCModule.h"
 
 ULyraNPCPathFollowingComponent::ULyraNPCPathFollowingComponent()
@@ -16,6 +17,7 @@ void ULyraNPCPathFollowingComponent::BeginPlay()
 
 void ULyraNPCPathFollowingComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	LYRANPC_SCOPE_FRAME_COST(this);
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
 	if (bIsWaitingAtPoint)
@@ -0,0 +1,314 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#include "Navigation/LyraNPCRailMovementComponent.h"
+#include "Core/LyraNPCCharacter.h"
+#include "Core/LyraNPCTickStagger.h"
+#include "Systems/LyraNPCWorldSubsystem.h"
+#include "AIController.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Systems/LyraNPCFrameGovernor.h"
+#include "LyraNPCModule.h"
+
+ULyraNPCRailMovementComponent::ULyraNPCRailMovementComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickInterval = 0.1f;
+}
+
+void ULyraNPCRailMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	LeaveRail();
+	Super::EndPlay(EndPlayReason);
+}
+
+void ULyraNPCRailMovementComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	LYRANPC_SCOPE_FRAME_COST(this);
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!bRailAllowed) return;
+
+	if (!bFollowingRequest)
+	{
+		TryEnterRail();
+		return;
+	}
+
+	// An abort or a new move request replaced the one we paused
+	const UPathFollowingComponent* PathFollowing = GetPathFollowing();
+	if (!PathFollowing || PathFollowing->GetStatus() != EPathFollowingStatus::Paused || PathFollowing->GetCurrentRequestId() != RailRequestId)
+	{
+		LeaveRail();
+		return;
+	}
+
+	if (!AdvanceRail(DeltaTime))
+	{
+		// At the goal: hand the request back so path following completes it
+		FinishedRequestId = RailRequestId;
+		LeaveRail();
+	}
+}
+
+void ULyraNPCRailMovementComponent::SetRailAllowed(bool bAllowed)
+{
+	bRailAllowed = bAllowed;
+	SetComponentTickEnabled(bAllowed);
+	if (bAllowed)
+	{
+		LyraNPCTickStagger::SetTickInterval(PrimaryComponentTick, PrimaryComponentTick.TickInterval, LyraNPCTickStagger::GetPhase(this));
+	}
+
+	if (!bAllowed)
+	{
+		LeaveRail();
+	}
+	else if (bFollowingRequest)
+	{
+		// A tick profile may have just switched movement back on
+		if (UCharacterMovementComponent* Movement = GetOwner<ACharacter>() ? GetOwner<ACharacter>()->GetCharacterMovement() : nullptr)
+		{
+			Movement->SetComponentTickEnabled(false);
+		}
+	}
+}
+
+void ULyraNPCRailMovementComponent::StartRail(TArrayView<const FVector> Points, float Speed)
+{
+	RailPoints = Points;
+	RailDistances.Reset(RailPoints.Num());
+
+	float Distance = 0.0f;
+	for (int32 Index = 0; Index < RailPoints.Num(); ++Index)
+	{
+		if (Index > 0)
+		{
+			Distance += FVector::Dist(RailPoints[Index - 1], RailPoints[Index]);
+		}
+		RailDistances.Add(Distance);
+	}
+
+	RailDistance = 0.0f;
+	RailSegment = 0;
+	RailSpeed = FMath::Max(Speed, 0.0f);
+}
+
+void ULyraNPCRailMovementComponent::ClearRail()
+{
+	RailPoints.Reset();
+	RailDistances.Reset();
+	RailDistance = 0.0f;
+	RailSegment = 0;
+}
+
+bool ULyraNPCRailMovementComponent::AdvanceRail(float DeltaTime)
+{
+	ACharacter* Character = GetOwner<ACharacter>();
+	if (!Character || RailPoints.Num() < 2) return false;
+
+	const float Length = RailDistances.Last();
+	RailDistance = FMath::Min(RailDistance + RailSpeed * DeltaTime, Length);
+	while (RailSegment < RailPoints.Num() - 2 && RailDistance > RailDistances[RailSegment + 1])
+	{
+		++RailSegment;
+	}
+
+	const FVector& From = RailPoints[RailSegment];
+	const FVector& To = RailPoints[RailSegment + 1];
+	const float SegmentLength = RailDistances[RailSegment + 1] - RailDistances[RailSegment];
+	const float Alpha = SegmentLength > KINDA_SMALL_NUMBER ? (RailDistance - RailDistances[RailSegment]) / SegmentLength : 1.0f;
+
+	// Face along the segment, yaw only
+	const FVector Direction = (To - From).GetSafeNormal2D();
+	const FRotator Rotation = Direction.IsNearlyZero() ? Character->GetActorRotation() : Direction.Rotation();
+	Character->SetActorLocationAndRotation(FMath::Lerp(From, To, Alpha), Rotation);
+
+	// Keep velocity plausible for animation and replication
+	if (UCharacterMovementComponent* Movement = Character->GetCharacterMovement())
+	{
+		Movement->Velocity = Direction * RailSpeed;
+	}
+
+	return RailDistance < Length;
+}
+
+UPathFollowingComponent* ULyraNPCRailMovementComponent::GetPathFollowing() const
+{
+	const APawn* Pawn = GetOwner<APawn>();
+	const AAIController* Controller = Pawn ? Cast<AAIController>(Pawn->GetController()) : nullptr;
+	return Controller ? Controller->GetPathFollowingComponent() : nullptr;
+}
+
+bool ULyraNPCRailMovementComponent::TryEnterRail()
+{
+	ALyraNPCCharacter* NPC = GetOwner<ALyraNPCCharacter>();
+	UPathFollowingComponent* PathFollowing = GetPathFollowing();
+	if (!NPC || !PathFollowing || PathFollowing->GetStatus() != EPathFollowingStatus::Moving) return false;
+
+	const FAIRequestID RequestId = PathFollowing->GetCurrentRequestId();
+	if (RequestId == FinishedRequestId) return false;
+
+	const FNavPathSharedPtr Path = PathFollowing->GetPath();
+	if (!Path.IsValid() || !Path->IsValid()) return false;
+
+	const TArray<FNavPathPoint>& PathPoints = Path->GetPathPoints();
+	const int32 CurrentIndex = PathFollowing->GetCurrentPathIndex();
+	const int32 NextIndex = PathFollowing->GetNextPathIndex();
+	if (!PathPoints.IsValidIndex(CurrentIndex) || !PathPoints.IsValidIndex(NextIndex)) return false;
+
+	// Path points lie on the navmesh; keep the capsule at its current height above it
+	const FVector Start = NPC->GetActorLocation();
+	const FVector HeightOffset(0.0f, 0.0f, Start.Z - PathPoints[CurrentIndex].Location.Z);
+
+	TArray<FVector, TInlineAllocator<16>> Points;
+	Points.Add(Start);
+	for (int32 Index = NextIndex; Index < PathPoints.Num(); ++Index)
+	{
+		Points.Add(PathPoints[Index].Location + HeightOffset);
+	}
+
+	StartRail(Points, NPC->GetMovementSpeedForStyle(NPC->GetMovementStyle()));
+
+	PathFollowing->PauseMove(RequestId, EPathFollowingVelocityMode::Keep);
+	if (UCharacterMovementComponent* Movement = NPC->GetCharacterMovement())
+	{
+		Movement->DisableMovement();
+		Movement->SetComponentTickEnabled(false);
+	}
+
+	RailRequestId = RequestId;
+	bFollowingRequest = true;
+	return true;
+}
+
+void ULyraNPCRailMovementComponent::LeaveRail()
+{
+	if (!bFollowingRequest) return;
+	bFollowingRequest = false;
+	ClearRail();
+
+	if (ACharacter* Character = GetOwner<ACharacter>())
+	{
+		if (UCharacterMovementComponent* Movement = Character->GetCharacterMovement())
+		{
+			Movement->SetComponentTickEnabled(true);
+			Movement->SetDefaultMovementMode();
+		}
+	}
+
+	// Path following picks the nearest segment again since the agent moved while paused
+	UPathFollowingComponent* PathFollowing = GetPathFollowing();
+	if (PathFollowing && PathFollowing->GetStatus() == EPathFollowingStatus::Paused && PathFollowing->GetCurrentRequestId() == RailRequestId)
+	{
+		PathFollowing->ResumeMove(RailRequestId);
+	}
+
+	RailRequestId = FAIRequestID::InvalidRequest;
+}
+
+// ===== BENCHMARK =====
+
+namespace LyraNPCRailMovement
+{
+	static constexpr float BenchmarkDeltaTime = 1.0f / 30.0f;
+
+	// Moves every registered NPC straight ahead for a number of frames, once with character movement
+	// and once on a rail, and logs the cost per NPC per frame. Transforms are restored afterwards.
+	static void BenchmarkMovement(const TArray<FString>& Args, UWorld* World)
+	{
+		const ULyraNPCWorldSubsystem* Subsystem = World ? World->GetSubsystem<ULyraNPCWorldSubsystem>() : nullptr;
+		if (!Subsystem) return;
+
+		const int32 Frames = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 60;
+
+		struct FSavedNPC
+		{
+			ALyraNPCCharacter* NPC;
+			FTransform Transform;
+			FVector Velocity;
+			TEnumAsByte<EMovementMode> MovementMode;
+		};
+
+		TArray<FSavedNPC> Saved;
+		for (ALyraNPCCharacter* NPC : Subsystem->GetNPCView())
+		{
+			if (!NPC || !NPC->GetCharacterMovement() || !NPC->RailMovementComponent || NPC->RailMovementComponent->IsOnRail()) continue;
+			Saved.Add({ NPC, NPC->GetActorTransform(), NPC->GetCharacterMovement()->Velocity, NPC->GetCharacterMovement()->MovementMode });
+		}
+
+		if (Saved.Num() == 0)
+		{
+			UE_LOG(LogLyraNPC, Display, TEXT("LyraNPC.BenchmarkMovement: no NPCs to move"));
+			return;
+		}
+
+		auto Restore = [&Saved]()
+		{
+			for (const FSavedNPC& Entry : Saved)
+			{
+				Entry.NPC->SetActorTransform(Entry.Transform, false, nullptr, ETeleportType::TeleportPhysics);
+				Entry.NPC->GetCharacterMovement()->SetMovementMode(Entry.MovementMode);
+				Entry.NPC->GetCharacterMovement()->Velocity = Entry.Velocity;
+			}
+		};
+
+		// Character movement: what path following drives every frame, a direct move request then a walking update
+		for (const FSavedNPC& Entry : Saved)
+		{
+			Entry.NPC->GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+		}
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			for (const FSavedNPC& Entry : Saved)
+			{
+				UCharacterMovementComponent* Movement = Entry.NPC->GetCharacterMovement();
+				const float Speed = Entry.NPC->GetMovementSpeedForStyle(Entry.NPC->GetMovementStyle());
+				Movement->RequestDirectMove(Entry.NPC->GetActorForwardVector() * Speed, false);
+				Movement->TickComponent(BenchmarkDeltaTime, LEVELTICK_All, &Movement->PrimaryComponentTick);
+			}
+		}
+		const double MovementSeconds = FPlatformTime::Seconds() - StartTime;
+		Restore();
+
+		// Rail: the same distance along a straight rail
+		for (const FSavedNPC& Entry : Saved)
+		{
+			const float Speed = Entry.NPC->GetMovementSpeedForStyle(Entry.NPC->GetMovementStyle());
+			const FVector Start = Entry.NPC->GetActorLocation();
+			const FVector Points[] = { Start, Start + Entry.NPC->GetActorForwardVector() * Speed * BenchmarkDeltaTime * Frames };
+			Entry.NPC->RailMovementComponent->StartRail(Points, Speed);
+		}
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			for (const FSavedNPC& Entry : Saved)
+			{
+				Entry.NPC->RailMovementComponent->AdvanceRail(BenchmarkDeltaTime);
+			}
+		}
+		const double RailSeconds = FPlatformTime::Seconds() - StartTime;
+
+		for (const FSavedNPC& Entry : Saved)
+		{
+			Entry.NPC->RailMovementComponent->ClearRail();
+		}
+		Restore();
+
+		const double Samples = static_cast<double>(Saved.Num()) * Frames;
+		const double MovementMicros = MovementSeconds * 1e6 / Samples;
+		const double RailMicros = RailSeconds * 1e6 / Samples;
+		UE_LOG(LogLyraNPC, Display, TEXT("LyraNPC.BenchmarkMovement: %d NPCs x %d frames: character movement %.2f us/NPC/frame, rail %.2f us/NPC/frame (%.1fx)"),
+			Saved.Num(), Frames, MovementMicros, RailMicros, RailMicros > 0.0 ? MovementMicros / RailMicros : 0.0);
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs BenchmarkMovementCommand(
+		TEXT("LyraNPC.BenchmarkMovement"),
+		TEXT("Times walking character movement against rail movement for every registered NPC. Usage: LyraNPC.BenchmarkMovement [Frames=60]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BenchmarkMovement));
+}
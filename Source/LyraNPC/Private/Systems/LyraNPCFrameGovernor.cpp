@@ -0,0 +1,96 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#include "Systems/LyraNPCFrameGovernor.h"
+#include "Systems/LyraNPCWorldSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+
+namespace LyraNPCFrameGovernor
+{
+	// Weight of the newest frame in the smoothed cost
+	static constexpr float SmoothingAlpha = 0.1f;
+
+	// Seconds over budget before stepping up, and comfortably under it before stepping down.
+	// Relaxing is slower so a level that just paid off is not dropped straight away.
+	static constexpr float EscalateDelay = 0.25f;
+	static constexpr float RelaxDelay = 2.0f;
+
+	// Open FScopedCost scopes on this thread
+	static thread_local int32 ScopeDepth = 0;
+}
+
+FLyraNPCFrameGovernor::FScopedCost::FScopedCost(const UObject* WorldContext)
+{
+	if (LyraNPCFrameGovernor::ScopeDepth++ != 0) return;
+
+	// Each world's subsystem owns its governor, so PIE worlds are budgeted separately
+	const UWorld* World = WorldContext ? WorldContext->GetWorld() : nullptr;
+	if (ULyraNPCWorldSubsystem* Subsystem = World ? World->GetSubsystem<ULyraNPCWorldSubsystem>() : nullptr)
+	{
+		Governor = &Subsystem->GetFrameGovernor();
+		StartCycles = FPlatformTime::Cycles64();
+	}
+}
+
+FLyraNPCFrameGovernor::FScopedCost::~FScopedCost()
+{
+	if (--LyraNPCFrameGovernor::ScopeDepth == 0 && Governor)
+	{
+		Governor->AddCost(FPlatformTime::Cycles64() - StartCycles);
+	}
+}
+
+bool FLyraNPCFrameGovernor::Tick(float DeltaTime)
+{
+	const uint64 Cycles = FrameCycles.exchange(0, std::memory_order_relaxed);
+	LastFrameCostMs = static_cast<float>(FPlatformTime::ToMilliseconds64(Cycles));
+	SmoothedCostMs = FMath::Lerp(SmoothedCostMs, LastFrameCostMs, LyraNPCFrameGovernor::SmoothingAlpha);
+
+	const int32 OldLevel = Level;
+	if (BudgetMs <= 0.0f)
+	{
+		Level = 0;
+		TimeOverBudget = 0.0f;
+		TimeUnderBudget = 0.0f;
+		return Level != OldLevel;
+	}
+
+	if (SmoothedCostMs > BudgetMs)
+	{
+		TimeUnderBudget = 0.0f;
+		TimeOverBudget += DeltaTime;
+		if (TimeOverBudget >= LyraNPCFrameGovernor::EscalateDelay && Level < MaxLevel)
+		{
+			++Level;
+			TimeOverBudget = 0.0f;
+		}
+	}
+	else if (SmoothedCostMs < BudgetMs * RelaxFraction)
+	{
+		TimeOverBudget = 0.0f;
+		TimeUnderBudget += DeltaTime;
+		if (TimeUnderBudget >= LyraNPCFrameGovernor::RelaxDelay && Level > 0)
+		{
+			--Level;
+			TimeUnderBudget = 0.0f;
+		}
+	}
+	else
+	{
+		TimeOverBudget = 0.0f;
+		TimeUnderBudget = 0.0f;
+	}
+
+	Level = FMath::Clamp(Level, 0, FMath::Max(MaxLevel, 0));
+	return Level != OldLevel;
+}
+
+void FLyraNPCFrameGovernor::Reset()
+{
+	FrameCycles.store(0, std::memory_order_relaxed);
+	Level = 0;
+	LastFrameCostMs = 0.0f;
+	SmoothedCostMs = 0.0f;
+	TimeOverBudget = 0.0f;
+	TimeUnderBudget = 0.0f;
+}
@@ -0,0 +1,396 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#include "Systems/LyraNPCLODManager.h"
+#include "Core/LyraNPCCharacter.h"
+#include "AI/Controllers/LyraNPCAIController.h"
+#include "Core/LyraNPCSettings.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "LyraNPCModule.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("LOD Transitions Applied"), STAT_LyraNPC_LODTransitionsApplied, STATGROUP_LyraNPC);
+DECLARE_DWORD_COUNTER_STAT(TEXT("LOD Transitions Deferred"), STAT_LyraNPC_LODTransitionsDeferred, STATGROUP_LyraNPC);
+
+namespace LyraNPCLODManager
+{
+	// Below this many viewers a straight scan beats reading the grid
+	static constexpr int32 MinViewersForGrid = 8;
+
+	// Farthest a viewer is stamped, in cells, so one distant query cannot blow up the stamp
+	static constexpr int32 MaxStampRadiusInCells = 4;
+
+	static constexpr float MinViewerWeight = 0.01f;
+}
+
+void FLyraNPCLODManager::Reset()
+{
+	Viewers.Reset();
+	ViewerCells.Reset();
+	ViewPoints.Reset();
+	StampedReach = 0.0f;
+	LargestQueryDistance = 0.0f;
+	Cursor = 0;
+	SliceRemainder = 0.0f;
+	PassSignificance.Reset();
+	for (float& Threshold : SignificanceThresholds)
+	{
+		Threshold = -MAX_FLT;
+	}
+	PendingTransitions.Reset();
+	FMemory::Memzero(PendingIntoLOD);
+	ResetStats();
+}
+
+int32 FLyraNPCLODManager::AddViewPoint(const FVector& Location, float Weight)
+{
+	const int32 ViewPointId = NextViewPointId++;
+	ViewPoints.Add(ViewPointId, FViewPoint{ nullptr, Location, Weight });
+	return ViewPointId;
+}
+
+int32 FLyraNPCLODManager::AddViewPoint(const AActor* Actor, float Weight)
+{
+	if (!Actor) return INDEX_NONE;
+
+	const int32 ViewPointId = NextViewPointId++;
+	ViewPoints.Add(ViewPointId, FViewPoint{ Actor, Actor->GetActorLocation(), Weight });
+	return ViewPointId;
+}
+
+void FLyraNPCLODManager::UpdateViewPoint(int32 ViewPointId, const FVector& Location, float Weight)
+{
+	if (FViewPoint* ViewPoint = ViewPoints.Find(ViewPointId))
+	{
+		ViewPoint->Location = Location;
+		ViewPoint->Weight = Weight;
+	}
+}
+
+void FLyraNPCLODManager::RemoveViewPoint(int32 ViewPointId)
+{
+	ViewPoints.Remove(ViewPointId);
+}
+
+void FLyraNPCLODManager::Tick(TArrayView<ALyraNPCCharacter* const> NPCs, TArrayView<const int32> LODCounts, float DeltaTime)
+{
+	// Spread one pass over UpdatePeriod, carrying the fractional NPC into the next frame
+	const float Budget = NPCs.Num() * DeltaTime / FMath::Max(UpdatePeriod, KINDA_SMALL_NUMBER) + SliceRemainder;
+	const int32 Count = FMath::Min(FMath::FloorToInt(Budget), NPCs.Num());
+	SliceRemainder = Count < NPCs.Num() ? Budget - Count : 0.0f;
+
+	const ULyraNPCSettings& Settings = *GetDefault<ULyraNPCSettings>();
+
+	for (int32 Step = 0; Step < Count; ++Step)
+	{
+		if (Cursor >= NPCs.Num())
+		{
+			Cursor = 0;
+			UpdateSignificanceThresholds(Settings);
+		}
+		Evaluate(NPCs[Cursor++], LODCounts, Settings);
+	}
+
+	// Drain the queue even on frames that evaluated nobody
+	ApplyTransitions();
+}
+
+float FLyraNPCLODManager::ComputeSignificance(const ALyraNPCCharacter* NPC, float Distance, const ULyraNPCSettings& Settings)
+{
+	float Significance = Settings.DistanceWeight * FMath::Max(0.0f, 1.0f - Distance / FMath::Max(Settings.SignificanceDistance, 1.0f));
+
+	const ELyraNPCAlertLevel AlertLevel = NPC->GetAlertLevel();
+	Significance += Settings.AlertLevelWeight * static_cast<int32>(AlertLevel);
+	if (AlertLevel == ELyraNPCAlertLevel::Combat)
+	{
+		Significance += Settings.CombatBonus;
+	}
+
+	// Interaction bonus fades linearly over the memory window
+	const float SinceInteraction = NPC->GetTimeSincePlayerInteraction();
+	if (SinceInteraction < Settings.PlayerInteractionMemory)
+	{
+		Significance += Settings.PlayerInteractionBonus * (1.0f - SinceInteraction / Settings.PlayerInteractionMemory);
+	}
+
+	return Significance;
+}
+
+float FLyraNPCLODManager::GetDistanceToNearestViewer(const FVector& Location, float MaxDistance) const
+{
+	LargestQueryDistance = FMath::Max(LargestQueryDistance, MaxDistance);
+
+	double NearestDistSq = static_cast<double>(MaxDistance) * MaxDistance;
+	bool bFound = false;
+
+	auto Visit = [&](const FViewer& Viewer)
+	{
+		const double DistSq = FVector::DistSquared(Location, Viewer.Location) * Viewer.InvWeightSq;
+		if (DistSq <= NearestDistSq)
+		{
+			NearestDistSq = DistSq;
+			bFound = true;
+		}
+	};
+
+	if (MaxDistance <= StampedReach)
+	{
+		if (const TArray<int32, TInlineAllocator<4>>* CellViewers = ViewerCells.Find(GetCell(Location)))
+		{
+			for (int32 ViewerIndex : *CellViewers)
+			{
+				Visit(Viewers[ViewerIndex]);
+			}
+		}
+	}
+	else
+	{
+		for (const FViewer& Viewer : Viewers)
+		{
+			Visit(Viewer);
+		}
+	}
+
+	return bFound ? static_cast<float>(FMath::Sqrt(NearestDistSq)) : MAX_FLT;
+}
+
+void FLyraNPCLODManager::GatherViewers(const UWorld* World)
+{
+	Viewers.Reset();
+	MaxViewerWeight = LyraNPCLODManager::MinViewerWeight;
+	if (!World) return;
+
+	if (bUsePlayerViewPoints)
+	{
+		for (FConstPlayerControllerIterator Iterator = World->GetPlayerControllerIterator(); Iterator; ++Iterator)
+		{
+			const APlayerController* PC = Iterator->Get();
+			if (!PC) continue;
+
+			// The view point follows the camera, so spectators and detached cameras count too
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			AddViewer(ViewLocation, PlayerViewPointWeight);
+		}
+	}
+
+	for (auto It = ViewPoints.CreateIterator(); It; ++It)
+	{
+		FViewPoint& ViewPoint = It.Value();
+		if (!ViewPoint.Actor.IsExplicitlyNull())
+		{
+			const AActor* Actor = ViewPoint.Actor.Get();
+			if (!Actor)
+			{
+				It.RemoveCurrent();
+				continue;
+			}
+			ViewPoint.Location = Actor->GetActorLocation();
+		}
+		AddViewer(ViewPoint.Location, ViewPoint.Weight);
+	}
+
+	StampViewers();
+}
+
+void FLyraNPCLODManager::AddViewer(const FVector& Location, float Weight)
+{
+	FViewer& Viewer = Viewers.AddDefaulted_GetRef();
+	Viewer.Location = Location;
+	Viewer.Weight = FMath::Max(Weight, LyraNPCLODManager::MinViewerWeight);
+	Viewer.InvWeightSq = 1.0f / (Viewer.Weight * Viewer.Weight);
+	MaxViewerWeight = FMath::Max(MaxViewerWeight, Viewer.Weight);
+}
+
+void FLyraNPCLODManager::StampViewers()
+{
+	ViewerCells.Reset();
+	StampedReach = 0.0f;
+	if (Viewers.Num() < LyraNPCLODManager::MinViewersForGrid) return;
+
+	// Cover last frame's largest query, as far as the cap allows for the heaviest viewer
+	StampedReach = FMath::Min(LargestQueryDistance, LyraNPCLODManager::MaxStampRadiusInCells * CellSize / MaxViewerWeight);
+
+	// A viewer reaches an NPC at distance D when D / Weight <= StampedReach; stamping the square
+	// around that circle lists it in every cell such an NPC could be in
+	for (int32 ViewerIndex = 0; ViewerIndex < Viewers.Num(); ++ViewerIndex)
+	{
+		const FViewer& Viewer = Viewers[ViewerIndex];
+		const FVector Reach(StampedReach * Viewer.Weight);
+		const FIntPoint MinCell = GetCell(Viewer.Location - Reach);
+		const FIntPoint MaxCell = GetCell(Viewer.Location + Reach);
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				ViewerCells.FindOrAdd(FIntPoint(X, Y)).Add(ViewerIndex);
+			}
+		}
+	}
+}
+
+FIntPoint FLyraNPCLODManager::GetCell(const FVector& Location) const
+{
+	// Clamped like TLyraNPCSpatialHash so far-off locations cannot overflow the coordinates
+	return FIntPoint(
+		FMath::FloorToInt32(FMath::Clamp(Location.X / CellSize, -1.0e9, 1.0e9)),
+		FMath::FloorToInt32(FMath::Clamp(Location.Y / CellSize, -1.0e9, 1.0e9)));
+}
+
+void FLyraNPCLODManager::Evaluate(ALyraNPCCharacter* NPC, TArrayView<const int32> LODCounts, const ULyraNPCSettings& Settings)
+{
+	ALyraNPCAIController* Controller = Cast<ALyraNPCAIController>(NPC->GetController());
+	if (!Controller || !Controller->bUseSubsystemLOD) return;
+
+	++NumEvaluated;
+
+	if (!Settings.bUseSignificanceLOD)
+	{
+		// Nothing beyond MinimalLODDistance (plus its hysteresis) can be above Dormant, so that bounds the viewer search
+		const float Distance = GetDistanceToNearestViewer(NPC->GetActorLocation(), (Controller->MinimalLODDistance + Controller->MinimalLODHysteresis) * LODDistanceScale);
+		RequestTransition(Controller, Controller->GetLODForDistance(Distance / LODDistanceScale), Distance);
+		return;
+	}
+
+	// The distance term also needs viewers out to SignificanceDistance
+	const float SearchDistance = FMath::Max((Controller->MinimalLODDistance + Controller->MinimalLODHysteresis) * LODDistanceScale, Settings.SignificanceDistance);
+	const float Distance = GetDistanceToNearestViewer(NPC->GetActorLocation(), SearchDistance);
+	const float Significance = ComputeSignificance(NPC, Distance, Settings);
+	Controller->LODSignificance = Significance;
+	PassSignificance.Add(Significance);
+
+	// Distance bands still apply; rank can only make an NPC coarser
+	ELyraNPCAILOD NewLOD = FMath::Max(Controller->GetLODForDistance(Distance / LODDistanceScale), GetLODForSignificance(Significance));
+
+	// Hard cap: step down while the target band is already full, counting changes still queued into it.
+	// The NPC's current band already counts it, and its own queued change does not block it.
+	const FPendingTransition* OwnPending = PendingTransitions.Find(Controller);
+	const int32 Budgets[] = { Settings.MaxFullLODNPCs, Settings.MaxReducedLODNPCs, Settings.MaxMinimalLODNPCs };
+	while (NewLOD < ELyraNPCAILOD::Dormant && NewLOD != Controller->CurrentAILOD)
+	{
+		const int32 Band = static_cast<int32>(NewLOD);
+		if (!LODCounts.IsValidIndex(Band)) break;
+
+		const int32 Occupied = LODCounts[Band] + PendingIntoLOD[Band] - (OwnPending && OwnPending->LOD == NewLOD ? 1 : 0);
+		if (Occupied < Budgets[Band]) break;
+		NewLOD = static_cast<ELyraNPCAILOD>(Band + 1);
+	}
+
+	RequestTransition(Controller, NewLOD, Distance);
+}
+
+void FLyraNPCLODManager::RequestTransition(ALyraNPCAIController* Controller, ELyraNPCAILOD NewLOD, float Distance)
+{
+	if (FPendingTransition* Pending = PendingTransitions.Find(Controller))
+	{
+		--PendingIntoLOD[static_cast<int32>(Pending->LOD)];
+		if (NewLOD == Controller->CurrentAILOD)
+		{
+			PendingTransitions.Remove(Controller);
+			return;
+		}
+		Pending->LOD = NewLOD;
+		Pending->Distance = Distance;
+		++PendingIntoLOD[static_cast<int32>(NewLOD)];
+		return;
+	}
+
+	if (NewLOD == Controller->CurrentAILOD) return;
+
+	if (MaxTransitionsPerFrame <= 0)
+	{
+		Controller->SetAILOD(NewLOD);
+		++NumChanged;
+		INC_DWORD_STAT(STAT_LyraNPC_LODTransitionsApplied);
+		return;
+	}
+
+	PendingTransitions.Add(Controller, FPendingTransition{ NewLOD, Distance });
+	++PendingIntoLOD[static_cast<int32>(NewLOD)];
+}
+
+void FLyraNPCLODManager::ApplyTransitions()
+{
+	if (PendingTransitions.Num() == 0) return;
+
+	struct FOrderedTransition
+	{
+		ALyraNPCAIController* Controller;
+		ELyraNPCAILOD LOD;
+		float Distance;
+	};
+
+	TArray<FOrderedTransition, TInlineAllocator<64>> Ordered;
+	Ordered.Reserve(PendingTransitions.Num());
+	for (auto It = PendingTransitions.CreateIterator(); It; ++It)
+	{
+		ALyraNPCAIController* Controller = It.Key().Get();
+		if (!Controller)
+		{
+			--PendingIntoLOD[static_cast<int32>(It.Value().LOD)];
+			It.RemoveCurrent();
+			continue;
+		}
+		Ordered.Add(FOrderedTransition{ Controller, It.Value().LOD, It.Value().Distance });
+	}
+
+	// Nearest first: those are the changes a viewer would notice
+	Ordered.Sort([](const FOrderedTransition& A, const FOrderedTransition& B) { return A.Distance < B.Distance; });
+
+	const int32 NumToApply = MaxTransitionsPerFrame > 0 ? FMath::Min(MaxTransitionsPerFrame, Ordered.Num()) : Ordered.Num();
+	for (int32 Index = 0; Index < NumToApply; ++Index)
+	{
+		const FOrderedTransition& Transition = Ordered[Index];
+		PendingTransitions.Remove(Transition.Controller);
+		--PendingIntoLOD[static_cast<int32>(Transition.LOD)];
+
+		Transition.Controller->SetAILOD(Transition.LOD);
+		++NumChanged;
+	}
+
+	NumDeferred += PendingTransitions.Num();
+	INC_DWORD_STAT_BY(STAT_LyraNPC_LODTransitionsApplied, NumToApply);
+	INC_DWORD_STAT_BY(STAT_LyraNPC_LODTransitionsDeferred, PendingTransitions.Num());
+}
+
+void FLyraNPCLODManager::UpdateSignificanceThresholds(const ULyraNPCSettings& Settings)
+{
+	if (!Settings.bUseSignificanceLOD || PassSignificance.Num() == 0)
+	{
+		PassSignificance.Reset();
+		return;
+	}
+
+	PassSignificance.Sort(TGreater<float>());
+
+	// The budgets stack: the Reduced cut is the (Full + Reduced)th score, and so on
+	const int32 Budgets[] = { Settings.MaxFullLODNPCs, Settings.MaxReducedLODNPCs, Settings.MaxMinimalLODNPCs };
+	int32 Rank = 0;
+	for (int32 Band = 0; Band < UE_ARRAY_COUNT(SignificanceThresholds); ++Band)
+	{
+		Rank += FMath::Max(Budgets[Band], 0);
+		if (Rank == 0)
+		{
+			SignificanceThresholds[Band] = MAX_FLT;
+		}
+		else
+		{
+			SignificanceThresholds[Band] = Rank <= PassSignificance.Num() ? PassSignificance[Rank - 1] : -MAX_FLT;
+		}
+	}
+
+	PassSignificance.Reset();
+}
+
+ELyraNPCAILOD FLyraNPCLODManager::GetLODForSignificance(float Significance) const
+{
+	for (int32 Band = 0; Band < UE_ARRAY_COUNT(SignificanceThresholds); ++Band)
+	{
+		if (Significance >= SignificanceThresholds[Band])
+		{
+			return static_cast<ELyraNPCAILOD>(Band);
+		}
+	}
+	return ELyraNPCAILOD::Dormant;
+}
@@ -0,0 +1,196 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#include "Systems/LyraNPCNameIndex.h"
+
+namespace LyraNPCNameIndex
+{
+	static bool HandleLess(const FLyraNPCHandle& A, const FLyraNPCHandle& B)
+	{
+		return A.Index != B.Index ? A.Index < B.Index : A.Generation < B.Generation;
+	}
+
+	// Orders (Text, Handle) pairs; a null Key handle sorts before every handle with equal text
+	static bool EntryLess(const TCHAR* Text, const FLyraNPCHandle& Handle, const TCHAR* Key, const FLyraNPCHandle* KeyHandle)
+	{
+		const int32 Cmp = FCString::Strcmp(Text, Key);
+		return Cmp < 0 || (Cmp == 0 && KeyHandle && HandleLess(Handle, *KeyHandle));
+	}
+}
+
+FString FLyraNPCNameIndex::Normalize(const FString& Name)
+{
+	return Name.TrimStartAndEnd().ToLower();
+}
+
+void FLyraNPCNameIndex::Set(const FLyraNPCHandle& Handle, const FString& Name)
+{
+	const FString NormalizedName = Normalize(Name);
+
+	if (const FString* Existing = Names.Find(Handle))
+	{
+		if (*Existing == NormalizedName) return;
+		Remove(Handle);
+	}
+
+	Insert(Handle, NormalizedName);
+}
+
+void FLyraNPCNameIndex::Remove(const FLyraNPCHandle& Handle)
+{
+	const FString* NormalizedName = Names.Find(Handle);
+	if (!NormalizedName) return;
+
+	// Erase still resolves suffix text through Names, so the entry goes last
+	Erase(Handle, FString(*NormalizedName));
+	Names.Remove(Handle);
+}
+
+void FLyraNPCNameIndex::Reset()
+{
+	Names.Reset();
+	ExactIndex.Reset();
+	SortedNames.Reset();
+	SortedSuffixes.Reset();
+}
+
+FLyraNPCHandle FLyraNPCNameIndex::FindExact(const FString& Name) const
+{
+	if (const FLyraNPCHandle* Handle = ExactIndex.Find(Normalize(Name)))
+	{
+		return *Handle;
+	}
+	return FLyraNPCHandle();
+}
+
+FLyraNPCHandle FLyraNPCNameIndex::FindFirstContaining(const FString& Substring) const
+{
+	const FString Key = Normalize(Substring);
+	if (Key.IsEmpty()) return FLyraNPCHandle();
+
+	if (const FLyraNPCHandle* Handle = ExactIndex.Find(Key))
+	{
+		return *Handle;
+	}
+
+	const int32 Index = LowerBoundSuffix(*Key, nullptr);
+	if (SortedSuffixes.IsValidIndex(Index) && FCString::Strncmp(GetSuffix(SortedSuffixes[Index]), *Key, Key.Len()) == 0)
+	{
+		return SortedSuffixes[Index].Handle;
+	}
+	return FLyraNPCHandle();
+}
+
+void FLyraNPCNameIndex::FindByPrefix(const FString& Prefix, TArray<FLyraNPCHandle>& OutHandles, int32 MaxResults) const
+{
+	const FString Key = Normalize(Prefix);
+	if (Key.IsEmpty()) return;
+
+	for (int32 Index = LowerBoundName(*Key, nullptr); Index < SortedNames.Num(); ++Index)
+	{
+		const FNameEntry& Entry = SortedNames[Index];
+		if (FCString::Strncmp(*Entry.Name, *Key, Key.Len()) != 0) break;
+
+		OutHandles.Add(Entry.Handle);
+		if (MaxResults > 0 && OutHandles.Num() >= MaxResults) break;
+	}
+}
+
+void FLyraNPCNameIndex::FindBySubstring(const FString& Substring, TArray<FLyraNPCHandle>& OutHandles, int32 MaxResults) const
+{
+	const FString Key = Normalize(Substring);
+	if (Key.IsEmpty()) return;
+
+	// A name can contain the key more than once
+	TSet<FLyraNPCHandle, DefaultKeyFuncs<FLyraNPCHandle>, TInlineSetAllocator<32>> Seen;
+
+	for (int32 Index = LowerBoundSuffix(*Key, nullptr); Index < SortedSuffixes.Num(); ++Index)
+	{
+		const FSuffixEntry& Entry = SortedSuffixes[Index];
+		if (FCString::Strncmp(GetSuffix(Entry), *Key, Key.Len()) != 0) break;
+
+		bool bAlreadySeen = false;
+		Seen.Add(Entry.Handle, &bAlreadySeen);
+		if (bAlreadySeen) continue;
+
+		OutHandles.Add(Entry.Handle);
+		if (MaxResults > 0 && Seen.Num() >= MaxResults) break;
+	}
+}
+
+void FLyraNPCNameIndex::Insert(const FLyraNPCHandle& Handle, const FString& NormalizedName)
+{
+	ExactIndex.Add(NormalizedName, Handle);
+	SortedNames.Insert(FNameEntry{ NormalizedName, Handle }, LowerBoundName(*NormalizedName, &Handle));
+
+	// Suffix comparisons resolve text through Names
+	Names.Add(Handle, NormalizedName);
+	for (int32 Offset = 0; Offset < NormalizedName.Len(); ++Offset)
+	{
+		SortedSuffixes.Insert(FSuffixEntry{ Handle, Offset }, LowerBoundSuffix(*NormalizedName + Offset, &Handle));
+	}
+}
+
+void FLyraNPCNameIndex::Erase(const FLyraNPCHandle& Handle, const FString& NormalizedName)
+{
+	ExactIndex.RemoveSingle(NormalizedName, Handle);
+
+	const int32 NameIndex = LowerBoundName(*NormalizedName, &Handle);
+	if (SortedNames.IsValidIndex(NameIndex) && SortedNames[NameIndex].Handle == Handle)
+	{
+		SortedNames.RemoveAt(NameIndex);
+	}
+
+	for (int32 Offset = 0; Offset < NormalizedName.Len(); ++Offset)
+	{
+		const int32 SuffixIndex = LowerBoundSuffix(*NormalizedName + Offset, &Handle);
+		if (SortedSuffixes.IsValidIndex(SuffixIndex) && SortedSuffixes[SuffixIndex].Handle == Handle)
+		{
+			SortedSuffixes.RemoveAt(SuffixIndex);
+		}
+	}
+}
+
+const TCHAR* FLyraNPCNameIndex::GetSuffix(const FSuffixEntry& Entry) const
+{
+	return *Names.FindChecked(Entry.Handle) + Entry.Offset;
+}
+
+int32 FLyraNPCNameIndex::LowerBoundName(const TCHAR* Key, const FLyraNPCHandle* Handle) const
+{
+	int32 Low = 0;
+	int32 High = SortedNames.Num();
+	while (Low < High)
+	{
+		const int32 Mid = Low + (High - Low) / 2;
+		const FNameEntry& Entry = SortedNames[Mid];
+		if (LyraNPCNameIndex::EntryLess(*Entry.Name, Entry.Handle, Key, Handle))
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+	return Low;
+}
+
+int32 FLyraNPCNameIndex::LowerBoundSuffix(const TCHAR* Key, const FLyraNPCHandle* Handle) const
+{
+	int32 Low = 0;
+	int32 High = SortedSuffixes.Num();
+	while (Low < High)
+	{
+		const int32 Mid = Low + (High - Low) / 2;
+		const FSuffixEntry& Entry = SortedSuffixes[Mid];
+		if (LyraNPCNameIndex::EntryLess(GetSuffix(Entry), Entry.Handle, Key, Handle))
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+	return Low;
+}
@@ -0,0 +1,43 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#include "Systems/LyraNPCNeedsBatch.h"
+#include "Components/LyraNPCNeedsComponent.h"
+
+int32 FLyraNPCNeedsBatch::Add(ULyraNPCNeedsComponent* Owner)
+{
+	const int32 Slot = Owners.Add(Owner);
+	for (int32 Type = 0; Type < NumNeedTypes; ++Type)
+	{
+		Values[Type].Add(100.0f);
+	}
+	BaseTimes.Add(-1.0);
+	BaseGameHours.Add(0.0);
+	return Slot;
+}
+
+void FLyraNPCNeedsBatch::Remove(int32 Slot)
+{
+	Owners.RemoveAtSwap(Slot);
+	for (int32 Type = 0; Type < NumNeedTypes; ++Type)
+	{
+		Values[Type].RemoveAtSwap(Slot);
+	}
+	BaseTimes.RemoveAtSwap(Slot);
+	BaseGameHours.RemoveAtSwap(Slot);
+
+	if (Owners.IsValidIndex(Slot) && Owners[Slot])
+	{
+		Owners[Slot]->NeedsBatchSlot = Slot;
+	}
+}
+
+void FLyraNPCNeedsBatch::Reset()
+{
+	Owners.Reset();
+	for (int32 Type = 0; Type < NumNeedTypes; ++Type)
+	{
+		Values[Type].Reset();
+	}
+	BaseTimes.Reset();
+	BaseGameHours.Reset();
+}
@@ -0,0 +1,124 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#include "Components/LyraNPCNeedsComponent.h"
+#include "Systems/LyraNPCWorldSubsystem.h"
+#include "Systems/LyraNPCNeedsBatch.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/IConsoleManager.h"
+#include "LyraNPCModule.h"
+
+// ===== BENCHMARK =====
+
+namespace LyraNPCNeedsBenchmark
+{
+	// One subsystem tick per simulated second, as the old needs tick ran
+	static constexpr float BenchmarkDeltaTime = 1.0f;
+
+	// Same starting values for every run
+	static constexpr int32 BenchmarkSeed = 0x4E454544;
+
+	// Times needs for Count NPCs over Ticks one-second subsystem ticks three ways: caught up every tick as
+	// the old ticking component did, lazily with the subsystem's queue calling back at each crossing, and
+	// lazily with the stored lines in a needs batch. Real needs components on the project's default
+	// profile run in a private world, so the game's world and clock are left alone. Each run starts from
+	// the same values and includes the subsystem tick itself.
+	static void BenchmarkNeeds(const TArray<FString>& Args)
+	{
+		if (!GEngine) return;
+
+		const int32 Ticks = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 600;
+		const float TimeScale = Args.Num() > 1 ? FMath::Max(0.0f, FCString::Atof(*Args[1])) : 24.0f;
+
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("LyraNPCNeedsBenchmark"));
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+
+		ULyraNPCWorldSubsystem* Subsystem = World->GetSubsystem<ULyraNPCWorldSubsystem>();
+		if (Subsystem)
+		{
+			Subsystem->bAutoAdvanceTime = true;
+			Subsystem->bCentralizedLOD = false;
+			Subsystem->SetTimeScale(TimeScale);
+
+			for (const int32 Count : { 1000, 5000, 20000 })
+			{
+				TArray<AActor*> Actors;
+				TArray<ULyraNPCNeedsComponent*> Components;
+				for (int32 Index = 0; Index < Count; ++Index)
+				{
+					AActor* Actor = World->SpawnActor<AActor>();
+					ULyraNPCNeedsComponent* Needs = NewObject<ULyraNPCNeedsComponent>(Actor);
+					Needs->RegisterComponent();
+					Actors.Add(Actor);
+					Components.Add(Needs);
+				}
+
+				auto ResetNeeds = [&Components]()
+				{
+					FMath::RandInit(BenchmarkSeed);
+					for (ULyraNPCNeedsComponent* Needs : Components)
+					{
+						Needs->InitializeDefaultNeeds();
+					}
+				};
+
+				ResetNeeds();
+				double StartTime = FPlatformTime::Seconds();
+				for (int32 Tick = 0; Tick < Ticks; ++Tick)
+				{
+					Subsystem->Tick(BenchmarkDeltaTime);
+					for (ULyraNPCNeedsComponent* Needs : Components)
+					{
+						Needs->CatchUp();
+					}
+				}
+				const double TickingSeconds = FPlatformTime::Seconds() - StartTime;
+
+				ResetNeeds();
+				StartTime = FPlatformTime::Seconds();
+				for (int32 Tick = 0; Tick < Ticks; ++Tick)
+				{
+					Subsystem->Tick(BenchmarkDeltaTime);
+				}
+				const double LazySeconds = FPlatformTime::Seconds() - StartTime;
+
+				FLyraNPCNeedsBatch Batch;
+				for (ULyraNPCNeedsComponent* Needs : Components)
+				{
+					Needs->AttachToBatch(Batch);
+				}
+				ResetNeeds();
+				StartTime = FPlatformTime::Seconds();
+				for (int32 Tick = 0; Tick < Ticks; ++Tick)
+				{
+					Subsystem->Tick(BenchmarkDeltaTime);
+				}
+				const double BatchedSeconds = FPlatformTime::Seconds() - StartTime;
+
+				for (AActor* Actor : Actors)
+				{
+					Actor->Destroy();
+				}
+
+				const double Samples = static_cast<double>(Count) * Ticks;
+				UE_LOG(LogLyraNPC, Display, TEXT("LyraNPC.BenchmarkNeeds: %5d NPCs x %d ticks: per tick %.1f ns/NPC/tick, lazy %.1f ns/NPC/tick (%.1fx), lazy batched %.1f ns/NPC/tick (%.1fx)"),
+					Count, Ticks,
+					TickingSeconds * 1e9 / Samples,
+					LazySeconds * 1e9 / Samples, LazySeconds > 0.0 ? TickingSeconds / LazySeconds : 0.0,
+					BatchedSeconds * 1e9 / Samples, BatchedSeconds > 0.0 ? TickingSeconds / BatchedSeconds : 0.0);
+			}
+		}
+
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	static FAutoConsoleCommand BenchmarkNeedsCommand(
+		TEXT("LyraNPC.BenchmarkNeeds"),
+		TEXT("Times needs caught up every tick against lazy needs, with and without batched storage, at 1k, 5k and 20k NPCs. Usage: LyraNPC.BenchmarkNeeds [Ticks=600] [TimeScale=24]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkNeeds));
+}
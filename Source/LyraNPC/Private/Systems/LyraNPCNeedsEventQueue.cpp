@@ -0,0 +1,47 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#include "Systems/LyraNPCNeedsEventQueue.h"
+#include "Components/LyraNPCNeedsComponent.h"
+
+void FLyraNPCNeedsEventQueue::Push(ULyraNPCNeedsComponent* Needs, double Time, uint32 Serial)
+{
+	Heap.HeapPush({ Time, Needs, Serial }, FEarlierEvent());
+
+	if (Heap.Num() >= SweepThreshold)
+	{
+		RemoveStale();
+	}
+}
+
+ULyraNPCNeedsComponent* FLyraNPCNeedsEventQueue::PopDue(double Now)
+{
+	while (Heap.Num() > 0 && Heap.HeapTop().Time <= Now)
+	{
+		FEvent Event;
+		Heap.HeapPop(Event, FEarlierEvent());
+		if (IsCurrent(Event))
+		{
+			return Event.Needs.Get();
+		}
+	}
+	return nullptr;
+}
+
+void FLyraNPCNeedsEventQueue::Reset()
+{
+	Heap.Reset();
+	SweepThreshold = 256;
+}
+
+bool FLyraNPCNeedsEventQueue::IsCurrent(const FEvent& Event)
+{
+	const ULyraNPCNeedsComponent* Needs = Event.Needs.Get();
+	return Needs && Needs->GetScheduledEventSerial() == Event.Serial;
+}
+
+void FLyraNPCNeedsEventQueue::RemoveStale()
+{
+	Heap.RemoveAllSwap([](const FEvent& Event) { return !IsCurrent(Event); });
+	Heap.Heapify(FEarlierEvent());
+	SweepThreshold = FMath::Max(256, Heap.Num() * 2);
+}
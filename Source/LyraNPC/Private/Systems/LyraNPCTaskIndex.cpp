@@ -0,0 +1,184 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#include "Systems/LyraNPCTaskIndex.h"
+#include "LyraNPCModule.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Task Queries"), STAT_LyraNPC_TaskQueries, STATGROUP_LyraNPC);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Task Candidates Examined"), STAT_LyraNPC_TaskCandidates, STATGROUP_LyraNPC);
+
+void FLyraNPCTaskIndex::SetCellSize(float InCellSize)
+{
+	CellSize = FMath::Max(InCellSize, 1.0f);
+	for (TPair<FGameplayTag, FBucket>& Pair : Buckets)
+	{
+		Pair.Value.Grid.SetCellSize(CellSize);
+	}
+}
+
+void FLyraNPCTaskIndex::Reset()
+{
+	Buckets.Reset();
+	IndexedTypes.Reset();
+	MatchingBucketCache.Reset();
+}
+
+void FLyraNPCTaskIndex::Add(ULyraNPCTaskActor* Task)
+{
+	if (!Task) return;
+
+	if (IndexedTypes.Contains(Task))
+	{
+		Update(Task);
+		return;
+	}
+
+	FBucket* Bucket = Buckets.Find(Task->TaskType);
+	if (!Bucket)
+	{
+		Bucket = &Buckets.Add(Task->TaskType);
+		Bucket->Grid.SetCellSize(CellSize);
+		MatchingBucketCache.Reset();
+	}
+
+	Bucket->Grid.Add(Task, Task->GetTaskLocation());
+	Bucket->SetScoreBound(Task, ComputeScoreBound(Task));
+	IndexedTypes.Add(Task, Task->TaskType);
+}
+
+void FLyraNPCTaskIndex::Remove(const TWeakObjectPtr<ULyraNPCTaskActor>& Task)
+{
+	FGameplayTag IndexedType;
+	if (!IndexedTypes.RemoveAndCopyValue(Task, IndexedType)) return;
+
+	FBucket& Bucket = Buckets.FindChecked(IndexedType);
+	Bucket.Grid.Remove(Task);
+
+	if (Bucket.Grid.Num() == 0)
+	{
+		Buckets.Remove(IndexedType);
+		MatchingBucketCache.Reset();
+	}
+	else
+	{
+		Bucket.RemoveScoreBound(Task);
+	}
+}
+
+void FLyraNPCTaskIndex::Update(ULyraNPCTaskActor* Task)
+{
+	if (!Task) return;
+
+	const FGameplayTag* IndexedType = IndexedTypes.Find(Task);
+	if (!IndexedType) return;
+
+	if (*IndexedType != Task->TaskType)
+	{
+		Remove(Task);
+		Add(Task);
+		return;
+	}
+
+	FBucket& Bucket = Buckets.FindChecked(*IndexedType);
+	Bucket.Grid.Update(Task, Task->GetTaskLocation());
+	Bucket.SetScoreBound(Task, ComputeScoreBound(Task));
+}
+
+void FLyraNPCTaskIndex::UpdateLocation(ULyraNPCTaskActor* Task)
+{
+	if (!Task) return;
+
+	if (const FGameplayTag* IndexedType = IndexedTypes.Find(Task))
+	{
+		Buckets.FindChecked(*IndexedType).Grid.Update(Task, Task->GetTaskLocation());
+	}
+}
+
+float FLyraNPCTaskIndex::GetMaxScoreBound(const FGameplayTag& TaskType) const
+{
+	check(IsInGameThread());
+
+	float MaxBound = 0.0f;
+	for (const FGameplayTag& BucketType : GetMatchingBuckets(TaskType))
+	{
+		MaxBound = FMath::Max(MaxBound, Buckets.FindChecked(BucketType).MaxScoreBound);
+	}
+	return MaxBound;
+}
+
+float FLyraNPCTaskIndex::ComputeScoreBound(const ULyraNPCTaskActor* Task)
+{
+	// Mirrors GetScoreForNPC with every need fully depleted and no distance penalty
+	float Bound = Task->TaskPriority;
+	for (const TPair<ELyraNPCNeedType, float>& Pair : Task->NeedsSatisfaction)
+	{
+		Bound += FMath::Max(0.0f, Pair.Value) * ULyraNPCTaskActor::NeedScoreScale;
+	}
+	return Bound;
+}
+
+void FLyraNPCTaskIndex::FBucket::SetScoreBound(const TWeakObjectPtr<ULyraNPCTaskActor>& Task, float Bound)
+{
+	float& StoredBound = ScoreBounds.FindOrAdd(Task, 0.0f);
+	const bool bWasMax = StoredBound >= MaxScoreBound;
+	StoredBound = Bound;
+
+	if (Bound >= MaxScoreBound)
+	{
+		MaxScoreBound = Bound;
+	}
+	else if (bWasMax)
+	{
+		RecomputeMaxScoreBound();
+	}
+}
+
+void FLyraNPCTaskIndex::FBucket::RemoveScoreBound(const TWeakObjectPtr<ULyraNPCTaskActor>& Task)
+{
+	float RemovedBound = 0.0f;
+	if (ScoreBounds.RemoveAndCopyValue(Task, RemovedBound) && RemovedBound >= MaxScoreBound)
+	{
+		RecomputeMaxScoreBound();
+	}
+}
+
+void FLyraNPCTaskIndex::FBucket::RecomputeMaxScoreBound()
+{
+	// Linear in the bucket, but only runs when the task holding the max leaves or drops
+	MaxScoreBound = 0.0f;
+	for (const TPair<TWeakObjectPtr<ULyraNPCTaskActor>, float>& Pair : ScoreBounds)
+	{
+		MaxScoreBound = FMath::Max(MaxScoreBound, Pair.Value);
+	}
+}
+
+const TArray<FGameplayTag>& FLyraNPCTaskIndex::GetMatchingBuckets(const FGameplayTag& TaskType) const
+{
+	check(IsInGameThread());
+
+	if (const TArray<FGameplayTag>* Cached = MatchingBucketCache.Find(TaskType))
+	{
+		return *Cached;
+	}
+
+	TArray<FGameplayTag> Matching;
+	for (const TPair<FGameplayTag, FBucket>& Pair : Buckets)
+	{
+		if (!TaskType.IsValid() || Pair.Key.MatchesTag(TaskType))
+		{
+			Matching.Add(Pair.Key);
+		}
+	}
+
+	return MatchingBucketCache.Add(TaskType, MoveTemp(Matching));
+}
+
+void FLyraNPCTaskIndex::RecordQuery(int32 Candidates) const
+{
+	Stats.NumQueries++;
+	Stats.TotalCandidatesExamined += Candidates;
+	Stats.LastQueryCandidates = Candidates;
+	Stats.MaxQueryCandidates = FMath::Max(Stats.MaxQueryCandidates, Candidates);
+
+	INC_DWORD_STAT(STAT_LyraNPC_TaskQueries);
+	INC_DWORD_STAT_BY(STAT_LyraNPC_TaskCandidates, Candidates);
+}
@@ -0,0 +1,359 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#include "Systems/LyraNPCTaskSearch.h"
+#include "Systems/LyraNPCTaskIndex.h"
+#include "Core/LyraNPCCharacter.h"
+#include "Tasks/LyraNPCTaskActor.h"
+#include "Components/LyraNPCIdentityComponent.h"
+#include "Components/LyraNPCNeedsComponent.h"
+#include "Async/ParallelFor.h"
+
+namespace LyraNPCTaskSearch
+{
+	// Floor for the NPC grouping grid, so a tiny search radius does not split a batch into one group per NPC
+	static constexpr double MinGroupCellSize = 500.0;
+}
+
+static_assert(static_cast<int32>(ELyraNPCArchetype::MAX) <= 32, "FLyraNPCTaskSearch::FCandidate::ArchetypeMask holds one bit per archetype");
+
+void FLyraNPCTaskSearch::Gather(const ALyraNPCCharacter* NPC, FSearcher& OutSearcher)
+{
+	for (float& Value : OutSearcher.NeedValues)
+	{
+		Value = 100.0f;
+	}
+
+	OutSearcher.bValid = NPC != nullptr;
+	if (!NPC) return;
+
+	OutSearcher.Location = NPC->GetActorLocation();
+
+	if (const ULyraNPCIdentityComponent* Identity = NPC->IdentityComponent.Get())
+	{
+		OutSearcher.bHasIdentity = true;
+		OutSearcher.UniqueId = Identity->GetUniqueId();
+		OutSearcher.Archetype = Identity->GetArchetype();
+		OutSearcher.CharacterTags = &Identity->Biography.CharacterTags;
+	}
+
+	if (const ULyraNPCNeedsComponent* Needs = NPC->NeedsComponent.Get())
+	{
+		OutSearcher.bHasNeeds = true;
+
+		for (int32 Type = 0; Type < static_cast<int32>(ELyraNPCNeedType::MAX); ++Type)
+		{
+			OutSearcher.NeedValues[Type] = Needs->GetNeedValue(static_cast<ELyraNPCNeedType>(Type));
+		}
+	}
+}
+
+void FLyraNPCTaskSearch::Gather(const ULyraNPCTaskActor* Task, FCandidate& OutCandidate)
+{
+	OutCandidate.Task = const_cast<ULyraNPCTaskActor*>(Task);
+	OutCandidate.Location = Task->GetTaskLocation();
+	OutCandidate.Priority = Task->TaskPriority;
+	OutCandidate.bIsPrivate = Task->bIsPrivate;
+	OutCandidate.OwnerNPCId = Task->OwnerNPCId;
+	OutCandidate.RequiredTags = &Task->RequiredTags;
+	OutCandidate.BlockingTags = &Task->BlockingTags;
+	OutCandidate.FreeSlots = Task->GetAvailableSlots();
+
+	// An empty list means no archetype restriction
+	OutCandidate.ArchetypeMask = Task->AllowedArchetypes.Num() == 0 ? MAX_uint32 : 0;
+	for (ELyraNPCArchetype Archetype : Task->AllowedArchetypes)
+	{
+		if (Archetype < ELyraNPCArchetype::MAX)
+		{
+			OutCandidate.ArchetypeMask |= 1u << static_cast<uint32>(Archetype);
+		}
+	}
+
+	for (float& Value : OutCandidate.NeedsSatisfaction)
+	{
+		Value = 0.0f;
+	}
+	for (const TPair<ELyraNPCNeedType, float>& Pair : Task->NeedsSatisfaction)
+	{
+		if (Pair.Key < ELyraNPCNeedType::MAX)
+		{
+			OutCandidate.NeedsSatisfaction[static_cast<int32>(Pair.Key)] += Pair.Value;
+		}
+	}
+}
+
+bool FLyraNPCTaskSearch::CanUse(const FCandidate& Candidate, const FSearcher& Searcher)
+{
+	if (Candidate.bIsPrivate && (!Searcher.bHasIdentity || Searcher.UniqueId != Candidate.OwnerNPCId))
+	{
+		return false;
+	}
+
+	// NPCs without an identity skip the archetype and tag checks, as in CanNPCUseTask
+	if (!Searcher.bHasIdentity) return true;
+
+	if ((Candidate.ArchetypeMask & (1u << static_cast<uint32>(Searcher.Archetype))) == 0)
+	{
+		return false;
+	}
+
+	if (Candidate.RequiredTags->Num() > 0 && !Searcher.CharacterTags->HasAll(*Candidate.RequiredTags))
+	{
+		return false;
+	}
+
+	return Candidate.BlockingTags->Num() == 0 || !Searcher.CharacterTags->HasAny(*Candidate.BlockingTags);
+}
+
+float FLyraNPCTaskSearch::Score(const FCandidate& Candidate, const FSearcher& Searcher)
+{
+	float Score = Candidate.Priority;
+
+	if (Searcher.bHasNeeds)
+	{
+		for (int32 NeedIndex = 0; NeedIndex < static_cast<int32>(ELyraNPCNeedType::MAX); ++NeedIndex)
+		{
+			const float NeedDeficit = 100.0f - Searcher.NeedValues[NeedIndex];
+			Score += (NeedDeficit / 100.0f) * Candidate.NeedsSatisfaction[NeedIndex] * ULyraNPCTaskActor::NeedScoreScale;
+		}
+	}
+
+	const float Distance = FVector::Dist(Searcher.Location, Candidate.Location);
+	return Score - Distance / ULyraNPCTaskActor::DistancePenaltyScale;
+}
+
+void FLyraNPCTaskSearch::FindBestTasks(const FLyraNPCTaskIndex& TaskIndex, TArrayView<ALyraNPCCharacter* const> NPCs, const FGameplayTag& TaskType,
+	float MaxDistance, TArrayView<ULyraNPCTaskActor*> OutBestTasks, int32 MinParallelBatch)
+{
+	check(NPCs.Num() == OutBestTasks.Num());
+	for (ULyraNPCTaskActor*& Task : OutBestTasks)
+	{
+		Task = nullptr;
+	}
+
+	FSearcherArray Searchers;
+	FCandidateArray Candidates;
+	FGroupArray Groups;
+	const double SearchRadiusSq = GatherBatch(TaskIndex, NPCs, TaskType, MaxDistance, Searchers, Candidates, Groups);
+	if (Candidates.Num() == 0) return;
+
+	ParallelFor(NPCs.Num(), [&](int32 Index)
+	{
+		const FSearcher& Searcher = Searchers[Index];
+		if (!Searcher.bValid) return;
+
+		ULyraNPCTaskActor* BestTask = nullptr;
+		float BestScore = 0.0f;
+
+		for (int32 CandidateIndex : Groups[Searcher.Group])
+		{
+			const FCandidate& Candidate = Candidates[CandidateIndex];
+			if (FVector::DistSquared(Searcher.Location, Candidate.Location) > SearchRadiusSq) continue;
+			if (!CanUse(Candidate, Searcher)) continue;
+
+			const float CandidateScore = Score(Candidate, Searcher);
+			if (CandidateScore > BestScore)
+			{
+				BestScore = CandidateScore;
+				BestTask = Candidate.Task;
+			}
+		}
+
+		OutBestTasks[Index] = BestTask;
+	}, NPCs.Num() < MinParallelBatch ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+int32 FLyraNPCTaskSearch::AssignTasks(const FLyraNPCTaskIndex& TaskIndex, TArrayView<ALyraNPCCharacter* const> NPCs, const FGameplayTag& TaskType,
+	float MaxDistance, TArrayView<ULyraNPCTaskActor*> OutTasks, int32 MinParallelBatch)
+{
+	check(NPCs.Num() == OutTasks.Num());
+	for (ULyraNPCTaskActor*& Task : OutTasks)
+	{
+		Task = nullptr;
+	}
+
+	FSearcherArray Searchers;
+	FCandidateArray Candidates;
+	FGroupArray Groups;
+	const double SearchRadiusSq = GatherBatch(TaskIndex, NPCs, TaskType, MaxDistance, Searchers, Candidates, Groups);
+	if (Candidates.Num() == 0) return 0;
+
+	struct FScoredCandidate
+	{
+		float Score;
+		int32 Candidate;
+	};
+
+	// Each NPC's usable tasks with a free slot, best first. Every other NPC in the batch can fill at most
+	// one slot, so an NPC never falls back further than its NPCs.Num() best tasks.
+	TArray<TArray<FScoredCandidate>> Choices;
+	Choices.SetNum(NPCs.Num());
+
+	// What each NPC would have picked on its own, full or not
+	TArray<int32> IndependentPicks;
+	IndependentPicks.Init(INDEX_NONE, NPCs.Num());
+
+	ParallelFor(NPCs.Num(), [&](int32 Index)
+	{
+		const FSearcher& Searcher = Searchers[Index];
+		if (!Searcher.bValid) return;
+
+		TArray<FScoredCandidate>& NPCChoices = Choices[Index];
+		float BestScore = 0.0f;
+		for (int32 CandidateIndex : Groups[Searcher.Group])
+		{
+			const FCandidate& Candidate = Candidates[CandidateIndex];
+			if (FVector::DistSquared(Searcher.Location, Candidate.Location) > SearchRadiusSq) continue;
+			if (!CanUse(Candidate, Searcher)) continue;
+
+			const float CandidateScore = Score(Candidate, Searcher);
+			if (CandidateScore <= 0.0f) continue;
+
+			if (Candidate.FreeSlots > 0)
+			{
+				NPCChoices.Add(FScoredCandidate{ CandidateScore, CandidateIndex });
+			}
+			if (CandidateScore > BestScore)
+			{
+				BestScore = CandidateScore;
+				IndependentPicks[Index] = CandidateIndex;
+			}
+		}
+
+		// Ties go to the earlier candidate
+		NPCChoices.Sort([](const FScoredCandidate& A, const FScoredCandidate& B)
+		{
+			return A.Score != B.Score ? A.Score > B.Score : A.Candidate < B.Candidate;
+		});
+		if (NPCChoices.Num() > NPCs.Num())
+		{
+			NPCChoices.SetNum(NPCs.Num());
+		}
+	}, NPCs.Num() < MinParallelBatch ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	TArray<int32, TInlineAllocator<32>> FreeSlots;
+	for (const FCandidate& Candidate : Candidates)
+	{
+		FreeSlots.Add(Candidate.FreeSlots);
+	}
+
+	// Merge the per-NPC lists through a heap of each NPC's best remaining choice, which takes pairs in
+	// the same order as sorting them all: highest score first, ties to the earlier request
+	struct FHead
+	{
+		float Score;
+		int32 NPC;
+		int32 Choice;
+	};
+	auto HeadFirst = [](const FHead& A, const FHead& B)
+	{
+		return A.Score != B.Score ? A.Score > B.Score : A.NPC < B.NPC;
+	};
+
+	TArray<FHead> Heads;
+	for (int32 Index = 0; Index < NPCs.Num(); ++Index)
+	{
+		if (Choices[Index].Num() > 0)
+		{
+			Heads.Add(FHead{ Choices[Index][0].Score, Index, 0 });
+		}
+	}
+	Heads.Heapify(HeadFirst);
+
+	while (Heads.Num() > 0)
+	{
+		FHead Head;
+		Heads.HeapPop(Head, HeadFirst);
+
+		const int32 CandidateIndex = Choices[Head.NPC][Head.Choice].Candidate;
+		if (FreeSlots[CandidateIndex] > 0)
+		{
+			OutTasks[Head.NPC] = Candidates[CandidateIndex].Task;
+			--FreeSlots[CandidateIndex];
+		}
+		else if (Choices[Head.NPC].IsValidIndex(++Head.Choice))
+		{
+			Head.Score = Choices[Head.NPC][Head.Choice].Score;
+			Heads.HeapPush(Head, HeadFirst);
+		}
+	}
+
+	// Independent picks beyond a task's capacity are the reservations that would have failed
+	TArray<int32, TInlineAllocator<32>> Demand;
+	Demand.SetNumZeroed(Candidates.Num());
+	for (int32 Pick : IndependentPicks)
+	{
+		if (Pick != INDEX_NONE)
+		{
+			++Demand[Pick];
+		}
+	}
+
+	int32 RequeriesAvoided = 0;
+	for (int32 CandidateIndex = 0; CandidateIndex < Candidates.Num(); ++CandidateIndex)
+	{
+		RequeriesAvoided += FMath::Max(0, Demand[CandidateIndex] - Candidates[CandidateIndex].FreeSlots);
+	}
+	return RequeriesAvoided;
+}
+
+double FLyraNPCTaskSearch::GatherBatch(const FLyraNPCTaskIndex& TaskIndex, TArrayView<ALyraNPCCharacter* const> NPCs, const FGameplayTag& TaskType,
+	float MaxDistance, FSearcherArray& OutSearchers, FCandidateArray& OutCandidates, FGroupArray& OutGroups)
+{
+	// Tasks further away than this score zero from the distance penalty alone and can never win
+	float SearchRadius = TaskIndex.GetMaxScoreBound(TaskType) * ULyraNPCTaskActor::DistancePenaltyScale;
+	if (MaxDistance > 0.0f)
+	{
+		SearchRadius = FMath::Min(SearchRadius, MaxDistance);
+	}
+
+	OutSearchers.SetNum(NPCs.Num());
+
+	// NPCs are grouped by cell of a SearchRadius-sized grid, so a spread-out batch queries the index
+	// around each cluster of NPCs rather than over its whole bounding box
+	const double InvGroupCellSize = 1.0 / FMath::Max(static_cast<double>(SearchRadius), LyraNPCTaskSearch::MinGroupCellSize);
+	TMap<FIntPoint, int32, TInlineSetAllocator<16>> GroupByCell;
+	TArray<FBox, TInlineAllocator<16>> GroupBounds;
+
+	for (int32 Index = 0; Index < NPCs.Num(); ++Index)
+	{
+		FSearcher& Searcher = OutSearchers[Index];
+		Gather(NPCs[Index], Searcher);
+		if (!Searcher.bValid) continue;
+
+		const FIntPoint Cell(
+			FMath::FloorToInt32(FMath::Clamp(Searcher.Location.X * InvGroupCellSize, -1.0e9, 1.0e9)),
+			FMath::FloorToInt32(FMath::Clamp(Searcher.Location.Y * InvGroupCellSize, -1.0e9, 1.0e9)));
+
+		int32& Group = GroupByCell.FindOrAdd(Cell, INDEX_NONE);
+		if (Group == INDEX_NONE)
+		{
+			Group = GroupBounds.Add(FBox(ForceInit));
+		}
+		GroupBounds[Group] += Searcher.Location;
+		Searcher.Group = Group;
+	}
+
+	// A task near several groups is snapshotted once so every group shares its free slots
+	TMap<ULyraNPCTaskActor*, int32, TInlineSetAllocator<32>> CandidateByTask;
+	OutGroups.SetNum(GroupBounds.Num());
+
+	for (int32 Group = 0; Group < GroupBounds.Num(); ++Group)
+	{
+		const FBox& Bounds = GroupBounds[Group];
+		const float GatherRadius = static_cast<float>(Bounds.GetExtent().Size()) + SearchRadius;
+		TaskIndex.ForEachTask(TaskType, Bounds.GetCenter(), GatherRadius, [&](ULyraNPCTaskActor* Task)
+		{
+			if (!Task->bIsAvailable || !Task->bIsEnabled) return;
+
+			int32& CandidateIndex = CandidateByTask.FindOrAdd(Task, INDEX_NONE);
+			if (CandidateIndex == INDEX_NONE)
+			{
+				CandidateIndex = OutCandidates.Num();
+				Gather(Task, OutCandidates.AddDefaulted_GetRef());
+			}
+			OutGroups[Group].Add(CandidateIndex);
+		});
+	}
+
+	return FMath::Square(static_cast<double>(SearchRadius));
+}
@@ -0,0 +1,53 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#include "Systems/LyraNPCVirtualPopulation.h"
+
+void FLyraNPCVirtualPopulation::Add(FLyraNPCVirtualRecord&& Record)
+{
+	check(Record.Biography.UniqueId.IsValid());
+
+	const FVector Location = Record.Transform.GetLocation();
+	if (const int32* ExistingSlot = IdToSlot.Find(Record.Biography.UniqueId))
+	{
+		Records[*ExistingSlot] = MoveTemp(Record);
+		Locations.Update(*ExistingSlot, Location);
+		return;
+	}
+
+	const FGuid UniqueId = Record.Biography.UniqueId;
+	const int32 Slot = Records.Add(MoveTemp(Record));
+	IdToSlot.Add(UniqueId, Slot);
+	Locations.Add(Slot, Location);
+}
+
+bool FLyraNPCVirtualPopulation::Remove(const FGuid& UniqueId, FLyraNPCVirtualRecord& OutRecord)
+{
+	int32 Slot = INDEX_NONE;
+	if (!IdToSlot.RemoveAndCopyValue(UniqueId, Slot)) return false;
+
+	OutRecord = MoveTemp(Records[Slot]);
+	Records.RemoveAt(Slot);
+	Locations.Remove(Slot);
+	return true;
+}
+
+const FLyraNPCVirtualRecord* FLyraNPCVirtualPopulation::Find(const FGuid& UniqueId) const
+{
+	const int32* Slot = IdToSlot.Find(UniqueId);
+	return Slot ? &Records[*Slot] : nullptr;
+}
+
+void FLyraNPCVirtualPopulation::Reset()
+{
+	Records.Empty();
+	IdToSlot.Empty();
+	Locations.Reset();
+}
+
+void FLyraNPCVirtualPopulation::FindInRadius(const FVector& Center, float Radius, TArray<FGuid>& OutIds) const
+{
+	Locations.ForEachInRadius(Center, Radius, [this, &OutIds](int32 Slot, const FVector&)
+	{
+		OutIds.Add(Records[Slot].Biography.UniqueId);
+	});
+}
@@ -8,7 +8,33 @@
 #include "Components/LyraNPCScheduleComponent.h"
 #include "Components/LyraNPCCognitiveComponent.h"
 #include "AI/Controllers/LyraNPCAIController.h"
+#include "Core/LyraNPCSettings.h"
+#include "GameFramework/CharacterMovementComponent.h"
 #include "LyraNPCModule.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI LOD Changes"), STAT_LyraNPC_AILODChanges, STATGROUP_LyraNPC);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI LOD Change Broadcasts"), STAT_LyraNPC_AILODBroadcasts, STATGROUP_LyraNPC);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Governor Frame Cost (ms)"), STAT_LyraNPC_GovernorFrameCost, STATGROUP_LyraNPC);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Governor Smoothed Cost (ms)"), STAT_LyraNPC_GovernorSmoothedCost, STATGROUP_LyraNPC);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Governor Level"), STAT_LyraNPC_GovernorLevel, STATGROUP_LyraNPC);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Governor LOD Distance Scale"), STAT_LyraNPC_GovernorLODDistanceScale, STATGROUP_LyraNPC);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Governor Tick Interval Scale"), STAT_LyraNPC_GovernorTickIntervalScale, STATGROUP_LyraNPC);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Governor Deferring Work"), STAT_LyraNPC_GovernorDeferring, STATGROUP_LyraNPC);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Needs Events Fired"), STAT_LyraNPC_NeedsEventsFired, STATGROUP_LyraNPC);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Needs Events Queued"), STAT_LyraNPC_NeedsEventsQueued, STATGROUP_LyraNPC);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Batched Needs"), STAT_LyraNPC_BatchedNeeds, STATGROUP_LyraNPC);
+
+static FAutoConsoleCommandWithWorld GLyraNPCVerifyStatsCommand(
+	TEXT("LyraNPC.VerifyStats"),
+	TEXT("Cross-checks the LyraNPC population statistics against a full recount and resyncs them."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (ULyraNPCWorldSubsystem* Subsystem = World ? World->GetSubsystem<ULyraNPCWorldSubsystem>() : nullptr)
+		{
+			Subsystem->VerifyPopulationStats();
+		}
+	}));
 
 ULyraNPCWorldSubsystem::ULyraNPCWorldSubsystem()
 {
@@ -17,247 +43,1127 @@ ULyraNPCWorldSubsystem::ULyraNPCWorldSubsystem()
 void ULyraNPCWorldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
+	NPCSpatialHash.SetCellSize(SpatialCellSize);
+	TaskIndex.SetCellSize(SpatialCellSize);
+
+	// Half the default MinimalLODDistance, so each viewer is stamped into a few cells at most
+	LODManager.SetCellSize(5000.0f);
 	UE_LOG(LogLyraNPC, Log, TEXT("LyraNPC World Subsystem Initialized"));
 }
 
 void ULyraNPCWorldSubsystem::Deinitialize()
 {
-	RegisteredNPCs.Empty();
-	RegisteredTasks.Empty();
+	for (FLyraNPCRegistryEntry& Entry : NPCRegistry)
+	{
+		if (ALyraNPCCharacter* NPC = Entry.NPC.Get())
+		{
+			UntrackNPCStats(Entry, NPC);
+			NPC->RegistryHandle.Reset();
+			if (USceneComponent* Root = NPC->GetRootComponent())
+			{
+				Root->TransformUpdated.RemoveAll(this);
+			}
+		}
+	}
+
+	for (const FLyraNPCTaskRegistryEntry& Entry : TaskRegistry)
+	{
+		if (ULyraNPCTaskActor* Task = Entry.Task.Get())
+		{
+			Task->RegistryHandle.Reset();
+			Task->TransformUpdated.RemoveAll(this);
+		}
+	}
+
+	SetNeedsBatchActive(false);
+
+	NPCRegistry.Reset();
+	TaskRegistry.Reset();
+	RegisteredNPCs.Reset();
+	RegisteredTasks.Reset();
+	NPCSpatialHash.Reset();
+	TaskIndex.Reset();
+	NPCIdIndex.Reset();
+	NPCNameIndex.Reset();
+	PendingTaskSearches.Reset();
+	TaskReservations.Reset();
+	ActiveTaskSearches.Reset();
+	LODManager.Reset();
+	NeedsEvents.Reset();
+	GameClockNeedsEvents.Reset();
+	ScaleSensitiveNeeds.Reset();
+	NeedsTimeScale = -1.0f;
+	FrameGovernor.Reset();
+	GovernorRefreshCursor = INDEX_NONE;
+	VirtualPopulation.Reset();
+	NPCActorPool.Reset();
+	VirtualizationTimer = 0.0f;
+	FMemory::Memzero(NPCCountByLOD);
+	FMemory::Memzero(NPCCountByAlertLevel);
+	WellbeingSum = 0.0;
+	WellbeingRateSum = 0.0;
+	WellbeingHourRateSum = 0.0;
+	for (TArray<ALyraNPCCharacter*>& Members : NPCsByLifeState)
+	{
+		Members.Reset();
+	}
+	for (TArray<ALyraNPCCharacter*>& Members : NPCsByArchetype)
+	{
+		Members.Reset();
+	}
 	Super::Deinitialize();
 	UE_LOG(LogLyraNPC, Log, TEXT("LyraNPC World Subsystem Deinitialized"));
 }
 
 void ULyraNPCWorldSubsystem::Tick(float DeltaTime)
 {
+	// Reads last frame's cost before this tick starts adding to the next
+	UpdateFrameGovernor(DeltaTime);
+
+	LYRANPC_SCOPE_FRAME_COST(this);
 	Super::Tick(DeltaTime);
 
+	// A scale written directly since the last frame takes effect from here
+	SyncNeedsTimeScale();
+
+	if (bBatchNeedsSimulation != bNeedsBatchActive)
+	{
+		SetNeedsBatchActive(bBatchNeedsSimulation);
+	}
+
 	if (bAutoAdvanceTime)
 	{
 		UpdateGlobalTime(DeltaTime);
 	}
 
-	TimeSinceLastCleanup += DeltaTime;
-	if (TimeSinceLastCleanup >= CleanupInterval)
+	// Viewers are shared by the LOD pass, virtualization and controllers doing their own LOD check
+	LODManager.bUsePlayerViewPoints = bUsePlayerViewPoints;
+	LODManager.PlayerViewPointWeight = PlayerViewPointWeight;
+	LODManager.GatherViewers(GetWorld());
+
+	if (bCentralizedLOD)
+	{
+		LODManager.UpdatePeriod = LODUpdatePeriod;
+		LODManager.MaxTransitionsPerFrame = MaxLODTransitionsPerFrame;
+		LODManager.LODDistanceScale = FrameGovernor.GetLODDistanceScale();
+		LODManager.Tick(RegisteredNPCs, MakeArrayView(NPCCountByLOD), DeltaTime);
+	}
+
+	ProcessVirtualization(DeltaTime);
+
+	ProcessNeedsEvents();
+
+	ProcessTaskSearches();
+
+	ExpireTaskReservations();
+
+	// Roll the LOD change rates over once a second
+	LODRateWindowTime += DeltaTime;
+	if (LODRateWindowTime >= 1.0f)
+	{
+		LODChangesPerSecond = LODChangesInWindow / LODRateWindowTime;
+		LODBroadcastsPerSecond = LODBroadcastsInWindow / LODRateWindowTime;
+		LODChangesInWindow = 0;
+		LODBroadcastsInWindow = 0;
+		LODRateWindowTime = 0.0f;
+	}
+}
+
+void ULyraNPCWorldSubsystem::UpdateFrameGovernor(float DeltaTime)
+{
+	FrameGovernor.BudgetMs = bUseFrameGovernor ? FrameBudgetMs : 0.0f;
+	FrameGovernor.MaxLevel = MaxGovernorLevel;
+
+	if (FrameGovernor.Tick(DeltaTime))
+	{
+		UE_LOG(LogLyraNPC, Log, TEXT("Frame governor level %d (%.2f ms smoothed, budget %.2f ms)"),
+			FrameGovernor.GetLevel(), FrameGovernor.GetSmoothedCostMs(), FrameBudgetMs);
+		GovernorRefreshCursor = 0;
+	}
+
+	// Re-apply tick rates a slice at a time so a level change does not touch every NPC in one frame
+	if (GovernorRefreshCursor != INDEX_NONE)
+	{
+		const int32 End = FMath::Min(GovernorRefreshCursor + FMath::Max(GovernorRefreshesPerFrame, 1), RegisteredNPCs.Num());
+		for (; GovernorRefreshCursor < End; ++GovernorRefreshCursor)
+		{
+			if (ALyraNPCAIController* Controller = Cast<ALyraNPCAIController>(RegisteredNPCs[GovernorRefreshCursor]->GetController()))
+			{
+				Controller->ApplyLODTickRates();
+			}
+		}
+		if (GovernorRefreshCursor >= RegisteredNPCs.Num())
+		{
+			GovernorRefreshCursor = INDEX_NONE;
+		}
+	}
+
+	SET_FLOAT_STAT(STAT_LyraNPC_GovernorFrameCost, FrameGovernor.GetLastFrameCostMs());
+	SET_FLOAT_STAT(STAT_LyraNPC_GovernorSmoothedCost, FrameGovernor.GetSmoothedCostMs());
+	SET_DWORD_STAT(STAT_LyraNPC_GovernorLevel, FrameGovernor.GetLevel());
+	SET_FLOAT_STAT(STAT_LyraNPC_GovernorLODDistanceScale, FrameGovernor.GetLODDistanceScale());
+	SET_FLOAT_STAT(STAT_LyraNPC_GovernorTickIntervalScale, FrameGovernor.GetTickIntervalScale());
+	SET_DWORD_STAT(STAT_LyraNPC_GovernorDeferring, FrameGovernor.ShouldDeferNonCriticalWork() ? 1 : 0);
+}
+
+void ULyraNPCWorldSubsystem::ScheduleNeedsEvent(ULyraNPCNeedsComponent* Needs, double Time, uint32 Serial, bool bGameClock)
+{
+	(bGameClock ? GameClockNeedsEvents : NeedsEvents).Push(Needs, Time, Serial);
+}
+
+void ULyraNPCWorldSubsystem::SetNeedsScaleSensitive(ULyraNPCNeedsComponent* Needs, bool bSensitive)
+{
+	if (bSensitive)
+	{
+		ScaleSensitiveNeeds.Add(Needs);
+	}
+	else
+	{
+		ScaleSensitiveNeeds.Remove(Needs);
+	}
+}
+
+void ULyraNPCWorldSubsystem::SyncNeedsTimeScale()
+{
+	if (GlobalTimeScale == NeedsTimeScale) return;
+
+	if (NeedsTimeScale >= 0.0f)
+	{
+		RebaseScaleSensitiveNeeds();
+	}
+	NeedsTimeScale = GlobalTimeScale;
+}
+
+void ULyraNPCWorldSubsystem::RebaseScaleSensitiveNeeds()
+{
+	// Needs that only decay follow the game clock whatever its scale. The rest relate world time to game
+	// time through the old scale, so they start a new line; these are only NPCs with a modifier active.
+	TArray<TWeakObjectPtr<ULyraNPCNeedsComponent>> Sensitive = ScaleSensitiveNeeds.Array();
+	for (const TWeakObjectPtr<ULyraNPCNeedsComponent>& Needs : Sensitive)
+	{
+		if (ULyraNPCNeedsComponent* NeedsPtr = Needs.Get())
+		{
+			NeedsPtr->CatchUp();
+		}
+		else
+		{
+			ScaleSensitiveNeeds.Remove(Needs);
+		}
+	}
+}
+
+void ULyraNPCWorldSubsystem::SetNeedsBatchActive(bool bActive)
+{
+	bNeedsBatchActive = bActive;
+	if (bActive)
+	{
+		for (ALyraNPCCharacter* NPC : RegisteredNPCs)
+		{
+			if (ULyraNPCNeedsComponent* Needs = NPC->NeedsComponent)
+			{
+				Needs->AttachToBatch(NeedsBatch);
+			}
+		}
+		return;
+	}
+
+	// Attached components detach themselves on EndPlay, so every owner left is still alive
+	while (NeedsBatch.Num() > 0)
+	{
+		NeedsBatch.GetOwner(NeedsBatch.Num() - 1)->DetachFromBatch();
+	}
+	NeedsBatch.Reset();
+}
+
+void ULyraNPCWorldSubsystem::ProcessNeedsEvents()
+{
+	// Every crossing is scheduled strictly after the event that scheduled it, so this terminates
+	const double Now = GetWorld()->GetTimeSeconds();
+	int32 NumFired = 0;
+	while (ULyraNPCNeedsComponent* Needs = NeedsEvents.PopDue(Now))
+	{
+		Needs->HandleScheduledEvent();
+		++NumFired;
+	}
+	while (ULyraNPCNeedsComponent* Needs = GameClockNeedsEvents.PopDue(ElapsedGameHours))
+	{
+		Needs->HandleScheduledEvent();
+		++NumFired;
+	}
+
+	INC_DWORD_STAT_BY(STAT_LyraNPC_NeedsEventsFired, NumFired);
+	SET_DWORD_STAT(STAT_LyraNPC_NeedsEventsQueued, GetQueuedNeedsEventCount());
+	SET_DWORD_STAT(STAT_LyraNPC_BatchedNeeds, NeedsBatch.Num());
+}
+
+void ULyraNPCWorldSubsystem::NotifyAILODChanged(bool bBroadcast)
+{
+	++LODChangesInWindow;
+	INC_DWORD_STAT(STAT_LyraNPC_AILODChanges);
+
+	if (bBroadcast)
+	{
+		++LODBroadcastsInWindow;
+		INC_DWORD_STAT(STAT_LyraNPC_AILODBroadcasts);
+	}
+}
+
+TStatId ULyraNPCWorldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(ULyraNPCWorldSubsystem, STATGROUP_Tickables);
+}
+
+int32 ULyraNPCWorldSubsystem::AddLODViewPoint(FVector Location, float Weight)
+{
+	return LODManager.AddViewPoint(Location, Weight);
+}
+
+int32 ULyraNPCWorldSubsystem::AddLODViewPointActor(AActor* Actor, float Weight)
+{
+	return LODManager.AddViewPoint(Actor, Weight);
+}
+
+void ULyraNPCWorldSubsystem::UpdateLODViewPoint(int32 ViewPointId, FVector Location, float Weight)
+{
+	LODManager.UpdateViewPoint(ViewPointId, Location, Weight);
+}
+
+void ULyraNPCWorldSubsystem::RemoveLODViewPoint(int32 ViewPointId)
+{
+	LODManager.RemoveViewPoint(ViewPointId);
+}
+
+bool ULyraNPCWorldSubsystem::VirtualizeNPC(ALyraNPCCharacter* NPC)
+{
+	if (!IsNPCRegistered(NPC)) return false;
+
+	FLyraNPCVirtualRecord Record;
+	NPC->WriteVirtualRecord(Record);
+	if (!Record.Biography.UniqueId.IsValid())
+	{
+		Record.Biography.UniqueId = FGuid::NewGuid();
+	}
+	Record.VirtualizedAtGameHours = ElapsedGameHours;
+	Record.VirtualizedAtTime = GetWorld()->GetTimeSeconds();
+
+	ReleaseNPCActor(NPC);
+	VirtualPopulation.Add(MoveTemp(Record));
+	return true;
+}
+
+ALyraNPCCharacter* ULyraNPCWorldSubsystem::RehydrateNPC(const FGuid& NPCId)
+{
+	FLyraNPCVirtualRecord Record;
+	if (!VirtualPopulation.Remove(NPCId, Record)) return nullptr;
+
+	ALyraNPCCharacter* NPC = AcquireNPCActor(Record);
+	if (!NPC)
+	{
+		UE_LOG(LogLyraNPC, Warning, TEXT("Failed to rehydrate NPC %s"), *Record.Biography.GetFullName());
+		VirtualPopulation.Add(MoveTemp(Record));
+	}
+	return NPC;
+}
+
+FGuid ULyraNPCWorldSubsystem::AddVirtualNPC(const FLyraNPCVirtualRecord& Record)
+{
+	FLyraNPCVirtualRecord NewRecord = Record;
+	if (!NewRecord.Biography.UniqueId.IsValid())
+	{
+		NewRecord.Biography.UniqueId = FGuid::NewGuid();
+	}
+	else if (FindNPCById(NewRecord.Biography.UniqueId))
+	{
+		UE_LOG(LogLyraNPC, Warning, TEXT("AddVirtualNPC: NPC %s already has an actor"), *NewRecord.Biography.UniqueId.ToString());
+		return FGuid();
+	}
+	NewRecord.VirtualizedAtGameHours = ElapsedGameHours;
+	NewRecord.VirtualizedAtTime = GetWorld()->GetTimeSeconds();
+
+	const FGuid NPCId = NewRecord.Biography.UniqueId;
+	VirtualPopulation.Add(MoveTemp(NewRecord));
+	return NPCId;
+}
+
+bool ULyraNPCWorldSubsystem::GetVirtualNPCRecord(const FGuid& NPCId, FLyraNPCVirtualRecord& OutRecord) const
+{
+	if (const FLyraNPCVirtualRecord* Record = VirtualPopulation.Find(NPCId))
+	{
+		OutRecord = *Record;
+		return true;
+	}
+	return false;
+}
+
+void ULyraNPCWorldSubsystem::ProcessVirtualization(float DeltaTime)
+{
+	if (!bVirtualizeDormantNPCs) return;
+
+	VirtualizationTimer -= DeltaTime;
+	if (VirtualizationTimer > 0.0f) return;
+	VirtualizationTimer = VirtualizationInterval;
+
+	// Collect first: virtualizing unregisters and reorders RegisteredNPCs
+	TArray<ALyraNPCCharacter*, TInlineAllocator<16>> ToVirtualize;
+	for (ALyraNPCCharacter* NPC : RegisteredNPCs)
 	{
-		CleanupInvalidReferences();
-		TimeSinceLastCleanup = 0.0f;
+		if (ToVirtualize.Num() >= MaxVirtualizationsPerPass) break;
+
+		const ALyraNPCAIController* Controller = Cast<ALyraNPCAIController>(NPC->GetController());
+		if (Controller && Controller->CurrentAILOD == ELyraNPCAILOD::Dormant &&
+			LODManager.GetDistanceToNearestViewer(NPC->GetActorLocation(), VirtualizationDistance) == MAX_FLT)
+		{
+			ToVirtualize.Add(NPC);
+		}
+	}
+	for (ALyraNPCCharacter* NPC : ToVirtualize)
+	{
+		VirtualizeNPC(NPC);
 	}
+
+	// Records near any viewer; an id found by two viewers fails the second RehydrateNPC harmlessly
+	TArray<FGuid> InRange;
+	for (const FLyraNPCLODManager::FViewer& Viewer : LODManager.GetViewers())
+	{
+		VirtualPopulation.FindInRadius(Viewer.Location, RehydrationDistance * Viewer.Weight, InRange);
+	}
+	int32 NumRehydrated = 0;
+	for (const FGuid& NPCId : InRange)
+	{
+		if (NumRehydrated >= MaxVirtualizationsPerPass) break;
+		if (RehydrateNPC(NPCId))
+		{
+			++NumRehydrated;
+		}
+	}
+}
+
+void ULyraNPCWorldSubsystem::ReleaseNPCActor(ALyraNPCCharacter* NPC)
+{
+	ALyraNPCAIController* Controller = Cast<ALyraNPCAIController>(NPC->GetController());
+	if (Controller)
+	{
+		Controller->StopUsingCurrentTask();
+	}
+
+	if (NPCActorPool.Num() >= MaxPooledNPCActors)
+	{
+		// EndPlay unregisters it
+		NPC->Destroy();
+		return;
+	}
+
+	UnregisterNPC(NPC);
+	if (Controller)
+	{
+		Controller->OnPawnPooled();
+	}
+
+	if (UCharacterMovementComponent* MovementComp = NPC->GetCharacterMovement())
+	{
+		MovementComp->StopMovementImmediately();
+	}
+	NPC->SetActorHiddenInGame(true);
+	NPC->SetActorEnableCollision(false);
+	NPC->SetActorTickEnabled(false);
+	NPC->ForEachComponent(false, [](UActorComponent* Component) { Component->SetComponentTickEnabled(false); });
+
+	NPCActorPool.Add(NPC);
+}
+
+ALyraNPCCharacter* ULyraNPCWorldSubsystem::AcquireNPCActor(const FLyraNPCVirtualRecord& Record)
+{
+	UWorld* World = GetWorld();
+	if (!World) return nullptr;
+
+	UClass* CharacterClass = Record.CharacterClass ? Record.CharacterClass.Get() : ALyraNPCCharacter::StaticClass();
+
+	for (int32 Index = NPCActorPool.Num() - 1; Index >= 0; --Index)
+	{
+		ALyraNPCCharacter* NPC = NPCActorPool[Index];
+		if (!IsValid(NPC))
+		{
+			NPCActorPool.RemoveAtSwap(Index);
+			continue;
+		}
+		if (NPC->GetClass() != CharacterClass) continue;
+
+		NPCActorPool.RemoveAtSwap(Index);
+
+		NPC->ReadVirtualRecord(Record);
+		NPC->SetActorTransform(Record.Transform, false, nullptr, ETeleportType::TeleportPhysics);
+		NPC->SetActorHiddenInGame(false);
+		NPC->SetActorEnableCollision(true);
+
+		// With tick profiles on, the controller's LOD settings below re-enable ticks for the NPC's new LOD
+		ALyraNPCAIController* Controller = Cast<ALyraNPCAIController>(NPC->GetController());
+		if (!Controller || !GetDefault<ULyraNPCSettings>()->bApplyLODTickProfiles)
+		{
+			NPC->SetActorTickEnabled(NPC->PrimaryActorTick.bStartWithTickEnabled);
+			NPC->ForEachComponent(false, [](UActorComponent* Component)
+			{
+				Component->SetComponentTickEnabled(Component->PrimaryComponentTick.bStartWithTickEnabled);
+			});
+		}
+
+		RegisterNPC(NPC);
+		NPC->CatchUpSimulation();
+		if (Controller)
+		{
+			Controller->OnPawnUnpooled();
+		}
+		return NPC;
+	}
+
+	// Components keep data set before BeginPlay, so the record survives their initialization
+	ALyraNPCCharacter* NPC = World->SpawnActorDeferred<ALyraNPCCharacter>(CharacterClass, Record.Transform, nullptr, nullptr,
+		ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+	if (!NPC) return nullptr;
+
+	NPC->bAutoInitialize = false;
+	NPC->ReadVirtualRecord(Record);
+	NPC->FinishSpawning(Record.Transform);
+	NPC->CatchUpSimulation();
+	return NPC;
+}
+
+void ULyraNPCWorldSubsystem::RegisterNPC(ALyraNPCCharacter* NPC)
+{
+	if (NPC && !IsNPCRegistered(NPC))
+	{
+		FLyraNPCRegistryEntry Entry;
+		Entry.NPC = NPC;
+		Entry.DenseIndex = RegisteredNPCs.Add(NPC);
+		NPC->RegistryHandle = NPCRegistry.Add(MoveTemp(Entry));
+		NPCSpatialHash.Add(NPC, NPC->GetActorLocation());
+		IndexNPCIdentity(NPC->RegistryHandle, *NPCRegistry.Find(NPC->RegistryHandle), NPC);
+		TrackNPCStats(NPC->RegistryHandle, *NPCRegistry.Find(NPC->RegistryHandle), NPC);
+
+		if (USceneComponent* Root = NPC->GetRootComponent())
+		{
+			Root->TransformUpdated.AddUObject(this, &ULyraNPCWorldSubsystem::OnNPCTransformUpdated);
+		}
+
+		if (bNeedsBatchActive && NPC->NeedsComponent)
+		{
+			NPC->NeedsComponent->AttachToBatch(NeedsBatch);
+		}
+
+		UE_LOG(LogLyraNPC, Verbose, TEXT("Registered NPC: %s (Total: %d)"), *NPC->GetNPCName(), NPCRegistry.Num());
+	}
+}
+
+void ULyraNPCWorldSubsystem::UnregisterNPC(ALyraNPCCharacter* NPC)
+{
+	if (!IsNPCRegistered(NPC)) return;
+
+	FLyraNPCRegistryEntry& Entry = *NPCRegistry.Find(NPC->RegistryHandle);
+	UnindexNPCIdentity(NPC->RegistryHandle, Entry);
+	UntrackNPCStats(Entry, NPC);
+	ReleaseAssignedTask(Entry, NPC);
+
+	// A pooled NPC keeps its component, which must not be called back while it waits
+	if (NPC->NeedsComponent)
+	{
+		NPC->NeedsComponent->CancelScheduledEvent();
+		NPC->NeedsComponent->DetachFromBatch();
+		ScaleSensitiveNeeds.Remove(NPC->NeedsComponent.Get());
+	}
+
+	RemoveFromNPCList(RegisteredNPCs, &FLyraNPCRegistryEntry::DenseIndex, Entry.DenseIndex);
+
+	NPCRegistry.Remove(NPC->RegistryHandle);
+	NPC->RegistryHandle.Reset();
+	NPCSpatialHash.Remove(NPC);
+
+	if (USceneComponent* Root = NPC->GetRootComponent())
+	{
+		Root->TransformUpdated.RemoveAll(this);
+	}
+
+	UE_LOG(LogLyraNPC, Verbose, TEXT("Unregistered NPC (Total: %d)"), NPCRegistry.Num());
+}
+
+bool ULyraNPCWorldSubsystem::IsNPCRegistered(const ALyraNPCCharacter* NPC) const
+{
+	if (!NPC) return false;
+
+	const FLyraNPCRegistryEntry* Entry = NPCRegistry.Find(NPC->RegistryHandle);
+	return Entry && Entry->NPC.Get() == NPC;
+}
+
+ALyraNPCCharacter* ULyraNPCWorldSubsystem::ResolveNPCHandle(FLyraNPCHandle Handle) const
+{
+	const FLyraNPCRegistryEntry* Entry = NPCRegistry.Find(Handle);
+	return Entry ? Entry->NPC.Get() : nullptr;
+}
+
+TArray<ALyraNPCCharacter*> ULyraNPCWorldSubsystem::GetAllNPCs() const
+{
+	return RegisteredNPCs;
+}
+
+TArray<ALyraNPCCharacter*> ULyraNPCWorldSubsystem::GetNPCsByArchetype(ELyraNPCArchetype Archetype) const
+{
+	return TArray<ALyraNPCCharacter*>(GetArchetypeView(Archetype));
+}
+
+TArray<ALyraNPCCharacter*> ULyraNPCWorldSubsystem::GetNPCsByLifeState(ELyraNPCLifeState LifeState) const
+{
+	return TArray<ALyraNPCCharacter*>(GetLifeStateView(LifeState));
+}
+
+TArray<ALyraNPCCharacter*> ULyraNPCWorldSubsystem::GetNPCsInRadius(FVector Location, float Radius) const
+{
+	TArray<ALyraNPCCharacter*> Result;
+	GetNPCsInRadius(Location, Radius, Result);
+	return Result;
+}
+
+TArray<ALyraNPCCharacter*> ULyraNPCWorldSubsystem::GetNPCsInBox(const FBox& Box) const
+{
+	TArray<ALyraNPCCharacter*> Result;
+	GetNPCsInBox(Box, Result);
+	return Result;
+}
+
+TArray<ALyraNPCCharacter*> ULyraNPCWorldSubsystem::GetNearestNPCs(FVector Location, int32 Count, float MaxRadius) const
+{
+	TArray<ALyraNPCCharacter*> Result;
+	GetNearestNPCs(Location, Count, MaxRadius, Result);
+	return Result;
+}
+
+ALyraNPCCharacter* ULyraNPCWorldSubsystem::FindNearestNPC(FVector Location, float MaxRadius) const
+{
+	ALyraNPCCharacter* Nearest = nullptr;
+	ForEachNearestNPC(Location, 1, MaxRadius, [&Nearest](ALyraNPCCharacter* NPC) { Nearest = NPC; });
+	return Nearest;
+}
+
+void ULyraNPCWorldSubsystem::ForEachNPC(TFunctionRef<void(ALyraNPCCharacter*)> Func) const
+{
+	for (ALyraNPCCharacter* NPC : RegisteredNPCs)
+	{
+		Func(NPC);
+	}
+}
+
+void ULyraNPCWorldSubsystem::ForEachNPCOfArchetype(ELyraNPCArchetype Archetype, TFunctionRef<void(ALyraNPCCharacter*)> Func) const
+{
+	for (ALyraNPCCharacter* NPC : GetArchetypeView(Archetype))
+	{
+		Func(NPC);
+	}
+}
+
+void ULyraNPCWorldSubsystem::ForEachNPCInLifeState(ELyraNPCLifeState LifeState, TFunctionRef<void(ALyraNPCCharacter*)> Func) const
+{
+	for (ALyraNPCCharacter* NPC : GetLifeStateView(LifeState))
+	{
+		Func(NPC);
+	}
+}
+
+TArrayView<ALyraNPCCharacter* const> ULyraNPCWorldSubsystem::GetArchetypeView(ELyraNPCArchetype Archetype) const
+{
+	if (Archetype >= ELyraNPCArchetype::MAX) return TArrayView<ALyraNPCCharacter* const>();
+	return NPCsByArchetype[static_cast<int32>(Archetype)];
+}
+
+TArrayView<ALyraNPCCharacter* const> ULyraNPCWorldSubsystem::GetLifeStateView(ELyraNPCLifeState LifeState) const
+{
+	if (LifeState >= ELyraNPCLifeState::MAX) return TArrayView<ALyraNPCCharacter* const>();
+	return NPCsByLifeState[static_cast<int32>(LifeState)];
+}
+
+void ULyraNPCWorldSubsystem::ForEachNPCInRadius(const FVector& Location, float Radius, TFunctionRef<void(ALyraNPCCharacter*)> Func) const
+{
+	NPCSpatialHash.ForEachInRadius(Location, Radius, [&Func](const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr, const FVector&)
+	{
+		if (ALyraNPCCharacter* NPC = NPCPtr.Get())
+		{
+			Func(NPC);
+		}
+	});
+}
+
+void ULyraNPCWorldSubsystem::ForEachNPCInBox(const FBox& Box, TFunctionRef<void(ALyraNPCCharacter*)> Func) const
+{
+	NPCSpatialHash.ForEachInBox(Box, [&Func](const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr, const FVector&)
+	{
+		if (ALyraNPCCharacter* NPC = NPCPtr.Get())
+		{
+			Func(NPC);
+		}
+	});
+}
+
+void ULyraNPCWorldSubsystem::ForEachNearestNPC(const FVector& Location, int32 Count, float MaxRadius, TFunctionRef<void(ALyraNPCCharacter*)> Func) const
+{
+	TArray<TWeakObjectPtr<ALyraNPCCharacter>, TInlineAllocator<16>> Nearest;
+	NPCSpatialHash.FindNearest(Location, Count, MaxRadius, Nearest,
+		[](const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr) { return NPCPtr.IsValid(); });
+
+	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : Nearest)
+	{
+		Func(NPCPtr.Get());
+	}
+}
+
+void ULyraNPCWorldSubsystem::SetSpatialCellSize(float NewCellSize)
+{
+	SpatialCellSize = FMath::Max(NewCellSize, 1.0f);
+	NPCSpatialHash.SetCellSize(SpatialCellSize);
+	TaskIndex.SetCellSize(SpatialCellSize);
+}
+
+void ULyraNPCWorldSubsystem::OnNPCTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (ALyraNPCCharacter* NPC = Cast<ALyraNPCCharacter>(UpdatedComponent->GetOwner()))
+	{
+		NPCSpatialHash.Update(NPC, UpdatedComponent->GetComponentLocation());
+	}
+}
+
+void ULyraNPCWorldSubsystem::OnTaskTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	TaskIndex.UpdateLocation(Cast<ULyraNPCTaskActor>(UpdatedComponent));
+}
+
+ALyraNPCCharacter* ULyraNPCWorldSubsystem::FindNPCById(const FGuid& NPCId) const
+{
+	const FLyraNPCHandle* Handle = NPCIdIndex.Find(NPCId);
+	return Handle ? ResolveNPCHandle(*Handle) : nullptr;
+}
+
+ALyraNPCCharacter* ULyraNPCWorldSubsystem::FindNPCByName(const FString& Name) const
+{
+	return ResolveNPCHandle(NPCNameIndex.FindFirstContaining(Name));
+}
+
+TArray<ALyraNPCCharacter*> ULyraNPCWorldSubsystem::FindNPCsByNamePrefix(const FString& Prefix, int32 MaxResults) const
+{
+	TArray<FLyraNPCHandle> Handles;
+	NPCNameIndex.FindByPrefix(Prefix, Handles, MaxResults);
+	return ResolveNPCHandles(Handles);
+}
+
+TArray<ALyraNPCCharacter*> ULyraNPCWorldSubsystem::FindNPCsByNameSubstring(const FString& Substring, int32 MaxResults) const
+{
+	TArray<FLyraNPCHandle> Handles;
+	NPCNameIndex.FindBySubstring(Substring, Handles, MaxResults);
+	return ResolveNPCHandles(Handles);
+}
+
+void ULyraNPCWorldSubsystem::RefreshNPCIdentity(ALyraNPCCharacter* NPC)
+{
+	if (!IsNPCRegistered(NPC)) return;
+
+	IndexNPCIdentity(NPC->RegistryHandle, *NPCRegistry.Find(NPC->RegistryHandle), NPC);
+}
+
+void ULyraNPCWorldSubsystem::IndexNPCIdentity(const FLyraNPCHandle& Handle, FLyraNPCRegistryEntry& Entry, const ALyraNPCCharacter* NPC)
+{
+	const FGuid NewId = NPC->IdentityComponent ? NPC->IdentityComponent->GetUniqueId() : FGuid();
+	if (NewId != Entry.IndexedId)
+	{
+		UnindexNPCIdentity(Handle, Entry);
+		if (NewId.IsValid())
+		{
+			NPCIdIndex.Add(NewId, Handle);
+			Entry.IndexedId = NewId;
+		}
+	}
+
+	NPCNameIndex.Set(Handle, NPC->GetNPCName());
+	SetCountedArchetype(Entry, NPC->GetArchetype());
+}
+
+void ULyraNPCWorldSubsystem::UnindexNPCIdentity(const FLyraNPCHandle& Handle, FLyraNPCRegistryEntry& Entry)
+{
+	// Two NPCs can share a biography, so only drop the id if it still points at this NPC
+	if (Entry.IndexedId.IsValid())
+	{
+		const FLyraNPCHandle* IndexedHandle = NPCIdIndex.Find(Entry.IndexedId);
+		if (IndexedHandle && *IndexedHandle == Handle)
+		{
+			NPCIdIndex.Remove(Entry.IndexedId);
+		}
+		Entry.IndexedId.Invalidate();
+	}
+
+	NPCNameIndex.Remove(Handle);
+	SetCountedArchetype(Entry, ELyraNPCArchetype::MAX);
+}
+
+TArray<ALyraNPCCharacter*> ULyraNPCWorldSubsystem::ResolveNPCHandles(const TArray<FLyraNPCHandle>& Handles) const
+{
+	TArray<ALyraNPCCharacter*> Result;
+	Result.Reserve(Handles.Num());
+	for (const FLyraNPCHandle& Handle : Handles)
+	{
+		if (ALyraNPCCharacter* NPC = ResolveNPCHandle(Handle))
+		{
+			Result.Add(NPC);
+		}
+	}
+	return Result;
+}
+
+void ULyraNPCWorldSubsystem::RegisterTaskActor(ULyraNPCTaskActor* Task)
+{
+	if (Task && !IsTaskRegistered(Task))
+	{
+		FLyraNPCTaskRegistryEntry Entry;
+		Entry.Task = Task;
+		Entry.DenseIndex = RegisteredTasks.Add(Task);
+		Task->RegistryHandle = TaskRegistry.Add(MoveTemp(Entry));
+		TaskIndex.Add(Task);
+		Task->TransformUpdated.AddUObject(this, &ULyraNPCWorldSubsystem::OnTaskTransformUpdated);
+		UE_LOG(LogLyraNPC, Verbose, TEXT("Registered Task: %s (Total: %d)"), *Task->TaskName, TaskRegistry.Num());
+	}
+}
+
+void ULyraNPCWorldSubsystem::UnregisterTaskActor(ULyraNPCTaskActor* Task)
+{
+	if (!IsTaskRegistered(Task)) return;
+
+	const int32 DenseIndex = TaskRegistry.Find(Task->RegistryHandle)->DenseIndex;
+	RegisteredTasks.RemoveAtSwap(DenseIndex);
+	if (RegisteredTasks.IsValidIndex(DenseIndex))
+	{
+		TaskRegistry.Find(RegisteredTasks[DenseIndex]->RegistryHandle)->DenseIndex = DenseIndex;
+	}
+
+	TaskRegistry.Remove(Task->RegistryHandle);
+	Task->RegistryHandle.Reset();
+	TaskIndex.Remove(Task);
+	Task->TransformUpdated.RemoveAll(this);
+}
+
+bool ULyraNPCWorldSubsystem::IsTaskRegistered(const ULyraNPCTaskActor* Task) const
+{
+	if (!Task) return false;
+
+	const FLyraNPCTaskRegistryEntry* Entry = TaskRegistry.Find(Task->RegistryHandle);
+	return Entry && Entry->Task.Get() == Task;
+}
+
+ULyraNPCTaskActor* ULyraNPCWorldSubsystem::ResolveTaskHandle(FLyraNPCTaskHandle Handle) const
+{
+	const FLyraNPCTaskRegistryEntry* Entry = TaskRegistry.Find(Handle);
+	return Entry ? Entry->Task.Get() : nullptr;
+}
+
+void ULyraNPCWorldSubsystem::RefreshTaskIndex(ULyraNPCTaskActor* Task)
+{
+	TaskIndex.Update(Task);
+}
+
+TArray<ULyraNPCTaskActor*> ULyraNPCWorldSubsystem::GetAllTasks() const
+{
+	return RegisteredTasks;
+}
+
+TArray<ULyraNPCTaskActor*> ULyraNPCWorldSubsystem::GetTasksByType(FGameplayTag TaskType) const
+{
+	TArray<ULyraNPCTaskActor*> Result;
+	GetTasksByType(TaskType, Result);
+	return Result;
 }
 
-TStatId ULyraNPCWorldSubsystem::GetStatId() const
+TArray<ULyraNPCTaskActor*> ULyraNPCWorldSubsystem::GetAvailableTasksForNPC(ALyraNPCCharacter* NPC) const
 {
-	RETURN_QUICK_DECLARE_CYCLE_STAT(ULyraNPCWorldSubsystem, STATGROUP_Tickables);
+	TArray<ULyraNPCTaskActor*> Result;
+	GetAvailableTasksForNPC(NPC, Result);
+	return Result;
 }
 
-void ULyraNPCWorldSubsystem::RegisterNPC(ALyraNPCCharacter* NPC)
+void ULyraNPCWorldSubsystem::ForEachTask(TFunctionRef<void(ULyraNPCTaskActor*)> Func) const
 {
-	if (NPC && !RegisteredNPCs.Contains(NPC))
+	for (ULyraNPCTaskActor* Task : RegisteredTasks)
 	{
-		RegisteredNPCs.Add(NPC);
-		UE_LOG(LogLyraNPC, Verbose, TEXT("Registered NPC: %s (Total: %d)"), *NPC->GetNPCName(), RegisteredNPCs.Num());
+		Func(Task);
 	}
 }
 
-void ULyraNPCWorldSubsystem::UnregisterNPC(ALyraNPCCharacter* NPC)
+void ULyraNPCWorldSubsystem::ForEachTaskOfType(const FGameplayTag& TaskType, const FVector& Location, float Radius, TFunctionRef<void(ULyraNPCTaskActor*)> Func) const
 {
-	RegisteredNPCs.Remove(NPC);
-	UE_LOG(LogLyraNPC, Verbose, TEXT("Unregistered NPC (Total: %d)"), RegisteredNPCs.Num());
+	TaskIndex.ForEachTask(TaskType, Location, Radius, Func);
 }
 
-TArray<ALyraNPCCharacter*> ULyraNPCWorldSubsystem::GetAllNPCs() const
+void ULyraNPCWorldSubsystem::ForEachAvailableTaskForNPC(ALyraNPCCharacter* NPC, TFunctionRef<void(ULyraNPCTaskActor*)> Func) const
 {
-	TArray<ALyraNPCCharacter*> Result;
-	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : RegisteredNPCs)
+	for (ULyraNPCTaskActor* Task : RegisteredTasks)
 	{
-		if (NPCPtr.IsValid())
+		if (Task->bIsAvailable && Task->CanNPCUseTask(NPC))
 		{
-			Result.Add(NPCPtr.Get());
+			Func(Task);
 		}
 	}
+}
+
+ULyraNPCTaskActor* ULyraNPCWorldSubsystem::FindBestTaskForNPC(ALyraNPCCharacter* NPC, FGameplayTag TaskType, float MaxDistance) const
+{
+	if (!NPC) return nullptr;
+
+	// A batch of one, so single and batched searches always agree
+	ULyraNPCTaskActor* BestTask = nullptr;
+	FLyraNPCTaskSearch::FindBestTasks(TaskIndex, MakeArrayView(&NPC, 1), TaskType, MaxDistance, MakeArrayView(&BestTask, 1), MinParallelTaskSearchBatch);
+	return BestTask;
+}
+
+TArray<ULyraNPCTaskActor*> ULyraNPCWorldSubsystem::FindBestTasksForNPCs(const TArray<ALyraNPCCharacter*>& NPCs, FGameplayTag TaskType, float MaxDistance) const
+{
+	TArray<ULyraNPCTaskActor*> Result;
+	FindBestTasksForNPCs(NPCs, TaskType, MaxDistance, Result);
 	return Result;
 }
 
-TArray<ALyraNPCCharacter*> ULyraNPCWorldSubsystem::GetNPCsByArchetype(ELyraNPCArchetype Archetype) const
+TArray<ULyraNPCTaskActor*> ULyraNPCWorldSubsystem::AssignTasksToNPCs(const TArray<ALyraNPCCharacter*>& NPCs, FGameplayTag TaskType, float MaxDistance)
 {
-	TArray<ALyraNPCCharacter*> Result;
-	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : RegisteredNPCs)
-	{
-		if (NPCPtr.IsValid() && NPCPtr->GetArchetype() == Archetype)
-		{
-			Result.Add(NPCPtr.Get());
-		}
-	}
+	TArray<ULyraNPCTaskActor*> Result;
+	Result.SetNumUninitialized(NPCs.Num());
+	AssignAndReserveTasks(NPCs, TaskType, MaxDistance, Result);
 	return Result;
 }
 
-TArray<ALyraNPCCharacter*> ULyraNPCWorldSubsystem::GetNPCsInRadius(FVector Location, float Radius) const
+ULyraNPCTaskActor* ULyraNPCWorldSubsystem::AssignTaskToNPC(ALyraNPCCharacter* NPC, FGameplayTag TaskType, float MaxDistance)
 {
-	TArray<ALyraNPCCharacter*> Result;
-	float RadiusSq = Radius * Radius;
+	if (!NPC) return nullptr;
 
-	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : RegisteredNPCs)
+	ULyraNPCTaskActor* Task = nullptr;
+	AssignAndReserveTasks(MakeArrayView(&NPC, 1), TaskType, MaxDistance, MakeArrayView(&Task, 1));
+	return Task;
+}
+
+void ULyraNPCWorldSubsystem::ReleaseTaskReservation(ALyraNPCCharacter* NPC)
+{
+	if (FLyraNPCRegistryEntry* Entry = FindNPCEntry(NPC))
 	{
-		if (NPCPtr.IsValid())
-		{
-			float DistSq = FVector::DistSquared(NPCPtr->GetActorLocation(), Location);
-			if (DistSq <= RadiusSq)
-			{
-				Result.Add(NPCPtr.Get());
-			}
-		}
+		ReleaseAssignedTask(*Entry, NPC);
 	}
-	return Result;
 }
 
-ALyraNPCCharacter* ULyraNPCWorldSubsystem::FindNPCById(const FGuid& NPCId) const
+void ULyraNPCWorldSubsystem::AssignAndReserveTasks(TArrayView<ALyraNPCCharacter* const> NPCs, const FGameplayTag& TaskType, float MaxDistance, TArrayView<ULyraNPCTaskActor*> OutTasks)
 {
-	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : RegisteredNPCs)
+	// A new assignment replaces the previous one, so its slot is free again for this round
+	for (ALyraNPCCharacter* NPC : NPCs)
 	{
-		if (NPCPtr.IsValid())
+		if (FLyraNPCRegistryEntry* Entry = FindNPCEntry(NPC))
 		{
-			if (ULyraNPCIdentityComponent* Identity = NPCPtr->IdentityComponent)
-			{
-				if (Identity->GetUniqueId() == NPCId)
-				{
-					return NPCPtr.Get();
-				}
-			}
+			ReleaseAssignedTask(*Entry, NPC);
 		}
 	}
-	return nullptr;
-}
 
-ALyraNPCCharacter* ULyraNPCWorldSubsystem::FindNPCByName(const FString& Name) const
-{
-	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : RegisteredNPCs)
+	const int32 RequeriesAvoided = FLyraNPCTaskSearch::AssignTasks(TaskIndex, NPCs, TaskType, MaxDistance, OutTasks, MinParallelTaskSearchBatch);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	int32 NumAssigned = 0;
+	for (int32 Index = 0; Index < NPCs.Num(); ++Index)
 	{
-		if (NPCPtr.IsValid())
+		ULyraNPCTaskActor* Task = OutTasks[Index];
+		if (!Task) continue;
+
+		if (!Task->Reserve(NPCs[Index]))
 		{
-			if (NPCPtr->GetNPCName().Contains(Name))
-			{
-				return NPCPtr.Get();
-			}
+			OutTasks[Index] = nullptr;
+			continue;
+		}
+
+		if (FLyraNPCRegistryEntry* Entry = FindNPCEntry(NPCs[Index]))
+		{
+			Entry->AssignedTask = Task;
+			Entry->AssignedTaskTime = Now;
+			TaskReservations.Add({ NPCs[Index], Now });
 		}
+		++NumAssigned;
 	}
-	return nullptr;
+
+	++AssignmentStats.NumRounds;
+	AssignmentStats.NumRequests += NPCs.Num();
+	AssignmentStats.NumAssigned += NumAssigned;
+	AssignmentStats.NumRequeriesAvoided += RequeriesAvoided;
 }
 
-void ULyraNPCWorldSubsystem::RegisterTaskActor(ULyraNPCTaskActor* Task)
+void ULyraNPCWorldSubsystem::ReleaseAssignedTask(FLyraNPCRegistryEntry& Entry, ALyraNPCCharacter* NPC)
 {
-	if (Task && !RegisteredTasks.Contains(Task))
+	// Once the NPC starts using the task the reservation is consumed and there is nothing to release
+	ULyraNPCTaskActor* Task = Entry.AssignedTask.Get();
+	if (Task && Task->IsReservedBy(NPC))
 	{
-		RegisteredTasks.Add(Task);
-		UE_LOG(LogLyraNPC, Verbose, TEXT("Registered Task: %s (Total: %d)"), *Task->TaskName, RegisteredTasks.Num());
+		Task->CancelReservation(NPC);
 	}
+	Entry.AssignedTask.Reset();
 }
 
-void ULyraNPCWorldSubsystem::UnregisterTaskActor(ULyraNPCTaskActor* Task)
-{
-	RegisteredTasks.Remove(Task);
-}
-
-TArray<ULyraNPCTaskActor*> ULyraNPCWorldSubsystem::GetAllTasks() const
+void ULyraNPCWorldSubsystem::ExpireTaskReservations()
 {
-	TArray<ULyraNPCTaskActor*> Result;
-	for (const TWeakObjectPtr<ULyraNPCTaskActor>& TaskPtr : RegisteredTasks)
+	// Reservations are queued in time order, so only the expired prefix is visited
+	const double Cutoff = GetWorld()->GetTimeSeconds() - TaskReservationTimeout;
+	int32 NumExpired = 0;
+	for (; NumExpired < TaskReservations.Num() && TaskReservations[NumExpired].ReservedAt <= Cutoff; ++NumExpired)
 	{
-		if (TaskPtr.IsValid())
+		ALyraNPCCharacter* NPC = TaskReservations[NumExpired].NPC.Get();
+		FLyraNPCRegistryEntry* Entry = FindNPCEntry(NPC);
+
+		// Skip reservations already released or replaced by a newer assignment
+		if (Entry && Entry->AssignedTask.IsValid() && Entry->AssignedTaskTime == TaskReservations[NumExpired].ReservedAt)
 		{
-			Result.Add(TaskPtr.Get());
+			UE_LOG(LogLyraNPC, Verbose, TEXT("Task reservation for %s timed out"), *NPC->GetNPCName());
+			ReleaseAssignedTask(*Entry, NPC);
 		}
 	}
-	return Result;
+
+	if (NumExpired > 0)
+	{
+		TaskReservations.RemoveAt(0, NumExpired);
+	}
 }
 
-TArray<ULyraNPCTaskActor*> ULyraNPCWorldSubsystem::GetTasksByType(FGameplayTag TaskType) const
+uint32 ULyraNPCWorldSubsystem::RequestBestTaskForNPC(ALyraNPCCharacter* NPC, const FGameplayTag& TaskType, float MaxDistance, FLyraNPCTaskSearchDelegate OnComplete)
 {
-	TArray<ULyraNPCTaskActor*> Result;
-	for (const TWeakObjectPtr<ULyraNPCTaskActor>& TaskPtr : RegisteredTasks)
+	FLyraNPCPendingTaskSearch& Request = PendingTaskSearches.AddDefaulted_GetRef();
+	Request.RequestId = NextTaskSearchId++;
+	Request.NPC = NPC;
+	Request.TaskType = TaskType;
+	Request.MaxDistance = MaxDistance;
+	Request.OnComplete = MoveTemp(OnComplete);
+
+	// Zero is never handed out, so callers can use it as "no request"
+	if (NextTaskSearchId == 0)
 	{
-		if (TaskPtr.IsValid() && TaskPtr->TaskType.MatchesTag(TaskType))
-		{
-			Result.Add(TaskPtr.Get());
-		}
+		NextTaskSearchId = 1;
 	}
-	return Result;
+
+	return Request.RequestId;
 }
 
-TArray<ULyraNPCTaskActor*> ULyraNPCWorldSubsystem::GetAvailableTasksForNPC(ALyraNPCCharacter* NPC) const
+void ULyraNPCWorldSubsystem::CancelTaskSearch(uint32 RequestId)
 {
-	TArray<ULyraNPCTaskActor*> Result;
-	for (const TWeakObjectPtr<ULyraNPCTaskActor>& TaskPtr : RegisteredTasks)
+	const int32 PendingIndex = PendingTaskSearches.IndexOfByPredicate([RequestId](const FLyraNPCPendingTaskSearch& Request) { return Request.RequestId == RequestId; });
+	if (PendingIndex != INDEX_NONE)
+	{
+		PendingTaskSearches.RemoveAt(PendingIndex);
+		return;
+	}
+
+	// Already part of this frame's batch: keep the slot but silence the callback
+	for (FLyraNPCPendingTaskSearch& Request : ActiveTaskSearches)
 	{
-		if (TaskPtr.IsValid() && TaskPtr->bIsAvailable && TaskPtr->CanNPCUseTask(NPC))
+		if (Request.RequestId == RequestId)
 		{
-			Result.Add(TaskPtr.Get());
+			Request.OnComplete.Unbind();
+			return;
 		}
 	}
-	return Result;
 }
 
-ULyraNPCTaskActor* ULyraNPCWorldSubsystem::FindBestTaskForNPC(ALyraNPCCharacter* NPC, FGameplayTag TaskType) const
+void ULyraNPCWorldSubsystem::ProcessTaskSearches()
 {
-	ULyraNPCTaskActor* BestTask = nullptr;
-	float BestScore = 0.0f;
+	// Under governor pressure the queue drains at half rate; requests wait rather than being dropped
+	const int32 Budget = FrameGovernor.ShouldDeferNonCriticalWork() ? MaxTaskSearchesPerFrame / 2 : MaxTaskSearchesPerFrame;
+	const int32 Count = FMath::Min(PendingTaskSearches.Num(), FMath::Max(Budget, 1));
+	if (Count == 0) return;
 
-	for (const TWeakObjectPtr<ULyraNPCTaskActor>& TaskPtr : RegisteredTasks)
+	// Callbacks may queue or cancel searches, so this frame's slice is detached first
+	ActiveTaskSearches.Reset();
+	ActiveTaskSearches.Append(PendingTaskSearches.GetData(), Count);
+	PendingTaskSearches.RemoveAt(0, Count);
+
+	TArray<ALyraNPCCharacter*> BatchNPCs;
+	TArray<int32> BatchMembers;
+	TArray<ULyraNPCTaskActor*> BatchResults;
+	TBitArray<> Resolved(false, Count);
+
+	for (int32 First = 0; First < Count; ++First)
 	{
-		if (!TaskPtr.IsValid() || !TaskPtr->bIsAvailable) continue;
+		if (Resolved[First]) continue;
 
-		// Filter by type if specified
-		if (TaskType.IsValid() && !TaskPtr->TaskType.MatchesTag(TaskType)) continue;
+		// Group every request sharing this one's type and radius into a single search
+		const FGameplayTag TaskType = ActiveTaskSearches[First].TaskType;
+		const float MaxDistance = ActiveTaskSearches[First].MaxDistance;
 
-		float Score = TaskPtr->GetScoreForNPC(NPC);
-		if (Score > BestScore)
+		BatchNPCs.Reset();
+		BatchMembers.Reset();
+		for (int32 Index = First; Index < Count; ++Index)
 		{
-			BestScore = Score;
-			BestTask = TaskPtr.Get();
+			const FLyraNPCPendingTaskSearch& Request = ActiveTaskSearches[Index];
+			if (!Resolved[Index] && Request.TaskType == TaskType && Request.MaxDistance == MaxDistance)
+			{
+				Resolved[Index] = true;
+				BatchMembers.Add(Index);
+				BatchNPCs.Add(Request.NPC.Get());
+			}
 		}
-	}
-
-	return BestTask;
-}
 
-TArray<ULyraNPCTaskActor*> ULyraNPCWorldSubsystem::GetTasksInRadius(FVector Location, float Radius) const
-{
-	TArray<ULyraNPCTaskActor*> Result;
-	float RadiusSq = Radius * Radius;
+		BatchResults.SetNumUninitialized(BatchNPCs.Num());
+		if (bAssignQueuedTaskSearches)
+		{
+			AssignAndReserveTasks(BatchNPCs, TaskType, MaxDistance, BatchResults);
+		}
+		else
+		{
+			FindBestTasksForNPCs(BatchNPCs, TaskType, MaxDistance, BatchResults);
+		}
 
-	for (const TWeakObjectPtr<ULyraNPCTaskActor>& TaskPtr : RegisteredTasks)
-	{
-		if (TaskPtr.IsValid())
+		for (int32 Member = 0; Member < BatchMembers.Num(); ++Member)
 		{
-			float DistSq = FVector::DistSquared(TaskPtr->GetTaskLocation(), Location);
-			if (DistSq <= RadiusSq)
+			FLyraNPCPendingTaskSearch& Request = ActiveTaskSearches[BatchMembers[Member]];
+			if (Request.OnComplete.IsBound())
 			{
-				Result.Add(TaskPtr.Get());
+				Request.OnComplete.Execute(BatchResults[Member]);
+			}
+			else if (bAssignQueuedTaskSearches && BatchResults[Member])
+			{
+				// Cancelled after the batch was formed: nobody will use the reservation
+				ReleaseTaskReservation(BatchNPCs[Member]);
 			}
 		}
 	}
+
+	ActiveTaskSearches.Reset();
+}
+
+TArray<ULyraNPCTaskActor*> ULyraNPCWorldSubsystem::GetTasksInRadius(FVector Location, float Radius) const
+{
+	return GetTasksOfTypeInRadius(FGameplayTag(), Location, Radius);
+}
+
+TArray<ULyraNPCTaskActor*> ULyraNPCWorldSubsystem::GetTasksOfTypeInRadius(FGameplayTag TaskType, FVector Location, float Radius) const
+{
+	TArray<ULyraNPCTaskActor*> Result;
+	GetTasksOfTypeInRadius(TaskType, Location, Radius, Result);
 	return Result;
 }
 
 void ULyraNPCWorldSubsystem::SetGlobalGameHour(float NewHour)
 {
+	// Schedules read the clock on their next tick, so nothing is pushed to the NPCs
 	GlobalGameHour = FMath::Fmod(NewHour, 24.0f);
-	SyncAllNPCSchedulesToGlobalTime();
 }
 
 void ULyraNPCWorldSubsystem::AdvanceGlobalTime(float Hours)
 {
+	// Needs lines and game-clock events are based on ElapsedGameHours and assume it never decreases
+	if (Hours <= 0.0f) return;
+
+	ElapsedGameHours += Hours;
 	GlobalGameHour += Hours;
 	while (GlobalGameHour >= 24.0f)
 	{
 		GlobalGameHour -= 24.0f;
 	}
-	SyncAllNPCSchedulesToGlobalTime();
+
+	// Needs decay through the skipped hours; crossings on the game clock fall due on the next tick
+	RebaseScaleSensitiveNeeds();
 }
 
 void ULyraNPCWorldSubsystem::SetTimeScale(float NewScale)
 {
 	GlobalTimeScale = NewScale;
-	SetAllNPCsTimeScale(NewScale);
+	SyncNeedsTimeScale();
 }
 
 bool ULyraNPCWorldSubsystem::IsGlobalNightTime() const
@@ -279,80 +1185,352 @@ FString ULyraNPCWorldSubsystem::GetTimeString() const
 
 int32 ULyraNPCWorldSubsystem::GetNPCCountByLOD(ELyraNPCAILOD LOD) const
 {
-	int32 Count = 0;
-	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : RegisteredNPCs)
+	return LOD < ELyraNPCAILOD::MAX ? NPCCountByLOD[static_cast<int32>(LOD)] : 0;
+}
+
+float ULyraNPCWorldSubsystem::GetAverageNPCWellbeing() const
+{
+	if (NPCRegistry.Num() == 0) return 100.0f;
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	return static_cast<float>((WellbeingSum + WellbeingRateSum * Now + WellbeingHourRateSum * ElapsedGameHours) / NPCRegistry.Num());
+}
+
+int32 ULyraNPCWorldSubsystem::GetNPCsInCombatCount() const
+{
+	return GetNPCCountByAlertLevel(ELyraNPCAlertLevel::Combat);
+}
+
+int32 ULyraNPCWorldSubsystem::GetNPCCountByAlertLevel(ELyraNPCAlertLevel AlertLevel) const
+{
+	return AlertLevel < ELyraNPCAlertLevel::MAX ? NPCCountByAlertLevel[static_cast<int32>(AlertLevel)] : 0;
+}
+
+int32 ULyraNPCWorldSubsystem::GetNPCCountByLifeState(ELyraNPCLifeState LifeState) const
+{
+	return GetLifeStateView(LifeState).Num();
+}
+
+int32 ULyraNPCWorldSubsystem::GetNPCCountByArchetype(ELyraNPCArchetype Archetype) const
+{
+	return GetArchetypeView(Archetype).Num();
+}
+
+bool ULyraNPCWorldSubsystem::VerifyPopulationStats()
+{
+	int32 ExpectedLOD[UE_ARRAY_COUNT(NPCCountByLOD)] = {};
+	int32 ExpectedAlert[UE_ARRAY_COUNT(NPCCountByAlertLevel)] = {};
+	double ExpectedWellbeing = 0.0;
+	double ExpectedWellbeingRate = 0.0;
+	double ExpectedWellbeingHourRate = 0.0;
+	int32 DriftedNPCs = 0;
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	for (FLyraNPCRegistryEntry& Entry : NPCRegistry)
 	{
-		if (NPCPtr.IsValid())
+		ALyraNPCCharacter* NPC = Entry.NPC.Get();
+		if (!NPC) continue;
+
+		const ALyraNPCAIController* Controller = Cast<ALyraNPCAIController>(NPC->GetController());
+		const ELyraNPCAILOD LOD = Controller ? Controller->CurrentAILOD : ELyraNPCAILOD::MAX;
+		const ELyraNPCAlertLevel AlertLevel = NPC->GetAlertLevel();
+		const ELyraNPCLifeState LifeState = NPC->GetLifeState();
+		const ELyraNPCArchetype Archetype = NPC->GetArchetype();
+		const float Wellbeing = NPC->GetOverallWellbeing();
+		float WellbeingRate = 0.0f;
+		float WellbeingHourRate = 0.0f;
+		if (NPC->NeedsComponent)
 		{
-			if (ALyraNPCAIController* Controller = Cast<ALyraNPCAIController>(NPCPtr->GetController()))
-			{
-				if (Controller->CurrentAILOD == LOD)
-				{
-					Count++;
-				}
-			}
+			NPC->NeedsComponent->GetWellbeingRates(WellbeingRate, WellbeingHourRate);
+		}
+		const float CountedWellbeing = Entry.CountedWellbeing + Entry.CountedWellbeingRate * static_cast<float>(Now - Entry.CountedWellbeingTime) +
+			Entry.CountedWellbeingHourRate * static_cast<float>(ElapsedGameHours - Entry.CountedWellbeingGameHours);
+
+		if (LOD != Entry.CountedLOD || AlertLevel != Entry.CountedAlertLevel || LifeState != Entry.CountedLifeState ||
+			Archetype != Entry.CountedArchetype || !FMath::IsNearlyEqual(Wellbeing, CountedWellbeing, 0.01f))
+		{
+			UE_LOG(LogLyraNPC, Warning, TEXT("VerifyStats: %s drifted (LOD %d/%d, Alert %d/%d, LifeState %d/%d, Archetype %d/%d, Wellbeing %.2f/%.2f)"),
+				*NPC->GetNPCName(),
+				static_cast<int32>(Entry.CountedLOD), static_cast<int32>(LOD),
+				static_cast<int32>(Entry.CountedAlertLevel), static_cast<int32>(AlertLevel),
+				static_cast<int32>(Entry.CountedLifeState), static_cast<int32>(LifeState),
+				static_cast<int32>(Entry.CountedArchetype), static_cast<int32>(Archetype),
+				CountedWellbeing, Wellbeing);
+			DriftedNPCs++;
+
+			// Membership lists move with the entry, so they are fixed here rather than rebuilt
+			SetCountedLifeState(Entry, LifeState);
+			SetCountedArchetype(Entry, Archetype);
+		}
+
+		Entry.CountedLOD = LOD;
+		Entry.CountedAlertLevel = AlertLevel;
+		Entry.CountedWellbeing = Wellbeing;
+		Entry.CountedWellbeingRate = WellbeingRate;
+		Entry.CountedWellbeingHourRate = WellbeingHourRate;
+		Entry.CountedWellbeingTime = Now;
+		Entry.CountedWellbeingGameHours = ElapsedGameHours;
+
+		if (LOD != ELyraNPCAILOD::MAX)
+		{
+			ExpectedLOD[static_cast<int32>(LOD)]++;
 		}
+		ExpectedAlert[static_cast<int32>(AlertLevel)]++;
+		ExpectedWellbeing += Wellbeing - WellbeingRate * Now - WellbeingHourRate * ElapsedGameHours;
+		ExpectedWellbeingRate += WellbeingRate;
+		ExpectedWellbeingHourRate += WellbeingHourRate;
 	}
-	return Count;
+
+	// The aggregate counters are compared separately since they could drift even if every entry is right
+	const bool bCountersMatch =
+		FMemory::Memcmp(ExpectedLOD, NPCCountByLOD, sizeof(NPCCountByLOD)) == 0 &&
+		FMemory::Memcmp(ExpectedAlert, NPCCountByAlertLevel, sizeof(NPCCountByAlertLevel)) == 0 &&
+		FMath::IsNearlyEqual(ExpectedWellbeing + ExpectedWellbeingRate * Now + ExpectedWellbeingHourRate * ElapsedGameHours,
+			WellbeingSum + WellbeingRateSum * Now + WellbeingHourRateSum * ElapsedGameHours, 0.01 * FMath::Max(1, NPCRegistry.Num()));
+
+	FMemory::Memcpy(NPCCountByLOD, ExpectedLOD, sizeof(NPCCountByLOD));
+	FMemory::Memcpy(NPCCountByAlertLevel, ExpectedAlert, sizeof(NPCCountByAlertLevel));
+	WellbeingSum = ExpectedWellbeing;
+	WellbeingRateSum = ExpectedWellbeingRate;
+	WellbeingHourRateSum = ExpectedWellbeingHourRate;
+
+	UE_LOG(LogLyraNPC, Log, TEXT("VerifyStats: %d NPCs checked, %d drifted, counters %s"),
+		NPCRegistry.Num(), DriftedNPCs, bCountersMatch ? TEXT("match") : TEXT("resynced"));
+	return bCountersMatch && DriftedNPCs == 0;
 }
 
-float ULyraNPCWorldSubsystem::GetAverageNPCWellbeing() const
+void ULyraNPCWorldSubsystem::RefreshNPCController(ALyraNPCCharacter* NPC)
+{
+	if (FLyraNPCRegistryEntry* Entry = FindNPCEntry(NPC))
+	{
+		BindNPCController(*Entry, NPC);
+	}
+}
+
+void ULyraNPCWorldSubsystem::TrackNPCStats(const FLyraNPCHandle& Handle, FLyraNPCRegistryEntry& Entry, ALyraNPCCharacter* NPC)
 {
-	if (RegisteredNPCs.Num() == 0) return 100.0f;
+	BindNPCController(Entry, NPC);
+	SetCountedAlertLevel(Entry, NPC->GetAlertLevel());
+	SetCountedLifeState(Entry, NPC->GetLifeState());
+	float WellbeingRate = 0.0f;
+	float WellbeingHourRate = 0.0f;
+	if (NPC->NeedsComponent)
+	{
+		NPC->NeedsComponent->GetWellbeingRates(WellbeingRate, WellbeingHourRate);
+	}
+	SetCountedWellbeing(Entry, NPC->GetOverallWellbeing(), WellbeingRate, WellbeingHourRate);
 
-	float TotalWellbeing = 0.0f;
-	int32 ValidCount = 0;
+	if (ULyraNPCCognitiveComponent* Cognitive = NPC->CognitiveComponent)
+	{
+		Cognitive->OnAlertLevelChanged.AddUniqueDynamic(this, &ULyraNPCWorldSubsystem::HandleNPCAlertLevelChanged);
+	}
+	if (ULyraNPCIdentityComponent* Identity = NPC->IdentityComponent)
+	{
+		Identity->OnLifeStateChanged.AddUniqueDynamic(this, &ULyraNPCWorldSubsystem::HandleNPCLifeStateChanged);
+	}
+	if (ULyraNPCNeedsComponent* Needs = NPC->NeedsComponent)
+	{
+		Needs->OnWellbeingChangedNative.AddUObject(this, &ULyraNPCWorldSubsystem::HandleNPCWellbeingChanged, Handle);
+	}
+}
 
-	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : RegisteredNPCs)
+void ULyraNPCWorldSubsystem::UntrackNPCStats(FLyraNPCRegistryEntry& Entry, ALyraNPCCharacter* NPC)
+{
+	if (ALyraNPCAIController* Controller = Entry.BoundController.Get())
 	{
-		if (NPCPtr.IsValid())
-		{
-			TotalWellbeing += NPCPtr->GetOverallWellbeing();
-			ValidCount++;
-		}
+		Controller->OnAILODChanged.RemoveDynamic(this, &ULyraNPCWorldSubsystem::HandleNPCAILODChanged);
 	}
+	Entry.BoundController.Reset();
+
+	SetCountedLOD(Entry, ELyraNPCAILOD::MAX);
+	SetCountedAlertLevel(Entry, ELyraNPCAlertLevel::MAX);
+	SetCountedLifeState(Entry, ELyraNPCLifeState::MAX);
+	SetCountedWellbeing(Entry, 0.0f, 0.0f, 0.0f);
 
-	return ValidCount > 0 ? TotalWellbeing / ValidCount : 100.0f;
+	if (ULyraNPCCognitiveComponent* Cognitive = NPC->CognitiveComponent)
+	{
+		Cognitive->OnAlertLevelChanged.RemoveDynamic(this, &ULyraNPCWorldSubsystem::HandleNPCAlertLevelChanged);
+	}
+	if (ULyraNPCIdentityComponent* Identity = NPC->IdentityComponent)
+	{
+		Identity->OnLifeStateChanged.RemoveDynamic(this, &ULyraNPCWorldSubsystem::HandleNPCLifeStateChanged);
+	}
+	if (ULyraNPCNeedsComponent* Needs = NPC->NeedsComponent)
+	{
+		Needs->OnWellbeingChangedNative.RemoveAll(this);
+	}
 }
 
-int32 ULyraNPCWorldSubsystem::GetNPCsInCombatCount() const
+void ULyraNPCWorldSubsystem::BindNPCController(FLyraNPCRegistryEntry& Entry, ALyraNPCCharacter* NPC)
 {
-	int32 Count = 0;
-	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : RegisteredNPCs)
+	ALyraNPCAIController* NewController = Cast<ALyraNPCAIController>(NPC->GetController());
+	ALyraNPCAIController* OldController = Entry.BoundController.Get();
+
+	if (OldController != NewController)
 	{
-		if (NPCPtr.IsValid() && NPCPtr->GetAlertLevel() == ELyraNPCAlertLevel::Combat)
+		if (OldController)
 		{
-			Count++;
+			OldController->OnAILODChanged.RemoveDynamic(this, &ULyraNPCWorldSubsystem::HandleNPCAILODChanged);
 		}
+		if (NewController)
+		{
+			NewController->OnAILODChanged.AddUniqueDynamic(this, &ULyraNPCWorldSubsystem::HandleNPCAILODChanged);
+		}
+		Entry.BoundController = NewController;
+	}
+
+	SetCountedLOD(Entry, NewController ? NewController->CurrentAILOD : ELyraNPCAILOD::MAX);
+}
+
+void ULyraNPCWorldSubsystem::SetCountedLOD(FLyraNPCRegistryEntry& Entry, ELyraNPCAILOD NewLOD)
+{
+	if (Entry.CountedLOD != ELyraNPCAILOD::MAX)
+	{
+		NPCCountByLOD[static_cast<int32>(Entry.CountedLOD)]--;
+	}
+	Entry.CountedLOD = NewLOD;
+	if (NewLOD != ELyraNPCAILOD::MAX)
+	{
+		NPCCountByLOD[static_cast<int32>(NewLOD)]++;
+	}
+}
+
+void ULyraNPCWorldSubsystem::SetCountedAlertLevel(FLyraNPCRegistryEntry& Entry, ELyraNPCAlertLevel NewAlertLevel)
+{
+	if (Entry.CountedAlertLevel != ELyraNPCAlertLevel::MAX)
+	{
+		NPCCountByAlertLevel[static_cast<int32>(Entry.CountedAlertLevel)]--;
+	}
+	Entry.CountedAlertLevel = NewAlertLevel;
+	if (NewAlertLevel != ELyraNPCAlertLevel::MAX)
+	{
+		NPCCountByAlertLevel[static_cast<int32>(NewAlertLevel)]++;
+	}
+}
+
+void ULyraNPCWorldSubsystem::SetCountedLifeState(FLyraNPCRegistryEntry& Entry, ELyraNPCLifeState NewLifeState)
+{
+	if (Entry.CountedLifeState == NewLifeState) return;
+
+	if (Entry.CountedLifeState != ELyraNPCLifeState::MAX)
+	{
+		RemoveFromNPCList(NPCsByLifeState[static_cast<int32>(Entry.CountedLifeState)], &FLyraNPCRegistryEntry::LifeStateSlot, Entry.LifeStateSlot);
+	}
+	Entry.CountedLifeState = NewLifeState;
+	if (NewLifeState != ELyraNPCLifeState::MAX)
+	{
+		Entry.LifeStateSlot = NPCsByLifeState[static_cast<int32>(NewLifeState)].Add(Entry.NPC.Get());
+	}
+}
+
+void ULyraNPCWorldSubsystem::SetCountedArchetype(FLyraNPCRegistryEntry& Entry, ELyraNPCArchetype NewArchetype)
+{
+	if (Entry.CountedArchetype == NewArchetype) return;
+
+	if (Entry.CountedArchetype != ELyraNPCArchetype::MAX)
+	{
+		RemoveFromNPCList(NPCsByArchetype[static_cast<int32>(Entry.CountedArchetype)], &FLyraNPCRegistryEntry::ArchetypeSlot, Entry.ArchetypeSlot);
+	}
+	Entry.CountedArchetype = NewArchetype;
+	if (NewArchetype != ELyraNPCArchetype::MAX)
+	{
+		Entry.ArchetypeSlot = NPCsByArchetype[static_cast<int32>(NewArchetype)].Add(Entry.NPC.Get());
+	}
+}
+
+void ULyraNPCWorldSubsystem::SetCountedWellbeing(FLyraNPCRegistryEntry& Entry, float NewWellbeing, float NewRate, float NewHourRate)
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	WellbeingSum -= Entry.CountedWellbeing - Entry.CountedWellbeingRate * Entry.CountedWellbeingTime - Entry.CountedWellbeingHourRate * Entry.CountedWellbeingGameHours;
+	WellbeingRateSum -= Entry.CountedWellbeingRate;
+	WellbeingHourRateSum -= Entry.CountedWellbeingHourRate;
+
+	Entry.CountedWellbeing = NewWellbeing;
+	Entry.CountedWellbeingRate = NewRate;
+	Entry.CountedWellbeingHourRate = NewHourRate;
+	Entry.CountedWellbeingTime = Now;
+	Entry.CountedWellbeingGameHours = ElapsedGameHours;
+
+	WellbeingSum += NewWellbeing - NewRate * Now - NewHourRate * ElapsedGameHours;
+	WellbeingRateSum += NewRate;
+	WellbeingHourRateSum += NewHourRate;
+}
+
+void ULyraNPCWorldSubsystem::RemoveFromNPCList(TArray<ALyraNPCCharacter*>& List, int32 FLyraNPCRegistryEntry::* SlotMember, int32& Slot)
+{
+	const int32 RemovedSlot = Slot;
+	Slot = INDEX_NONE;
+
+	List.RemoveAtSwap(RemovedSlot);
+	if (List.IsValidIndex(RemovedSlot))
+	{
+		// The last NPC was swapped into the freed slot
+		NPCRegistry.Find(List[RemovedSlot]->RegistryHandle)->*SlotMember = RemovedSlot;
+	}
+}
+
+FLyraNPCRegistryEntry* ULyraNPCWorldSubsystem::FindNPCEntry(const ALyraNPCCharacter* NPC)
+{
+	if (!NPC) return nullptr;
+
+	FLyraNPCRegistryEntry* Entry = NPCRegistry.Find(NPC->RegistryHandle);
+	return Entry && Entry->NPC.Get() == NPC ? Entry : nullptr;
+}
+
+void ULyraNPCWorldSubsystem::HandleNPCAILODChanged(ALyraNPCCharacter* NPC, ELyraNPCAILOD NewLOD)
+{
+	if (FLyraNPCRegistryEntry* Entry = FindNPCEntry(NPC))
+	{
+		SetCountedLOD(*Entry, NewLOD);
+	}
+}
+
+void ULyraNPCWorldSubsystem::HandleNPCAlertLevelChanged(ALyraNPCCharacter* NPC, ELyraNPCAlertLevel NewAlertLevel)
+{
+	if (FLyraNPCRegistryEntry* Entry = FindNPCEntry(NPC))
+	{
+		SetCountedAlertLevel(*Entry, NewAlertLevel);
+	}
+}
+
+void ULyraNPCWorldSubsystem::HandleNPCLifeStateChanged(ALyraNPCCharacter* NPC, ELyraNPCLifeState NewState)
+{
+	if (FLyraNPCRegistryEntry* Entry = FindNPCEntry(NPC))
+	{
+		SetCountedLifeState(*Entry, NewState);
+	}
+}
+
+void ULyraNPCWorldSubsystem::HandleNPCWellbeingChanged(float NewWellbeing, float WellbeingPerSecond, float WellbeingPerGameHour, FLyraNPCHandle Handle)
+{
+	if (FLyraNPCRegistryEntry* Entry = NPCRegistry.Find(Handle))
+	{
+		SetCountedWellbeing(*Entry, NewWellbeing, WellbeingPerSecond, WellbeingPerGameHour);
 	}
-	return Count;
 }
 
 void ULyraNPCWorldSubsystem::SetAllNPCsTimeScale(float NewTimeScale)
 {
-	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : RegisteredNPCs)
+	SetTimeScale(NewTimeScale);
+
+	for (ALyraNPCCharacter* NPC : RegisteredNPCs)
 	{
-		if (NPCPtr.IsValid())
+		if (ULyraNPCNeedsComponent* Needs = NPC->NeedsComponent)
 		{
-			if (ULyraNPCScheduleComponent* Schedule = NPCPtr->ScheduleComponent)
-			{
-				Schedule->TimeScale = NewTimeScale;
-			}
-			if (ULyraNPCNeedsComponent* Needs = NPCPtr->NeedsComponent)
-			{
-				Needs->TimeScale = NewTimeScale;
-			}
+			Needs->bOverrideTimeScale = false;
+			Needs->CatchUp();
 		}
 	}
 }
 
 void ULyraNPCWorldSubsystem::PauseAllNPCs()
 {
-	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : RegisteredNPCs)
+	for (const FLyraNPCRegistryEntry& Entry : NPCRegistry)
 	{
-		if (NPCPtr.IsValid())
+		if (Entry.NPC.IsValid())
 		{
-			if (ALyraNPCAIController* Controller = Cast<ALyraNPCAIController>(NPCPtr->GetController()))
+			if (ALyraNPCAIController* Controller = Cast<ALyraNPCAIController>(Entry.NPC->GetController()))
 			{
 				Controller->PauseBehaviorTree();
 			}
@@ -362,11 +1540,11 @@ void ULyraNPCWorldSubsystem::PauseAllNPCs()
 
 void ULyraNPCWorldSubsystem::ResumeAllNPCs()
 {
-	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : RegisteredNPCs)
+	for (const FLyraNPCRegistryEntry& Entry : NPCRegistry)
 	{
-		if (NPCPtr.IsValid())
+		if (Entry.NPC.IsValid())
 		{
-			if (ALyraNPCAIController* Controller = Cast<ALyraNPCAIController>(NPCPtr->GetController()))
+			if (ALyraNPCAIController* Controller = Cast<ALyraNPCAIController>(Entry.NPC->GetController()))
 			{
 				Controller->ResumeBehaviorTree();
 			}
@@ -376,14 +1554,12 @@ void ULyraNPCWorldSubsystem::ResumeAllNPCs()
 
 void ULyraNPCWorldSubsystem::SyncAllNPCSchedulesToGlobalTime()
 {
-	for (const TWeakObjectPtr<ALyraNPCCharacter>& NPCPtr : RegisteredNPCs)
+	for (ALyraNPCCharacter* NPC : RegisteredNPCs)
 	{
-		if (NPCPtr.IsValid())
+		if (ULyraNPCScheduleComponent* Schedule = NPC->ScheduleComponent)
 		{
-			if (ULyraNPCScheduleComponent* Schedule = NPCPtr->ScheduleComponent)
-			{
-				Schedule->SetGameHour(GlobalGameHour);
-			}
+			Schedule->bUseGlobalClock = true;
+			Schedule->GameHourOffset = 0.0f;
 		}
 	}
 }
@@ -391,6 +1567,7 @@ void ULyraNPCWorldSubsystem::SyncAllNPCSchedulesToGlobalTime()
 void ULyraNPCWorldSubsystem::UpdateGlobalTime(float DeltaTime)
 {
 	float GameTimeAdvance = (DeltaTime / 3600.0f) * GlobalTimeScale;
+	ElapsedGameHours += GameTimeAdvance;
 	GlobalGameHour += GameTimeAdvance;
 
 	while (GlobalGameHour >= 24.0f)
@@ -398,24 +1575,3 @@ void ULyraNPCWorldSubsystem::UpdateGlobalTime(float DeltaTime)
 		GlobalGameHour -= 24.0f;
 	}
 }
-
-void ULyraNPCWorldSubsystem::CleanupInvalidReferences()
-{
-	// Clean up invalid NPC references
-	for (int32 i = RegisteredNPCs.Num() - 1; i >= 0; --i)
-	{
-		if (!RegisteredNPCs[i].IsValid())
-		{
-			RegisteredNPCs.RemoveAt(i);
-		}
-	}
-
-	// Clean up invalid task references
-	for (int32 i = RegisteredTasks.Num() - 1; i >= 0; --i)
-	{
-		if (!RegisteredTasks[i].IsValid())
-		{
-			RegisteredTasks.RemoveAt(i);
-		}
-	}
-}
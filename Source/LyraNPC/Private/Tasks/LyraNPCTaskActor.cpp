@@ -4,6 +4,9 @@
 #include "LyraNPCModule.h"
 #include "Components/LyraNPCIdentityComponent.h"
 #include "Components/LyraNPCNeedsComponent.h"
+#include "Systems/LyraNPCWorldSubsystem.h"
+#include "Engine/World.h"
+#include "Systems/LyraNPCFrameGovernor.h"
 
 ULyraNPCTaskActor::ULyraNPCTaskActor()
 {
@@ -27,10 +30,29 @@ void ULyraNPCTaskActor::BeginPlay()
 {
 	Super::BeginPlay();
 	UpdateAvailability();
+
+	if (ULyraNPCWorldSubsystem* Subsystem = GetWorld()->GetSubsystem<ULyraNPCWorldSubsystem>())
+	{
+		Subsystem->RegisterTaskActor(this);
+	}
+}
+
+void ULyraNPCTaskActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		if (ULyraNPCWorldSubsystem* Subsystem = World->GetSubsystem<ULyraNPCWorldSubsystem>())
+		{
+			Subsystem->UnregisterTaskActor(this);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void ULyraNPCTaskActor::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	LYRANPC_SCOPE_FRAME_COST(this);
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 	CleanupInvalidReferences();
 	UpdateAvailability();
@@ -188,13 +210,13 @@ float ULyraNPCTaskActor::GetScoreForNPC(ALyraNPCCharacter* NPC) const
 			float NeedDeficit = 100.0f - NeedValue;
 
 			// Higher deficit = higher score bonus
-			Score += (NeedDeficit / 100.0f) * Pair.Value * 0.1f;
+			Score += (NeedDeficit / 100.0f) * Pair.Value * NeedScoreScale;
 		}
 	}
 
 	// Reduce score if far away (distance penalty)
 	float Distance = FVector::Dist(NPC->GetActorLocation(), GetTaskLocation());
-	float DistancePenalty = Distance / 10000.0f; // 1 point penalty per 10000 units
+	float DistancePenalty = Distance / DistancePenaltyScale; // 1 point penalty per 10000 units
 	Score -= DistancePenalty;
 
 	return FMath::Max(0.0f, Score);
@@ -292,6 +314,46 @@ void ULyraNPCTaskActor::SetOwner(const FGuid& NPCId)
 	bIsPrivate = NPCId.IsValid();
 }
 
+void ULyraNPCTaskActor::SetTaskType(FGameplayTag NewTaskType)
+{
+	if (TaskType == NewTaskType) return;
+
+	TaskType = NewTaskType;
+	RefreshTaskIndex();
+}
+
+void ULyraNPCTaskActor::SetTaskPriority(float NewPriority)
+{
+	if (TaskPriority == NewPriority) return;
+
+	TaskPriority = NewPriority;
+	RefreshTaskIndex();
+}
+
+void ULyraNPCTaskActor::SetNeedSatisfaction(ELyraNPCNeedType NeedType, float ValuePerMinute)
+{
+	if (ValuePerMinute == 0.0f)
+	{
+		NeedsSatisfaction.Remove(NeedType);
+	}
+	else
+	{
+		NeedsSatisfaction.Add(NeedType, ValuePerMinute);
+	}
+	RefreshTaskIndex();
+}
+
+void ULyraNPCTaskActor::RefreshTaskIndex()
+{
+	if (UWorld* World = GetWorld())
+	{
+		if (ULyraNPCWorldSubsystem* Subsystem = World->GetSubsystem<ULyraNPCWorldSubsystem>())
+		{
+			Subsystem->RefreshTaskIndex(this);
+		}
+	}
+}
+
 void ULyraNPCTaskActor::UpdateAvailability()
 {
 	bIsAvailable = bIsEnabled && GetAvailableSlots() > 0;
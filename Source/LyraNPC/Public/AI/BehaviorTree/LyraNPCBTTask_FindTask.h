@@ -7,6 +7,9 @@
 #include "GameplayTagContainer.h"
 #include "LyraNPCBTTask_FindTask.generated.h"
 
+class ALyraNPCCharacter;
+class ULyraNPCTaskActor;
+
 /**
  * BT Task: Finds the best available task for the NPC based on needs and schedule.
  * Sets the found task in the blackboard.
@@ -31,7 +34,7 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Blackboard")
 	FBlackboardKeySelector TaskLocationKey;
 
-	// Maximum search radius
+	// Maximum search radius (<= 0 searches every task that could still score)
 	UPROPERTY(EditAnywhere, Category = "Task")
 	float SearchRadius = 10000.0f;
 
@@ -39,6 +42,26 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Task")
 	bool bUseScheduleForTaskType = true;
 
+	// Queue the search with the world subsystem so it is batched with other NPCs' searches.
+	// The node then finishes latently, usually on the next frame.
+	UPROPERTY(EditAnywhere, Category = "Task")
+	bool bUseBatchedSearch = false;
+
 	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void OnTaskFinished(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, EBTNodeResult::Type TaskResult) override;
+	virtual uint16 GetInstanceMemorySize() const override;
 	virtual FString GetStaticDescription() const override;
+
+protected:
+	struct FTaskMemory
+	{
+		// Queued batched search (0 = none)
+		uint32 SearchRequestId;
+	};
+
+	FGameplayTag GetSearchTag(const ALyraNPCCharacter* NPC) const;
+	EBTNodeResult::Type ApplyFoundTask(UBehaviorTreeComponent& OwnerComp, ALyraNPCCharacter* NPC, ULyraNPCTaskActor* BestTask) const;
+	static void ReleaseTaskReservation(UBehaviorTreeComponent& OwnerComp);
+	void OnBatchedSearchComplete(ULyraNPCTaskActor* BestTask, TWeakObjectPtr<UBehaviorTreeComponent> OwnerComp, uint8* NodeMemory);
 };
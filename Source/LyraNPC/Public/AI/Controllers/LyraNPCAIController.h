@@ -65,6 +65,25 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Performance")
 	float MinimalLODDistance = 10000.0f;
 
+	// How far past each threshold a viewer must move before the LOD changes, in either direction.
+	// Stops NPCs near a threshold flapping between two LODs.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Performance", meta = (ClampMin = "0.0"))
+	float FullLODHysteresis = 200.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Performance", meta = (ClampMin = "0.0"))
+	float ReducedLODHysteresis = 500.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Performance", meta = (ClampMin = "0.0"))
+	float MinimalLODHysteresis = 1000.0f;
+
+	// Let the world subsystem's LOD manager drive CurrentAILOD; turn off to run the per-controller check
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Performance")
+	bool bUseSubsystemLOD = true;
+
+	// Last significance score from the subsystem's significance LOD pass (see ULyraNPCSettings)
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category = "LyraNPC|Performance")
+	float LODSignificance = 0.0f;
+
 	// ===== CACHED COMPONENTS =====
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "LyraNPC|Components")
@@ -102,6 +121,11 @@ public:
 	virtual void OnUnPossess() override;
 	virtual void Tick(float DeltaTime) override;
 
+	// The world subsystem's actor pool keeps the pawn possessed; these stop the brain and the controller
+	// tick while it is pooled, and restart them as OnPossess would when it is handed out again
+	void OnPawnPooled();
+	void OnPawnUnpooled();
+
 	// ===== AI LOD MANAGEMENT =====
 
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|LOD")
@@ -113,6 +137,17 @@ public:
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|LOD")
 	float GetDistanceToNearestPlayer() const;
 
+	// LOD this controller's distance thresholds give for a viewer at Distance, with hysteresis around CurrentAILOD
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|LOD")
+	ELyraNPCAILOD GetLODForDistance(float Distance) const;
+
+	// Re-applies the controller and pawn tick rates for the current LOD, e.g. after the frame governor changed level
+	void ApplyLODTickRates();
+
+	// True while the world subsystem's LOD manager is updating this controller
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|LOD")
+	bool IsLODManagedBySubsystem() const;
+
 	// ===== BEHAVIOR TREE MANAGEMENT =====
 
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|BehaviorTree")
@@ -186,8 +221,12 @@ private:
 	void CacheComponents();
 	void SetupPerception();
 	void UpdateTaskTimer(float DeltaTime);
+	void RemoveTaskNeedModifiers();
 	void ApplyLODSettings();
 
+	// Need modifiers the current task added, removed when it stops
+	TArray<int32> TaskNeedModifiers;
+
 	float TimeSinceLastLODCheck = 0.0f;
 	float LODCheckInterval = 1.0f;
 };
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Core/LyraNPCTypes.h"
+#include "Core/LyraNPCSimulationClock.h"
 #include "LyraNPCCognitiveComponent.generated.h"
 
 /**
@@ -54,6 +55,14 @@ public:
 public:
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+	// Advances alertness and memory clarity over the time since the last update in one closed-form step.
+	// The NPC calls this when it is promoted out of a low AI LOD.
+	UFUNCTION(BlueprintCallable, Category = "Cognitive")
+	void CatchUp();
+
+	// Makes the next update cover the time since WorldTime, e.g. when restoring a virtualized NPC
+	void ResumeSimulationFrom(double WorldTime) { SimulationClock.LastTime = WorldTime; }
+
 	// ===== INTELLIGENCE MODIFIERS =====
 
 	// Returns a modified perception radius based on intelligence
@@ -182,6 +191,13 @@ private:
 	float CurrentAlertness = 0.0f;
 	float TimeSinceLastAlertChange = 0.0f;
 
+	// World time memory clarity was last decayed to, negative if never
+	float LastMemoryDecayTime = -1.0f;
+
+	// Seconds since the last decay pass; starts at a per-NPC phase
+	float MemoryDecayAccumulator = 0.0f;
+	FLyraNPCSimulationClock SimulationClock;
+
 	void UpdateAlertness(float DeltaTime);
 	void UpdateMemoryDecay(float DeltaTime);
 	void CleanupMemories();
@@ -106,4 +106,5 @@ private:
 	static TArray<FString> Occupations;
 
 	void InitializeNameData();
+	void NotifyIdentityChanged();
 };
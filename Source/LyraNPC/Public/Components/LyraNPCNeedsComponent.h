@@ -5,11 +5,24 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Core/LyraNPCTypes.h"
+#include "Core/LyraNPCSimulationClock.h"
 #include "LyraNPCNeedsComponent.generated.h"
 
+class ULyraNPCWorldSubsystem;
+class ULyraNPCNeedsProfile;
+class FLyraNPCNeedsBatch;
+
+// Wellbeing now and its rates of change per world second and per game hour, which hold until the next broadcast
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnNPCWellbeingChangedNative, float /*NewWellbeing*/, float /*WellbeingPerSecond*/, float /*WellbeingPerGameHour*/);
+
 /**
  * Component that manages NPC needs like hunger, energy, social, etc.
- * Needs decay over time and drive NPC behavior priorities.
+ * Rates, weights and thresholds come from a shared needs profile; the component only stores values.
+ * Needs change linearly (profile decay along the subsystem's game clock plus rate modifiers such as a
+ * task in use along world time), so they are stored as values at a base time and evaluated on read.
+ * The component never ticks: the world subsystem calls back at the next predicted threshold crossing.
+ * Lookups are indexed by need type, and urgency state is cached on every change. When the world
+ * subsystem batches needs, the stored values and base times live in its FLyraNPCNeedsBatch.
  */
 UCLASS(ClassGroup=(LyraNPC), meta=(BlueprintSpawnableComponent, DisplayName="LyraNPC Needs"))
 class LYRANPC_API ULyraNPCNeedsComponent : public UActorComponent
@@ -19,29 +32,85 @@ class LYRANPC_API ULyraNPCNeedsComponent : public UActorComponent
 public:
 	ULyraNPCNeedsComponent();
 
-	// All active needs for this NPC
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Needs", Replicated)
-	TArray<FLyraNPCNeedState> Needs;
+	// Profile defining this NPC's needs. When unset, the project's default profile for ProfileArchetype is used.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Needs", ReplicatedUsing = OnRep_Needs)
+	TObjectPtr<ULyraNPCNeedsProfile> Profile;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Needs", ReplicatedUsing = OnRep_Needs)
+	ELyraNPCArchetype ProfileArchetype = ELyraNPCArchetype::Villager;
+
+	// Value per need type (indexed by ELyraNPCNeedType) at the last update; read values through the
+	// functions below. Call CatchUp after writing them directly. While batched they are stale and only
+	// read by ResumeSimulationFrom.
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Needs")
+	TArray<float> NeedValues;
 
-	// Time scale for need decay (1.0 = real time, 24.0 = 1 game day = 1 real hour)
+	// Change per world second each need type gets from active modifiers, indexed like NeedValues
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Needs")
+	TArray<float> ModifierRates;
+
+	// Decay at TimeScale instead of the world subsystem's global time scale
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Needs|Settings")
+	bool bOverrideTimeScale = false;
+
+	// Time scale for need decay (1.0 = real time, 24.0 = 1 game day = 1 real hour).
+	// Only used with bOverrideTimeScale or when there is no world subsystem.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Needs|Settings", meta = (EditCondition = "bOverrideTimeScale"))
 	float TimeScale = 24.0f;
 
 	// Whether needs are currently being simulated
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Needs|Settings")
 	bool bSimulateNeeds = true;
 
-	// Events
+	// Events, fired once when a need drops to its threshold and again only after it recovered above it
 	UPROPERTY(BlueprintAssignable, Category = "Needs|Events")
 	FOnNPCNeedCritical OnNeedCritical;
 
+	UPROPERTY(BlueprintAssignable, Category = "Needs|Events")
+	FOnNPCNeedUrgent OnNeedUrgent;
+
+	// Native event fired whenever the wellbeing trend changes (a need was modified or reached zero);
+	// the world subsystem uses it to keep population stats current
+	FOnNPCWellbeingChangedNative OnWellbeingChangedNative;
+
 public:
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	// Stores the current values as the new base and picks up changes to the profile, bSimulateNeeds,
+	// bOverrideTimeScale and TimeScale. Call it after changing those directly.
+	UFUNCTION(BlueprintCallable, Category = "Needs")
+	void CatchUp();
+
+	// Makes the next update cover the time since WorldTime and GameHours (on the subsystem's clock) and
+	// re-arms every threshold, e.g. when restoring a virtualized NPC. Stores NeedValues as the values then.
+	void ResumeSimulationFrom(double WorldTime, double GameHours);
+
+	// ===== BATCHED STORAGE =====
+
+	// Moves the stored values and base time into a slot of Batch, where they stay until detached
+	void AttachToBatch(FLyraNPCNeedsBatch& Batch);
+
+	// Copies the stored values and base time back from the batch
+	void DetachFromBatch();
+
+	bool IsBatched() const { return NeedsBatch != nullptr; }
+
+	// NeedValues with every value evaluated now, e.g. for a virtual record
+	TArray<float> GetCurrentValues() const;
 
-	// Initialize with default needs for archetype
+	// Wellbeing change per world second and per game hour until the next need reaches zero or full, or is modified
+	void GetWellbeingRates(float& OutPerSecond, float& OutPerGameHour) const;
+
+	// Start fresh values from Profile, or from the default profile for Archetype when Profile is unset
 	UFUNCTION(BlueprintCallable, Category = "Needs")
 	void InitializeDefaultNeeds(ELyraNPCArchetype Archetype = ELyraNPCArchetype::Villager);
 
+	// Switch to another profile (null for the archetype default) and start fresh values from it
+	UFUNCTION(BlueprintCallable, Category = "Needs")
+	void SetProfile(ULyraNPCNeedsProfile* NewProfile);
+
+	// Profile the needs currently follow
+	UFUNCTION(BlueprintPure, Category = "Needs")
+	ULyraNPCNeedsProfile* GetActiveProfile() const { return ActiveProfile; }
+
 	// Get a specific need
 	UFUNCTION(BlueprintPure, Category = "Needs")
 	FLyraNPCNeedState GetNeed(ELyraNPCNeedType NeedType) const;
@@ -59,7 +128,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Needs")
 	void SatisfyNeed(ELyraNPCNeedType NeedType, float Amount);
 
-	// Queries
+	// Queries, answered from state cached at the last change or threshold crossing
 	UFUNCTION(BlueprintPure, Category = "Needs")
 	bool HasCriticalNeed() const;
 
@@ -80,14 +149,162 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Needs")
 	TArray<ELyraNPCNeedType> GetNeedsBelowThreshold(float Threshold = 50.0f) const;
 
+	// Time scale needs currently decay at
+	UFUNCTION(BlueprintPure, Category = "Needs|Settings")
+	float GetEffectiveTimeScale() const;
+
+	// ===== RATE MODIFIERS =====
+
+	// Changes a need by ValuePerMinute every world minute on top of its decay until removed, e.g. while
+	// the NPC uses a task. Returns a handle for RemoveNeedModifier.
+	UFUNCTION(BlueprintCallable, Category = "Needs|Modifiers")
+	int32 AddNeedModifier(ELyraNPCNeedType NeedType, float ValuePerMinute);
+
+	UFUNCTION(BlueprintCallable, Category = "Needs|Modifiers")
+	void RemoveNeedModifier(int32 Handle);
+
+	// ===== THRESHOLD EVENTS =====
+
+	// Called by the world subsystem when the predicted threshold crossing is due
+	void HandleScheduledEvent();
+
+	// Whether crossings are predicted on the subsystem's game clock, where a new time scale does not move
+	// them. Otherwise they are predicted in world seconds.
+	bool AreEventsOnGameClock() const { return bDecayOnGameClock && !bHasModifierRates; }
+
+	// Drops the pending crossing, e.g. while the NPC is pooled; the next update schedules a new one
+	void CancelScheduledEvent() { ++ScheduledEventSerial; }
+
+	// Identifies the crossing last scheduled; earlier ones the subsystem still holds are stale
+	uint32 GetScheduledEventSerial() const { return ScheduledEventSerial; }
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	UFUNCTION()
+	void OnRep_Needs();
+
+	// The stored line, sent only when it changes; clients move along it on their own
+	UPROPERTY(ReplicatedUsing = OnRep_Needs)
+	FLyraNPCReplicatedNeeds ReplicatedNeeds;
+
 private:
-	void UpdateNeeds(float DeltaTime);
-	void CheckCriticalNeeds();
+	friend class FLyraNPCNeedsBatch;
+
+	// The stored line, read from the needs batch while attached and from NeedValues and SimulationClock otherwise
+	float GetStoredValue(int32 Type) const;
+	void SetStoredValue(int32 Type, float NewValue);
+	double GetBaseTime() const;
+	double GetBaseGameHours() const;
+	void SetBase(double WorldTime, double GameHours);
+
+	// Copies NeedValues into the batch when attached, after they were written directly
+	void StoreNeedValues();
+
+	// Moves the base to now on both clocks without touching the values
+	void SetBaseToNow();
+
+	// World seconds since the last update, and game hours decayed through since it
+	float GetSecondsSinceUpdate() const;
+	float GetHoursSinceUpdate() const;
+
+	// Elapsed game hours on the subsystem's clock, 0 without a subsystem
+	double GetGameClockHours() const;
+
+	// Picks the clock decay follows from the settings and whether any modifier is active
+	void RefreshClock();
+
+	// Change of a need per world second (modifiers, and decay when it runs at its own time scale) and per
+	// game hour (decay along the subsystem's clock)
+	float GetRatePerSecond(const FLyraNPCNeedDefinition& Need) const;
+	float GetRatePerHour(const FLyraNPCNeedDefinition& Need) const;
+
+	// Both rates combined per unit of the clock events are predicted on (see AreEventsOnGameClock)
+	float GetNetRate(const FLyraNPCNeedDefinition& Need) const;
+
+	// Value of a need now, moved from its stored value along its net rate since the last update
+	float GetCurrentValue(const FLyraNPCNeedDefinition& Need) const;
+
+	// Points ActiveProfile at Profile or the archetype default and sizes NeedValues and ModifierRates
+	void ResolveProfile();
+
+	// Picks starting values from the profile and starts a new decay line with every threshold armed
+	void ResetValues();
+
+	// Sums NeedModifiers into ModifierRates
+	void RebuildModifierRates();
+
+	// Moves NeedValues and the base time to now along the current rates. Only done when the line
+	// changes, since every call is sent to clients.
+	void Materialize();
+
+	// Copies the stored line into ReplicatedNeeds on the server; unchanged lines are not resent
+	void UpdateReplicatedNeeds();
+
+	// Fires threshold events, reports wellbeing and schedules the next crossing after values changed
+	void OnNeedsChanged();
+	void CheckThresholds();
+	void ScheduleNextEvent(float MaxTime);
+	void NotifyWellbeingChanged();
+
+	// Caches the highest priority need and returns the time (on the event clock) until another one overtakes it
+	float UpdateMostUrgentNeed();
+
+	// Priority of a need at the given value, and how fast it grows per unit of the event clock from there
+	static float GetUrgencyMultiplier(const FLyraNPCNeedDefinition& Need, float Value);
+	static float GetPriorityAtValue(const FLyraNPCNeedDefinition& Need, float Value);
+	float GetPriorityGrowthAtValue(const FLyraNPCNeedDefinition& Need, float Value) const;
+
+	// Entries of the active profile; a type listed twice is skipped after its first entry through FindNeed
+	const TArray<FLyraNPCNeedDefinition>& GetDefinitions() const;
+	const FLyraNPCNeedDefinition* FindNeed(ELyraNPCNeedType NeedType) const;
+
+#if WITH_EDITOR
+	// Settles values under the old rates before a profile edit and rebalances after it
+	void HandleProfileEdited(bool bFinished);
+
+	FDelegateHandle ProfileEditedHandle;
+#endif
+
+	UPROPERTY(Transient)
+	TObjectPtr<ULyraNPCNeedsProfile> ActiveProfile;
+
+	TWeakObjectPtr<ULyraNPCWorldSubsystem> WorldSubsystem;
+
+	// Base of the stored values in world time and on the subsystem's game clock while not batched
+	FLyraNPCSimulationClock SimulationClock;
+	double BaseGameHours = 0.0;
+
+	// Batch holding the stored line and this component's slot in it, when attached
+	FLyraNPCNeedsBatch* NeedsBatch = nullptr;
+	int32 NeedsBatchSlot = INDEX_NONE;
+
+	// Set by RefreshClock: decay follows the subsystem's game clock, or runs at HoursPerSecond game hours
+	// per world second (own time scale or no subsystem; 0 while not simulating)
+	bool bDecayOnGameClock = false;
+	float HoursPerSecond = 0.0f;
+
+	// Any need has a modifier rate, which runs on world time
+	bool bHasModifierRates = false;
+
+	// One bit per need type at or below its urgent or critical threshold. Events fire when a bit gets set.
+	uint32 UrgentMask = 0;
+	uint32 CriticalMask = 0;
+
+	ELyraNPCNeedType MostUrgentNeed = ELyraNPCNeedType::Hunger;
+
+	uint32 ScheduledEventSerial = 0;
+
+	// Modifiers behind ModifierRates, so removing one restores the exact sum of the rest
+	struct FNeedModifier
+	{
+		int32 Handle;
+		ELyraNPCNeedType NeedType;
+		float PerSecond;
+	};
 
-	FLyraNPCNeedState* FindNeed(ELyraNPCNeedType NeedType);
-	const FLyraNPCNeedState* FindNeed(ELyraNPCNeedType NeedType) const;
+	TArray<FNeedModifier> NeedModifiers;
+	int32 NextModifierHandle = 0;
 };
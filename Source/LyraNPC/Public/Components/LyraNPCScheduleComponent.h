@@ -5,8 +5,11 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Core/LyraNPCTypes.h"
+#include "Core/LyraNPCSimulationClock.h"
 #include "LyraNPCScheduleComponent.generated.h"
 
+class ULyraNPCWorldSubsystem;
+
 /**
  * Component that manages NPC daily schedules and routines.
  * NPCs follow time-based schedules for work, rest, meals, etc.
@@ -23,11 +26,19 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Schedule")
 	TArray<FLyraNPCScheduleBlock> DailySchedule;
 
-	// Current game hour (0-24)
+	// Read the hour from the world subsystem's clock instead of keeping a local one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Schedule|Time")
+	bool bUseGlobalClock = true;
+
+	// Hours added to the global clock for this NPC (e.g. a night-shift worker)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Schedule|Time")
+	float GameHourOffset = 0.0f;
+
+	// Local clock (0-24), only advanced when bUseGlobalClock is off or there is no world subsystem
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Schedule|Time")
 	float CurrentGameHour = 6.0f;
 
-	// Time scale (how fast game time passes relative to real time)
+	// Time scale of the local clock (how fast game time passes relative to real time)
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Schedule|Time")
 	float TimeScale = 24.0f; // 1 real hour = 1 game day
 
@@ -46,6 +57,14 @@ public:
 public:
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+	// Advances the local clock and current schedule block over the time since the last update in one closed-form step.
+	// The NPC calls this when it is promoted out of a low AI LOD.
+	UFUNCTION(BlueprintCallable, Category = "Schedule")
+	void CatchUp();
+
+	// Makes the next update cover the time since WorldTime, e.g. when restoring a virtualized NPC
+	void ResumeSimulationFrom(double WorldTime) { SimulationClock.LastTime = WorldTime; }
+
 	// Initialize with default schedule for archetype
 	UFUNCTION(BlueprintCallable, Category = "Schedule")
 	void InitializeDefaultSchedule(ELyraNPCArchetype Archetype = ELyraNPCArchetype::Villager);
@@ -76,7 +95,7 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Schedule")
 	bool ShouldBeEating() const;
 
-	// Time management
+	// Time management. On the global clock these shift GameHourOffset, so only this NPC is affected.
 	UFUNCTION(BlueprintCallable, Category = "Schedule|Time")
 	void SetGameHour(float NewHour);
 
@@ -84,7 +103,7 @@ public:
 	void AdvanceTime(float Hours);
 
 	UFUNCTION(BlueprintPure, Category = "Schedule|Time")
-	float GetCurrentGameHour() const { return CurrentGameHour; }
+	float GetCurrentGameHour() const;
 
 	UFUNCTION(BlueprintPure, Category = "Schedule|Time")
 	bool IsNightTime() const;
@@ -104,8 +123,15 @@ protected:
 	virtual void BeginPlay() override;
 
 private:
+	// Null when the local clock is in use
+	const ULyraNPCWorldSubsystem* GetClock() const;
+
 	void UpdateGameTime(float DeltaTime);
 	void UpdateCurrentScheduleBlock();
 
+	FLyraNPCSimulationClock SimulationClock;
+
 	FLyraNPCScheduleBlock FindScheduleBlockForHour(float Hour) const;
+
+	TWeakObjectPtr<ULyraNPCWorldSubsystem> WorldSubsystem;
 };
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Core/LyraNPCTypes.h"
+#include "Core/LyraNPCSimulationClock.h"
 #include "LyraNPCSocialComponent.generated.h"
 
 class ALyraNPCCharacter;
@@ -40,6 +41,14 @@ public:
 public:
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+	// Advances relationship decay over the time since the last update in one closed-form step.
+	// The NPC calls this when it is promoted out of a low AI LOD.
+	UFUNCTION(BlueprintCallable, Category = "Social")
+	void CatchUp();
+
+	// Makes the next update cover the time since WorldTime, e.g. when restoring a virtualized NPC
+	void ResumeSimulationFrom(double WorldTime) { SimulationClock.LastTime = WorldTime; }
+
 	// ===== RELATIONSHIP MANAGEMENT =====
 
 	UFUNCTION(BlueprintCallable, Category = "Social|Relationships")
@@ -128,4 +137,8 @@ private:
 	void DecayRelationships(float DeltaTime);
 
 	float TimeSinceLastDecay = 0.0f;
+
+	// Decay runs once TimeSinceLastDecay reaches this; the first wait is a per-NPC phase of the minute
+	float NextDecayAfter = 60.0f;
+	FLyraNPCSimulationClock SimulationClock;
 };
@@ -13,6 +13,7 @@ class ULyraNPCNeedsComponent;
 class ULyraNPCScheduleComponent;
 class ULyraNPCPathFollowingComponent;
 class ULyraNPCSocialComponent;
+class ULyraNPCRailMovementComponent;
 
 /**
  * Base character class for LyraNPC.
@@ -47,6 +48,9 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "LyraNPC|Components")
 	TObjectPtr<ULyraNPCSocialComponent> SocialComponent;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "LyraNPC|Components")
+	TObjectPtr<ULyraNPCRailMovementComponent> RailMovementComponent;
+
 	// ===== CONFIGURATION =====
 
 	// Initial archetype for this NPC
@@ -69,7 +73,14 @@ public:
 	// ===== LIFECYCLE =====
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
+	virtual void PossessedBy(AController* NewController) override;
+	virtual void UnPossessed() override;
+
+	// Handle into the world subsystem's NPC registry (unset while unregistered)
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
+	FLyraNPCHandle GetNPCHandle() const { return RegistryHandle; }
 
 	// ===== INITIALIZATION =====
 
@@ -113,11 +124,44 @@ public:
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Combat")
 	float GetHealthPercent() const;
 
+	// ===== AI LOD =====
+
+	// Sets tick enabled and interval for the character, its movement and its LyraNPC components.
+	// IntervalScale stretches every interval (the frame governor raises it under load).
+	void ApplyLODTickProfile(const FLyraNPCLODTickProfile& Profile, float IntervalScale = 1.0f);
+
+	// Brings needs, schedule, memory, alertness and relationships up to date in one step after the
+	// components ticked coarsely or not at all. Called automatically on AI LOD promotion.
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|LOD")
+	void CatchUpSimulation();
+
+	// ===== VIRTUALIZATION =====
+
+	// Copies the state kept while the NPC exists only as data in the world subsystem
+	void WriteVirtualRecord(FLyraNPCVirtualRecord& OutRecord) const;
+
+	// Restores state from a record, replacing whatever this actor held. Call before BeginPlay
+	// (deferred spawn) or on a pooled actor that is not registered with the subsystem.
+	void ReadVirtualRecord(const FLyraNPCVirtualRecord& Record);
+
+	// ===== PLAYER INTERACTION =====
+
+	// Call when a player talks to, trades with or otherwise engages this NPC; feeds significance LOD
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Interaction")
+	void NotifyPlayerInteraction();
+
+	// Seconds since the last player interaction, or MAX_FLT if there has been none
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Interaction")
+	float GetTimeSincePlayerInteraction() const;
+
 	// ===== MOVEMENT STYLE =====
 
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Movement")
 	void SetMovementStyle(ELyraNPCMovementStyle Style);
 
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Movement")
+	ELyraNPCMovementStyle GetMovementStyle() const { return MovementStyle; }
+
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Movement")
 	float GetMovementSpeedForStyle(ELyraNPCMovementStyle Style) const;
 
@@ -128,5 +172,17 @@ protected:
 	void OnDeath();
 
 private:
+	friend class ULyraNPCWorldSubsystem;
+
+	// Assigned by ULyraNPCWorldSubsystem on registration
+	UPROPERTY(VisibleInstanceOnly, Transient, Category = "LyraNPC|Management")
+	FLyraNPCHandle RegistryHandle;
+
+	// World time of the last NotifyPlayerInteraction, negative if none
+	double LastPlayerInteractionTime = -1.0;
+
+	// Last style passed to SetMovementStyle
+	ELyraNPCMovementStyle MovementStyle = ELyraNPCMovementStyle::Walk;
+
 	void ApplyCognitiveSkillToMovement();
 };
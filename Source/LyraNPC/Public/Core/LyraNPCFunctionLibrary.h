@@ -5,11 +5,11 @@
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "Core/LyraNPCTypes.h"
+#include "Systems/LyraNPCWorldSubsystem.h"
 #include "LyraNPCFunctionLibrary.generated.h"
 
 class ALyraNPCCharacter;
 class ULyraNPCTaskActor;
-class ULyraNPCWorldSubsystem;
 
 /**
  * Blueprint Function Library for common LyraNPC operations.
@@ -43,6 +43,38 @@ public:
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Query", meta = (WorldContext = "WorldContextObject"))
 	static int32 GetTotalNPCCount(UObject* WorldContextObject);
 
+	// Native forms that reset and fill a caller-provided array instead of returning a new one
+
+	template<typename AllocatorType>
+	static void GetAllNPCs(UObject* WorldContextObject, TArray<ALyraNPCCharacter*, AllocatorType>& OutNPCs)
+	{
+		OutNPCs.Reset();
+		if (ULyraNPCWorldSubsystem* Subsystem = GetNPCWorldSubsystem(WorldContextObject))
+		{
+			Subsystem->GetAllNPCs(OutNPCs);
+		}
+	}
+
+	template<typename AllocatorType>
+	static void GetNPCsInRadius(UObject* WorldContextObject, const FVector& Location, float Radius, TArray<ALyraNPCCharacter*, AllocatorType>& OutNPCs)
+	{
+		OutNPCs.Reset();
+		if (ULyraNPCWorldSubsystem* Subsystem = GetNPCWorldSubsystem(WorldContextObject))
+		{
+			Subsystem->GetNPCsInRadius(Location, Radius, OutNPCs);
+		}
+	}
+
+	template<typename AllocatorType>
+	static void GetNPCsByArchetype(UObject* WorldContextObject, ELyraNPCArchetype Archetype, TArray<ALyraNPCCharacter*, AllocatorType>& OutNPCs)
+	{
+		OutNPCs.Reset();
+		if (ULyraNPCWorldSubsystem* Subsystem = GetNPCWorldSubsystem(WorldContextObject))
+		{
+			Subsystem->GetNPCsByArchetype(Archetype, OutNPCs);
+		}
+	}
+
 	// ===== TIME MANAGEMENT =====
 
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Time", meta = (WorldContext = "WorldContextObject"))
@@ -62,6 +94,16 @@ public:
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Tasks", meta = (WorldContext = "WorldContextObject"))
 	static TArray<ULyraNPCTaskActor*> GetAllTasks(UObject* WorldContextObject);
 
+	template<typename AllocatorType>
+	static void GetAllTasks(UObject* WorldContextObject, TArray<ULyraNPCTaskActor*, AllocatorType>& OutTasks)
+	{
+		OutTasks.Reset();
+		if (ULyraNPCWorldSubsystem* Subsystem = GetNPCWorldSubsystem(WorldContextObject))
+		{
+			Subsystem->GetAllTasks(OutTasks);
+		}
+	}
+
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Tasks", meta = (WorldContext = "WorldContextObject"))
 	static ULyraNPCTaskActor* FindBestTaskForNPC(UObject* WorldContextObject, ALyraNPCCharacter* NPC, FGameplayTag TaskType);
 
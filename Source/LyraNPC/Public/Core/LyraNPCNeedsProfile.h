@@ -0,0 +1,52 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Core/LyraNPCTypes.h"
+#include "LyraNPCNeedsProfile.generated.h"
+
+#if WITH_EDITOR
+// Fired before (bFinished false) and after (bFinished true) a profile is edited, so NPCs using it can rebalance live
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnLyraNPCNeedsProfileEdited, bool /*bFinished*/);
+#endif
+
+/**
+ * Decay rates, weights and thresholds shared by every NPC using the profile; NPCs only store their
+ * current values. Edits apply to NPCs already in play.
+ */
+UCLASS(BlueprintType)
+class LYRANPC_API ULyraNPCNeedsProfile : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Needs NPCs with this profile have. A type listed twice uses its first entry.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Needs", meta = (TitleProperty = "NeedType"))
+	TArray<FLyraNPCNeedDefinition> Needs;
+
+	// Definition for a need type, or null if the profile lacks it
+	const FLyraNPCNeedDefinition* FindNeed(ELyraNPCNeedType NeedType) const;
+
+	// Transient profile with the built-in defaults for an archetype, used when the project assigns none
+	static ULyraNPCNeedsProfile* CreateBuiltIn(UObject* Outer, ELyraNPCArchetype Archetype);
+
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PreEditChange(FProperty* PropertyAboutToChange) override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PreEditUndo() override;
+	virtual void PostEditUndo() override;
+
+	FOnLyraNPCNeedsProfileEdited OnEdited;
+#endif
+
+private:
+	void RebuildSlots();
+
+	// Index into Needs per need type, INDEX_NONE for types the profile lacks
+	int8 Slots[static_cast<int32>(ELyraNPCNeedType::MAX)];
+};
@@ -0,0 +1,111 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "Core/LyraNPCTypes.h"
+#include "LyraNPCSettings.generated.h"
+
+class ULyraNPCNeedsProfile;
+
+/**
+ * Project-wide LyraNPC settings (Project Settings > Plugins > LyraNPC).
+ * Budgets can be overridden per platform in that platform's Game.ini, e.g.
+ * Config/Android/AndroidGame.ini under [/Script/LyraNPC.LyraNPCSettings].
+ */
+UCLASS(config = Game, defaultconfig, meta = (DisplayName = "LyraNPC"))
+class LYRANPC_API ULyraNPCSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	ULyraNPCSettings();
+
+	virtual FName GetCategoryName() const override { return TEXT("Plugins"); }
+
+	// Tick profile for an AI LOD (Dormant for anything out of range)
+	const FLyraNPCLODTickProfile& GetTickProfile(ELyraNPCAILOD LOD) const;
+
+	// Needs profile for NPCs of an archetype without their own: the one assigned below, or the built-in defaults
+	ULyraNPCNeedsProfile* GetDefaultNeedsProfile(ELyraNPCArchetype Archetype) const;
+
+	// ===== SIGNIFICANCE LOD =====
+
+	// Rank NPCs by significance and hand out AI LODs from fixed budgets, so the number of Full NPCs
+	// is capped however dense the crowd. Distance bands still apply on top.
+	UPROPERTY(config, EditAnywhere, Category = "Significance LOD")
+	bool bUseSignificanceLOD = false;
+
+	// Most NPCs at Full AI at once
+	UPROPERTY(config, EditAnywhere, Category = "Significance LOD", meta = (ClampMin = "0", EditCondition = "bUseSignificanceLOD"))
+	int32 MaxFullLODNPCs = 32;
+
+	// Most NPCs at Reduced AI at once
+	UPROPERTY(config, EditAnywhere, Category = "Significance LOD", meta = (ClampMin = "0", EditCondition = "bUseSignificanceLOD"))
+	int32 MaxReducedLODNPCs = 64;
+
+	// Most NPCs at Minimal AI at once; everyone beyond the budgets is Dormant
+	UPROPERTY(config, EditAnywhere, Category = "Significance LOD", meta = (ClampMin = "0", EditCondition = "bUseSignificanceLOD"))
+	int32 MaxMinimalLODNPCs = 128;
+
+	// Distance from the nearest viewer at which the distance term drops to zero
+	UPROPERTY(config, EditAnywhere, Category = "Significance LOD", meta = (ClampMin = "1.0", EditCondition = "bUseSignificanceLOD"))
+	float SignificanceDistance = 10000.0f;
+
+	// Significance of an NPC standing on a viewer
+	UPROPERTY(config, EditAnywhere, Category = "Significance LOD", meta = (ClampMin = "0.0", EditCondition = "bUseSignificanceLOD"))
+	float DistanceWeight = 1.0f;
+
+	// Added per alert level above Unaware
+	UPROPERTY(config, EditAnywhere, Category = "Significance LOD", meta = (ClampMin = "0.0", EditCondition = "bUseSignificanceLOD"))
+	float AlertLevelWeight = 0.25f;
+
+	// Added while the NPC is in combat
+	UPROPERTY(config, EditAnywhere, Category = "Significance LOD", meta = (ClampMin = "0.0", EditCondition = "bUseSignificanceLOD"))
+	float CombatBonus = 2.0f;
+
+	// Added right after a player interacted with the NPC, fading out over PlayerInteractionMemory
+	UPROPERTY(config, EditAnywhere, Category = "Significance LOD", meta = (ClampMin = "0.0", EditCondition = "bUseSignificanceLOD"))
+	float PlayerInteractionBonus = 1.5f;
+
+	// Seconds a player interaction keeps boosting significance
+	UPROPERTY(config, EditAnywhere, Category = "Significance LOD", meta = (ClampMin = "0.0", EditCondition = "bUseSignificanceLOD"))
+	float PlayerInteractionMemory = 30.0f;
+
+	// ===== LOD TICK PROFILES =====
+
+	// Apply the profiles below to an NPC's character, movement and LyraNPC components whenever its AI LOD changes
+	UPROPERTY(config, EditAnywhere, Category = "LOD Tick Profiles")
+	bool bApplyLODTickProfiles = true;
+
+	UPROPERTY(config, EditAnywhere, Category = "LOD Tick Profiles", meta = (EditCondition = "bApplyLODTickProfiles"))
+	FLyraNPCLODTickProfile FullTickProfile;
+
+	UPROPERTY(config, EditAnywhere, Category = "LOD Tick Profiles", meta = (EditCondition = "bApplyLODTickProfiles"))
+	FLyraNPCLODTickProfile ReducedTickProfile;
+
+	UPROPERTY(config, EditAnywhere, Category = "LOD Tick Profiles", meta = (EditCondition = "bApplyLODTickProfiles"))
+	FLyraNPCLODTickProfile MinimalTickProfile;
+
+	UPROPERTY(config, EditAnywhere, Category = "LOD Tick Profiles", meta = (EditCondition = "bApplyLODTickProfiles"))
+	FLyraNPCLODTickProfile DormantTickProfile;
+
+	// ===== RAIL MOVEMENT =====
+
+	// Slide Minimal-LOD NPCs along their navmesh path with character movement off (no physics or floor
+	// sweeps); full movement resumes from wherever they are on promotion
+	UPROPERTY(config, EditAnywhere, Category = "Rail Movement")
+	bool bUseRailMovementAtMinimalLOD = true;
+
+	// ===== NEEDS =====
+
+	// Needs profile per archetype for NPCs that do not set one; archetypes missing here use the built-in defaults
+	UPROPERTY(config, EditAnywhere, Category = "Needs")
+	TMap<ELyraNPCArchetype, TSoftObjectPtr<ULyraNPCNeedsProfile>> DefaultNeedsProfiles;
+
+private:
+	// Built-in profiles, created once per archetype on first use
+	UPROPERTY(Transient)
+	mutable TMap<ELyraNPCArchetype, TObjectPtr<ULyraNPCNeedsProfile>> BuiltInNeedsProfiles;
+};
@@ -0,0 +1,37 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+
+/**
+ * World time a component has simulated up to. Updates advance by the real gap since the last one,
+ * so state stays correct however coarsely the component ticked, or whether it ticked at all.
+ */
+struct FLyraNPCSimulationClock
+{
+	// World seconds simulated up to, negative before the clock has started
+	double LastTime = -1.0;
+
+	bool IsRunning() const { return LastTime >= 0.0; }
+
+	void Start(const UWorld* World)
+	{
+		if (World && !IsRunning())
+		{
+			LastTime = World->GetTimeSeconds();
+		}
+	}
+
+	// Seconds since the last call (0 if the clock has not started) and moves the clock to now
+	float Advance(const UWorld* World)
+	{
+		if (!World) return 0.0f;
+
+		const double Now = World->GetTimeSeconds();
+		const float Elapsed = IsRunning() ? static_cast<float>(FMath::Max(Now - LastTime, 0.0)) : 0.0f;
+		LastTime = Now;
+		return Elapsed;
+	}
+};
@@ -0,0 +1,33 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Misc/Crc.h"
+
+/**
+ * Hashed phase offsets for periodic NPC work. NPCs spawned on the same frame would otherwise run every
+ * interval-based update on the same frames; each object gets a stable phase that spreads them out.
+ */
+namespace LyraNPCTickStagger
+{
+	// Stable phase in [0, 1) for an object; Salt gives unrelated periodic jobs on one object different phases
+	inline float GetPhase(const UObject* Object, uint32 Salt = 0)
+	{
+		if (!Object) return 0.0f;
+
+		const uint32 Id = Object->GetUniqueID();
+		return static_cast<float>(FCrc::MemCrc32(&Id, sizeof(Id), Salt) >> 8) / static_cast<float>(1 << 24);
+	}
+
+	// Sets a tick interval whose first tick lands Phase * Interval from now, then every Interval
+	inline void SetTickInterval(FTickFunction& TickFunction, float Interval, float Phase)
+	{
+		if (Interval > 0.0f && TickFunction.IsTickFunctionRegistered())
+		{
+			TickFunction.UpdateTickIntervalAndCoolDown(FMath::Max(Interval * Phase, KINDA_SMALL_NUMBER));
+		}
+		TickFunction.TickInterval = Interval;
+	}
+}
@@ -4,11 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "GameplayTagContainer.h"
+#include "Templates/SubclassOf.h"
 #include "LyraNPCTypes.generated.h"
 
 // Forward declarations
 class ULyraNPCTaskActor;
 class ALyraNPCCharacter;
+class ULyraNPCNeedsProfile;
 
 /**
  * AI Level of Detail - determines how much processing an NPC receives
@@ -37,7 +39,8 @@ enum class ELyraNPCArchetype : uint8
 	Enemy		UMETA(DisplayName = "Enemy", ToolTip = "Hostile NPC"),
 	Neutral		UMETA(DisplayName = "Neutral", ToolTip = "Non-aligned NPC"),
 	Companion	UMETA(DisplayName = "Companion", ToolTip = "Follower NPC"),
-	Custom		UMETA(DisplayName = "Custom", ToolTip = "User-defined archetype")
+	Custom		UMETA(DisplayName = "Custom", ToolTip = "User-defined archetype"),
+	MAX			UMETA(Hidden)
 };
 
 /**
@@ -57,7 +60,8 @@ enum class ELyraNPCLifeState : uint8
 	Fleeing		UMETA(DisplayName = "Fleeing"),
 	Investigating UMETA(DisplayName = "Investigating"),
 	UsingTask	UMETA(DisplayName = "Using Task"),
-	Dead		UMETA(DisplayName = "Dead")
+	Dead		UMETA(DisplayName = "Dead"),
+	MAX			UMETA(Hidden)
 };
 
 /**
@@ -125,7 +129,8 @@ enum class ELyraNPCAlertLevel : uint8
 	Curious		UMETA(DisplayName = "Curious", ToolTip = "Something caught attention"),
 	Suspicious	UMETA(DisplayName = "Suspicious", ToolTip = "Potential threat detected"),
 	Alert		UMETA(DisplayName = "Alert", ToolTip = "Confirmed threat, preparing response"),
-	Combat		UMETA(DisplayName = "Combat", ToolTip = "Actively engaged in combat")
+	Combat		UMETA(DisplayName = "Combat", ToolTip = "Actively engaged in combat"),
+	MAX			UMETA(Hidden)
 };
 
 /**
@@ -187,7 +192,7 @@ struct LYRANPC_API FLyraNPCScheduleBlock
 };
 
 /**
- * Single Need State
+ * Single Need State - a need's definition together with its current value
  */
 USTRUCT(BlueprintType)
 struct LYRANPC_API FLyraNPCNeedState
@@ -218,6 +223,61 @@ struct LYRANPC_API FLyraNPCNeedState
 	float CriticalThreshold = 10.0f;
 };
 
+/**
+ * Need Definition - the part of a need shared by every NPC using a needs profile
+ */
+USTRUCT(BlueprintType)
+struct LYRANPC_API FLyraNPCNeedDefinition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Need")
+	ELyraNPCNeedType NeedType = ELyraNPCNeedType::Hunger;
+
+	// Range the value is picked from when an NPC's needs are initialized
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Need", meta = (ClampMin = "0.0", ClampMax = "100.0"))
+	float InitialValueMin = 100.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Need", meta = (ClampMin = "0.0", ClampMax = "100.0"))
+	float InitialValueMax = 100.0f;
+
+	// Rate of decay per hour
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Need")
+	float DecayRatePerHour = 4.0f;
+
+	// Priority weight when selecting actions
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Need")
+	float PriorityWeight = 1.0f;
+
+	// Below this threshold, need becomes urgent
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Need")
+	float UrgentThreshold = 25.0f;
+
+	// Below this threshold, need becomes critical
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Need")
+	float CriticalThreshold = 10.0f;
+};
+
+/**
+ * Needs as the server last stored them, from which clients evaluate current values themselves
+ */
+USTRUCT()
+struct LYRANPC_API FLyraNPCReplicatedNeeds
+{
+	GENERATED_BODY()
+
+	// Value and modifier rate per need type at BaseTime
+	UPROPERTY()
+	TArray<float> Values;
+
+	UPROPERTY()
+	TArray<float> ModifierRates;
+
+	// Server world time the values were stored at
+	UPROPERTY()
+	double BaseTime = 0.0;
+};
+
 /**
  * Relationship Entry
  */
@@ -486,9 +546,239 @@ struct LYRANPC_API FLyraNPCPerceptionResult
 	float Confidence = 1.0f;
 };
 
+/**
+ * NPC Handle
+ * Generational handle into the world subsystem's NPC registry. Stays invalid once the NPC unregisters.
+ */
+USTRUCT(BlueprintType)
+struct LYRANPC_API FLyraNPCHandle
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Index = INDEX_NONE;
+
+	UPROPERTY()
+	int32 Generation = 0;
+
+	bool IsSet() const { return Index != INDEX_NONE; }
+	void Reset() { Index = INDEX_NONE; Generation = 0; }
+
+	bool operator==(const FLyraNPCHandle& Other) const { return Index == Other.Index && Generation == Other.Generation; }
+	bool operator!=(const FLyraNPCHandle& Other) const { return !(*this == Other); }
+
+	friend uint32 GetTypeHash(const FLyraNPCHandle& Handle)
+	{
+		return HashCombine(::GetTypeHash(Handle.Index), ::GetTypeHash(Handle.Generation));
+	}
+};
+
+/**
+ * Task Handle
+ * Generational handle into the world subsystem's task registry.
+ */
+USTRUCT(BlueprintType)
+struct LYRANPC_API FLyraNPCTaskHandle
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Index = INDEX_NONE;
+
+	UPROPERTY()
+	int32 Generation = 0;
+
+	bool IsSet() const { return Index != INDEX_NONE; }
+	void Reset() { Index = INDEX_NONE; Generation = 0; }
+
+	bool operator==(const FLyraNPCTaskHandle& Other) const { return Index == Other.Index && Generation == Other.Generation; }
+	bool operator!=(const FLyraNPCTaskHandle& Other) const { return !(*this == Other); }
+
+	friend uint32 GetTypeHash(const FLyraNPCTaskHandle& Handle)
+	{
+		return HashCombine(::GetTypeHash(Handle.Index), ::GetTypeHash(Handle.Generation));
+	}
+};
+
+/**
+ * Task Query Stats
+ * Counts how many candidate tasks the indexed task queries had to examine.
+ */
+USTRUCT(BlueprintType)
+struct LYRANPC_API FLyraNPCTaskQueryStats
+{
+	GENERATED_BODY()
+
+	// Number of indexed task queries run
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	int32 NumQueries = 0;
+
+	// Candidates examined across all queries
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	int64 TotalCandidatesExamined = 0;
+
+	// Candidates examined by the most recent query
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	int32 LastQueryCandidates = 0;
+
+	// Most candidates examined by a single query
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	int32 MaxQueryCandidates = 0;
+
+	float GetAverageCandidates() const { return NumQueries > 0 ? static_cast<float>(TotalCandidatesExamined) / NumQueries : 0.0f; }
+};
+
+/**
+ * Task Assignment Stats - results of the subsystem's task assignment phase.
+ */
+USTRUCT(BlueprintType)
+struct LYRANPC_API FLyraNPCTaskAssignmentStats
+{
+	GENERATED_BODY()
+
+	// Assignment batches solved
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	int32 NumRounds = 0;
+
+	// Searches that went through assignment
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	int32 NumRequests = 0;
+
+	// Searches answered with a task already reserved for the NPC
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	int32 NumAssigned = 0;
+
+	// NPCs whose independent best pick was already taken by others in the same batch;
+	// each would have failed Reserve and searched again
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	int32 NumRequeriesAvoided = 0;
+};
+
+/**
+ * Tick Setting - how one tick function runs at a given AI LOD.
+ */
+USTRUCT(BlueprintType)
+struct LYRANPC_API FLyraNPCTickSetting
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick")
+	bool bTickEnabled = true;
+
+	// Seconds between ticks; 0 ticks every frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick", meta = (ClampMin = "0.0", EditCondition = "bTickEnabled"))
+	float TickInterval = 0.0f;
+
+	FLyraNPCTickSetting() = default;
+	FLyraNPCTickSetting(bool bInTickEnabled, float InTickInterval) : bTickEnabled(bInTickEnabled), TickInterval(InTickInterval) {}
+};
+
+/**
+ * LOD Tick Profile - tick settings for an NPC character and its components at one AI LOD.
+ */
+USTRUCT(BlueprintType)
+struct LYRANPC_API FLyraNPCLODTickProfile
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick")
+	FLyraNPCTickSetting Character;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick")
+	FLyraNPCTickSetting CharacterMovement;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick")
+	FLyraNPCTickSetting Cognitive = FLyraNPCTickSetting(true, 0.1f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick")
+	FLyraNPCTickSetting Schedule = FLyraNPCTickSetting(true, 1.0f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick")
+	FLyraNPCTickSetting Social = FLyraNPCTickSetting(true, 10.0f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tick")
+	FLyraNPCTickSetting PathFollowing = FLyraNPCTickSetting(true, 0.1f);
+};
+
+/**
+ * Virtual Record - everything kept for an NPC while it exists only as data in the world subsystem.
+ */
+USTRUCT(BlueprintType)
+struct LYRANPC_API FLyraNPCVirtualRecord
+{
+	GENERATED_BODY()
+
+	// Class spawned when the NPC gets an actor again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual")
+	TSubclassOf<ALyraNPCCharacter> CharacterClass;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual")
+	FTransform Transform;
+
+	// ===== IDENTITY =====
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Identity")
+	FLyraNPCBiography Biography;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Identity")
+	ELyraNPCLifeState LifeState = ELyraNPCLifeState::Idle;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Identity")
+	FVector HomeLocation = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Identity")
+	FVector WorkplaceLocation = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Identity")
+	TMap<FGameplayTag, FVector> FavoritePlaces;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Identity")
+	float CognitiveSkill = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Identity")
+	FLyraNPCCombatStats CombatStats;
+
+	// ===== NEEDS / SCHEDULE / SOCIAL =====
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Needs")
+	TObjectPtr<ULyraNPCNeedsProfile> NeedsProfile;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Needs")
+	ELyraNPCArchetype NeedsProfileArchetype = ELyraNPCArchetype::Villager;
+
+	// Need values by need type as of VirtualizedAtTime and VirtualizedAtGameHours
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Needs")
+	TArray<float> NeedValues;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Schedule")
+	TArray<FLyraNPCScheduleBlock> DailySchedule;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Schedule")
+	bool bUseGlobalClock = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Schedule")
+	float GameHourOffset = 0.0f;
+
+	// Local clock, only used when bUseGlobalClock is off
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Schedule")
+	float LocalGameHour = 6.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Virtual|Social")
+	TArray<FLyraNPCRelationship> Relationships;
+
+	// Subsystem elapsed game hours when the record was taken
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Virtual")
+	double VirtualizedAtGameHours = 0.0;
+
+	// World time when the record was taken; the rehydrated NPC catches up from here
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Virtual")
+	double VirtualizedAtTime = 0.0;
+};
+
 // Delegate Declarations
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnNPCLifeStateChanged, ALyraNPCCharacter*, NPC, ELyraNPCLifeState, NewState);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnNPCNeedCritical, ALyraNPCCharacter*, NPC, ELyraNPCNeedType, NeedType);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnNPCNeedUrgent, ALyraNPCCharacter*, NPC, ELyraNPCNeedType, NeedType);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnNPCAILODChanged, ALyraNPCCharacter*, NPC, ELyraNPCAILOD, NewLOD);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnNPCAlertLevelChanged, ALyraNPCCharacter*, NPC, ELyraNPCAlertLevel, NewAlertLevel);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnNPCTaskStarted, ALyraNPCCharacter*, NPC, ULyraNPCTaskActor*, Task, float, Duration);
@@ -4,8 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "Stats/Stats.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogLyraNPC, Log, All);
+DECLARE_STATS_GROUP(TEXT("LyraNPC"), STATGROUP_LyraNPC, STATCAT_Advanced);
 
 class FLyraNPCModule : public IModuleInterface
 {
@@ -0,0 +1,65 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "AITypes.h"
+#include "LyraNPCRailMovementComponent.generated.h"
+
+class UPathFollowingComponent;
+
+/**
+ * Kinematic "rail" movement for Minimal AI LOD. While allowed, the active navmesh move of the owner's
+ * AI controller is paused and the capsule slides along the path polyline at the NPC's movement style
+ * speed with character movement switched off. Leaving the rail hands the move back to path following.
+ */
+UCLASS(ClassGroup=(LyraNPC), meta=(BlueprintSpawnableComponent, DisplayName="LyraNPC Rail Movement"))
+class LYRANPC_API ULyraNPCRailMovementComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	ULyraNPCRailMovementComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Set by the AI controller on LOD change; disallowing leaves the rail and restores character movement
+	void SetRailAllowed(bool bAllowed);
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Movement")
+	bool IsRailAllowed() const { return bRailAllowed; }
+
+	// True while a paused path following request is being driven along the rail
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Movement")
+	bool IsOnRail() const { return bFollowingRequest; }
+
+	// Lays a rail through Points (capsule locations) without touching path following or character movement
+	void StartRail(TArrayView<const FVector> Points, float Speed);
+	void ClearRail();
+
+	// Moves the owner DeltaTime further along the rail; false once it has reached the end
+	bool AdvanceRail(float DeltaTime);
+
+protected:
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	UPathFollowingComponent* GetPathFollowing() const;
+	bool TryEnterRail();
+	void LeaveRail();
+
+	// Rail polyline and the path distance at each point
+	TArray<FVector> RailPoints;
+	TArray<float> RailDistances;
+	float RailDistance = 0.0f;
+	float RailSpeed = 0.0f;
+	int32 RailSegment = 0;
+
+	// Request paused for the rail, and the last one the rail carried to its end
+	FAIRequestID RailRequestId = FAIRequestID::InvalidRequest;
+	FAIRequestID FinishedRequestId = FAIRequestID::InvalidRequest;
+
+	bool bRailAllowed = false;
+	bool bFollowingRequest = false;
+};
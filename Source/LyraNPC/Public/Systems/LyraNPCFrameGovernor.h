@@ -0,0 +1,74 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+/**
+ * Keeps LyraNPC's game-thread cost near a per-frame budget. Framework work is timed with
+ * LYRANPC_SCOPE_FRAME_COST against the governor of its world's subsystem; while the smoothed cost stays over budget the governor raises a pressure
+ * level that shrinks LOD distances, stretches tick intervals and defers non-critical work, and lowers
+ * it again once cost has stayed comfortably under budget.
+ */
+class LYRANPC_API FLyraNPCFrameGovernor
+{
+public:
+	// Adds its lifetime to this frame's LyraNPC cost in WorldContext's world. Nested scopes only count once.
+	struct LYRANPC_API FScopedCost
+	{
+		explicit FScopedCost(const UObject* WorldContext);
+		~FScopedCost();
+
+	private:
+		FLyraNPCFrameGovernor* Governor = nullptr;
+		uint64 StartCycles = 0;
+	};
+
+	// Milliseconds of LyraNPC work allowed per frame; 0 turns the governor off
+	float BudgetMs = 4.0f;
+
+	// Step down only while the smoothed cost is below this fraction of the budget
+	float RelaxFraction = 0.7f;
+
+	// Highest pressure level, and how much each level shrinks LOD distances and stretches tick intervals
+	int32 MaxLevel = 4;
+	float LODDistanceStep = 0.15f;
+	float TickIntervalStep = 0.5f;
+
+	// Level from which non-critical work is deferred
+	int32 DeferLevel = 2;
+
+	// Takes the cost measured since the last call and adjusts the level. Returns true if the level changed.
+	bool Tick(float DeltaTime);
+	void Reset();
+
+	// Adds measured cycles to this frame's cost, from any thread
+	void AddCost(uint64 Cycles) { FrameCycles.fetch_add(Cycles, std::memory_order_relaxed); }
+
+	int32 GetLevel() const { return Level; }
+	float GetLastFrameCostMs() const { return LastFrameCostMs; }
+	float GetSmoothedCostMs() const { return SmoothedCostMs; }
+
+	// Multiplier on LOD distance thresholds (below 1 under pressure)
+	float GetLODDistanceScale() const { return FMath::Max(1.0f - LODDistanceStep * Level, 0.1f); }
+
+	// Multiplier on tick intervals (above 1 under pressure)
+	float GetTickIntervalScale() const { return 1.0f + TickIntervalStep * Level; }
+
+	bool ShouldDeferNonCriticalWork() const { return Level > 0 && Level >= DeferLevel; }
+
+private:
+	// Cycles recorded by FScopedCost since the last Tick, from any thread
+	std::atomic<uint64> FrameCycles{ 0 };
+
+	int32 Level = 0;
+	float LastFrameCostMs = 0.0f;
+	float SmoothedCostMs = 0.0f;
+
+	// Seconds the smoothed cost has been over budget, or under the relax line, without a level change
+	float TimeOverBudget = 0.0f;
+	float TimeUnderBudget = 0.0f;
+};
+
+#define LYRANPC_SCOPE_FRAME_COST(WorldContext) FLyraNPCFrameGovernor::FScopedCost PREPROCESSOR_JOIN(LyraNPCFrameCost_, __LINE__)(WorldContext)
@@ -0,0 +1,145 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/LyraNPCTypes.h"
+
+class UWorld;
+class AActor;
+class ALyraNPCCharacter;
+class ALyraNPCAIController;
+class ULyraNPCSettings;
+
+/**
+ * Computes AI LOD for the whole NPC population on behalf of the controllers.
+ * LOD is measured from weighted view points: every player's view plus any registered extras.
+ * Each frame every viewer is stamped into the grid cells it can reach, so an NPC only reads the
+ * viewers listed in its own cell and cost grows with viewers + NPCs rather than their product.
+ * The population is evaluated round-robin so one full pass is spread over UpdatePeriod.
+ * With significance LOD enabled in ULyraNPCSettings, LOD also follows each NPC's significance rank
+ * and no LOD band is ever handed more NPCs than its budget.
+ */
+class LYRANPC_API FLyraNPCLODManager
+{
+public:
+	// A point LOD is measured from. An NPC at distance D from a viewer of weight W counts as D / W away.
+	struct FViewer
+	{
+		FVector Location = FVector::ZeroVector;
+		float Weight = 1.0f;
+		float InvWeightSq = 1.0f;
+	};
+
+	// Seconds for one full pass over the population
+	float UpdatePeriod = 1.0f;
+
+	// Most LOD changes applied per frame (0 = unlimited). The rest wait in a queue, nearest NPCs first,
+	// so a teleport or camera cut does not toggle perception and behavior trees on hundreds of NPCs at once.
+	int32 MaxTransitionsPerFrame = 0;
+
+	// Multiplier on every controller's LOD distance thresholds, lowered by the frame governor under load
+	float LODDistanceScale = 1.0f;
+
+	// Measure from every player controller's view point (pawn camera, spectator, detached camera);
+	// on a dedicated server that is each connection's view
+	bool bUsePlayerViewPoints = true;
+	float PlayerViewPointWeight = 1.0f;
+
+	void SetCellSize(float InCellSize) { CellSize = FMath::Max(InCellSize, 1.0f); }
+	void Reset();
+
+	// Extra view points, e.g. cinematic or replay cameras. Actor view points follow the actor and
+	// are dropped when it is destroyed. Ids are never reused.
+	int32 AddViewPoint(const FVector& Location, float Weight);
+	int32 AddViewPoint(const AActor* Actor, float Weight);
+	void UpdateViewPoint(int32 ViewPointId, const FVector& Location, float Weight);
+	void RemoveViewPoint(int32 ViewPointId);
+	int32 GetNumViewPoints() const { return ViewPoints.Num(); }
+
+	/**
+	 * Evaluates this frame's slice of NPCs, then applies up to MaxTransitionsPerFrame queued LOD
+	 * changes. Call GatherViewers first. LODCounts is the live number of NPCs per ELyraNPCAILOD, used to
+	 * enforce the significance budgets.
+	 */
+	void Tick(TArrayView<ALyraNPCCharacter* const> NPCs, TArrayView<const int32> LODCounts, float DeltaTime);
+
+	// Significance of an NPC Distance away from its nearest viewer; higher is more important
+	static float ComputeSignificance(const ALyraNPCCharacter* NPC, float Distance, const ULyraNPCSettings& Settings);
+
+	// Collects this frame's viewers and stamps them into the grid; once per frame
+	void GatherViewers(const UWorld* World);
+	TArrayView<const FViewer> GetViewers() const { return Viewers; }
+
+	// Weighted distance to the nearest viewer, or MAX_FLT if none is within MaxDistance. Uses this frame's viewers.
+	float GetDistanceToNearestViewer(const FVector& Location, float MaxDistance) const;
+
+	// NPCs evaluated and LOD changes pushed since the last ResetStats
+	int32 GetNumEvaluated() const { return NumEvaluated; }
+	int32 GetNumChanged() const { return NumChanged; }
+
+	// LOD changes still queued, and transitions left waiting at the end of a frame summed since ResetStats
+	int32 GetNumPendingTransitions() const { return PendingTransitions.Num(); }
+	int32 GetNumDeferred() const { return NumDeferred; }
+
+	void ResetStats() { NumEvaluated = 0; NumChanged = 0; NumDeferred = 0; }
+
+private:
+	void Evaluate(ALyraNPCCharacter* NPC, TArrayView<const int32> LODCounts, const ULyraNPCSettings& Settings);
+
+	// Ranks last pass's significance scores into the score needed for each budgeted LOD
+	void UpdateSignificanceThresholds(const ULyraNPCSettings& Settings);
+	ELyraNPCAILOD GetLODForSignificance(float Significance) const;
+
+	// Queues (or, without a budget, applies) a LOD change; a decision matching the current LOD cancels a queued one
+	void RequestTransition(ALyraNPCAIController* Controller, ELyraNPCAILOD NewLOD, float Distance);
+	void ApplyTransitions();
+
+	struct FViewPoint
+	{
+		TWeakObjectPtr<const AActor> Actor;
+		FVector Location = FVector::ZeroVector;
+		float Weight = 1.0f;
+	};
+
+	void AddViewer(const FVector& Location, float Weight);
+	void StampViewers();
+	FIntPoint GetCell(const FVector& Location) const;
+
+	TMap<int32, FViewPoint> ViewPoints;
+	int32 NextViewPointId = 1;
+
+	// Viewers this frame, and for each grid cell the viewers that can reach into it. The grid is only
+	// built once there are enough viewers to pay for it.
+	TArray<FViewer> Viewers;
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> ViewerCells;
+	float CellSize = 5000.0f;
+	float MaxViewerWeight = 1.0f;
+
+	// Weighted distance (distance / viewer weight) the current stamp covers, and the largest distance
+	// queried so far; the next stamp grows to cover it. Queries beyond the stamp scan every viewer.
+	float StampedReach = 0.0f;
+	mutable float LargestQueryDistance = 0.0f;
+
+	// Next dense NPC slot to evaluate, and the fraction of an NPC carried over between frames
+	int32 Cursor = 0;
+	float SliceRemainder = 0.0f;
+
+	// Scores gathered over the current pass, and the lowest score that made each budget last pass
+	TArray<float> PassSignificance;
+	float SignificanceThresholds[3] = { -MAX_FLT, -MAX_FLT, -MAX_FLT };
+
+	// Queued LOD changes with the NPC's viewer distance, and how many are headed into each LOD so the
+	// significance budgets count them before they land
+	struct FPendingTransition
+	{
+		ELyraNPCAILOD LOD = ELyraNPCAILOD::Full;
+		float Distance = 0.0f;
+	};
+	TMap<TWeakObjectPtr<ALyraNPCAIController>, FPendingTransition> PendingTransitions;
+	int32 PendingIntoLOD[static_cast<int32>(ELyraNPCAILOD::MAX)] = {};
+
+	int32 NumEvaluated = 0;
+	int32 NumChanged = 0;
+	int32 NumDeferred = 0;
+};
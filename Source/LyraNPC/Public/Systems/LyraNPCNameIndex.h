@@ -0,0 +1,71 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/LyraNPCTypes.h"
+
+/**
+ * Case-insensitive name index over registered NPCs.
+ * Exact lookups use a hash map. Prefix searches binary search a sorted name table and
+ * substring searches binary search a sorted table of every name suffix. Both tables are
+ * kept sorted incrementally, so searches cost O(log n + matches).
+ */
+class LYRANPC_API FLyraNPCNameIndex
+{
+public:
+	// Lower-cased, trimmed form every name and query is compared in
+	static FString Normalize(const FString& Name);
+
+	// Adds or renames the entry for Handle
+	void Set(const FLyraNPCHandle& Handle, const FString& Name);
+	void Remove(const FLyraNPCHandle& Handle);
+	void Reset();
+
+	int32 Num() const { return Names.Num(); }
+
+	// Any NPC whose name equals Name (case-insensitive)
+	FLyraNPCHandle FindExact(const FString& Name) const;
+
+	// Any NPC whose name contains Substring, preferring an exact match
+	FLyraNPCHandle FindFirstContaining(const FString& Substring) const;
+
+	// NPCs whose name starts with Prefix, in name order (MaxResults <= 0 means unlimited)
+	void FindByPrefix(const FString& Prefix, TArray<FLyraNPCHandle>& OutHandles, int32 MaxResults = 0) const;
+
+	// NPCs whose name contains Substring anywhere (MaxResults <= 0 means unlimited)
+	void FindBySubstring(const FString& Substring, TArray<FLyraNPCHandle>& OutHandles, int32 MaxResults = 0) const;
+
+private:
+	struct FNameEntry
+	{
+		FString Name;
+		FLyraNPCHandle Handle;
+	};
+
+	// Suffixes of one name are all different lengths, so (text, Handle) is unique
+	struct FSuffixEntry
+	{
+		FLyraNPCHandle Handle;
+		int32 Offset;
+	};
+
+	void Insert(const FLyraNPCHandle& Handle, const FString& NormalizedName);
+	void Erase(const FLyraNPCHandle& Handle, const FString& NormalizedName);
+
+	const TCHAR* GetSuffix(const FSuffixEntry& Entry) const;
+	int32 LowerBoundName(const TCHAR* Key, const FLyraNPCHandle* Handle) const;
+	int32 LowerBoundSuffix(const TCHAR* Key, const FLyraNPCHandle* Handle) const;
+
+	// Normalized name per handle
+	TMap<FLyraNPCHandle, FString> Names;
+
+	// Normalized name -> handles with that exact name
+	TMultiMap<FString, FLyraNPCHandle> ExactIndex;
+
+	// Sorted by (Name, Handle)
+	TArray<FNameEntry> SortedNames;
+
+	// Sorted by (suffix text, Handle)
+	TArray<FSuffixEntry> SortedSuffixes;
+};
@@ -0,0 +1,53 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/LyraNPCTypes.h"
+
+class ULyraNPCNeedsComponent;
+
+/**
+ * Stored need lines for a whole population in structure-of-arrays form: one contiguous float array of
+ * base values per need type, and the base world time and game hours per slot. Owned by the world
+ * subsystem when it batches needs; each attached needs component keeps its slot and evaluates its
+ * values from here.
+ */
+class LYRANPC_API FLyraNPCNeedsBatch
+{
+public:
+	static constexpr int32 NumNeedTypes = static_cast<int32>(ELyraNPCNeedType::MAX);
+
+	// Adds a slot with every need satisfied and no base time. Owner is kept informed of its slot.
+	int32 Add(ULyraNPCNeedsComponent* Owner);
+
+	// Swap-removes the slot, moving the last slot into its place
+	void Remove(int32 Slot);
+
+	void Reset();
+
+	int32 Num() const { return Owners.Num(); }
+	ULyraNPCNeedsComponent* GetOwner(int32 Slot) const { return Owners[Slot]; }
+
+	float GetValue(int32 Slot, int32 Type) const { return Values[Type][Slot]; }
+	void SetValue(int32 Slot, int32 Type, float NewValue) { Values[Type][Slot] = NewValue; }
+
+	// Base of a slot's values in world time (negative before it started) and on the subsystem's game clock
+	double GetBaseTime(int32 Slot) const { return BaseTimes[Slot]; }
+	double GetBaseGameHours(int32 Slot) const { return BaseGameHours[Slot]; }
+	void SetBase(int32 Slot, double WorldTime, double GameHours)
+	{
+		BaseTimes[Slot] = WorldTime;
+		BaseGameHours[Slot] = GameHours;
+	}
+
+private:
+	TArray<ULyraNPCNeedsComponent*> Owners;
+
+	// Per need type, indexed by slot
+	TArray<float> Values[NumNeedTypes];
+
+	// Per slot
+	TArray<double> BaseTimes;
+	TArray<double> BaseGameHours;
+};
@@ -0,0 +1,48 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ULyraNPCNeedsComponent;
+
+/**
+ * Min-heap of predicted need threshold crossings, keyed by time on one clock (world seconds or game
+ * hours). Each needs component has at most one current entry; rescheduling leaves the old one behind
+ * as stale, identified by its serial, and stale entries are skipped when popped and swept out once
+ * they pile up.
+ */
+class LYRANPC_API FLyraNPCNeedsEventQueue
+{
+public:
+	void Push(ULyraNPCNeedsComponent* Needs, double Time, uint32 Serial);
+
+	// Removes the earliest current event due by Now; returns null when none is due
+	ULyraNPCNeedsComponent* PopDue(double Now);
+
+	void Reset();
+
+	// Entries held, including stale ones not swept yet
+	int32 Num() const { return Heap.Num(); }
+
+private:
+	struct FEvent
+	{
+		double Time;
+		TWeakObjectPtr<ULyraNPCNeedsComponent> Needs;
+		uint32 Serial;
+	};
+
+	struct FEarlierEvent
+	{
+		bool operator()(const FEvent& A, const FEvent& B) const { return A.Time < B.Time; }
+	};
+
+	static bool IsCurrent(const FEvent& Event);
+	void RemoveStale();
+
+	TArray<FEvent> Heap;
+
+	// Size at which stale entries are swept, reset to twice the live count after each sweep
+	int32 SweepThreshold = 256;
+};
@@ -0,0 +1,96 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/SparseArray.h"
+
+/**
+ * Sparse-array registry that hands out generational handles.
+ * Add, Remove and IsValid are O(1). Freed slots are reused with a new generation,
+ * so a stale handle never resolves to the slot's next occupant.
+ * HandleType needs int32 Index and int32 Generation members.
+ */
+template<typename HandleType, typename EntryType>
+class TLyraNPCRegistry
+{
+public:
+	HandleType Add(EntryType&& Entry)
+	{
+		const int32 Index = Entries.Add(MoveTemp(Entry));
+		if (Index >= Generations.Num())
+		{
+			Generations.SetNumZeroed(Index + 1);
+		}
+
+		return MakeHandle(Index, ++Generations[Index]);
+	}
+
+	bool Remove(const HandleType& Handle)
+	{
+		if (!IsValid(Handle)) return false;
+
+		Entries.RemoveAt(Handle.Index);
+		return true;
+	}
+
+	bool IsValid(const HandleType& Handle) const
+	{
+		return Entries.IsValidIndex(Handle.Index) && Generations[Handle.Index] == Handle.Generation;
+	}
+
+	EntryType* Find(const HandleType& Handle)
+	{
+		return IsValid(Handle) ? &Entries[Handle.Index] : nullptr;
+	}
+
+	const EntryType* Find(const HandleType& Handle) const
+	{
+		return IsValid(Handle) ? &Entries[Handle.Index] : nullptr;
+	}
+
+	int32 Num() const { return Entries.Num(); }
+
+	// Drops every entry; generations are kept so handles issued before the reset stay invalid
+	void Reset()
+	{
+		Entries.Empty();
+	}
+
+	// Calls Func(Handle, Entry) for every live entry
+	template<typename FuncType>
+	void ForEach(FuncType&& Func)
+	{
+		for (auto It = Entries.CreateIterator(); It; ++It)
+		{
+			Func(MakeHandle(It.GetIndex(), Generations[It.GetIndex()]), *It);
+		}
+	}
+
+	template<typename FuncType>
+	void ForEach(FuncType&& Func) const
+	{
+		for (auto It = Entries.CreateConstIterator(); It; ++It)
+		{
+			Func(MakeHandle(It.GetIndex(), Generations[It.GetIndex()]), *It);
+		}
+	}
+
+	// Ranged-for over entries
+	auto begin() { return Entries.begin(); }
+	auto end() { return Entries.end(); }
+	auto begin() const { return Entries.begin(); }
+	auto end() const { return Entries.end(); }
+
+private:
+	static HandleType MakeHandle(int32 Index, int32 Generation)
+	{
+		HandleType Handle;
+		Handle.Index = Index;
+		Handle.Generation = Generation;
+		return Handle;
+	}
+
+	TSparseArray<EntryType> Entries;
+	TArray<int32> Generations;
+};
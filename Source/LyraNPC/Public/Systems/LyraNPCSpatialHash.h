@@ -0,0 +1,358 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform 2D grid that buckets elements by their XY location.
+ * Elements are moved between cells as their location is updated, so radius, box and
+ * nearest queries only visit the cells overlapping the query instead of every element.
+ * Distance and containment tests are done in 3D against the stored location.
+ */
+template<typename ElementType>
+class TLyraNPCSpatialHash
+{
+public:
+	explicit TLyraNPCSpatialHash(float InCellSize = 2000.0f)
+	{
+		SetCellSize(InCellSize);
+	}
+
+	// Changes the cell size and re-buckets every element
+	void SetCellSize(float InCellSize)
+	{
+		CellSize = FMath::Max(InCellSize, 1.0f);
+		InvCellSize = 1.0 / CellSize;
+
+		if (Entries.Num() > 0)
+		{
+			TArray<FCellItem> AllItems;
+			AllItems.Reserve(Entries.Num());
+			for (const TPair<FIntPoint, TArray<FCellItem>>& Pair : Cells)
+			{
+				AllItems.Append(Pair.Value);
+			}
+
+			Reset();
+			for (const FCellItem& Item : AllItems)
+			{
+				Add(Item.Element, Item.Location);
+			}
+		}
+	}
+
+	float GetCellSize() const { return CellSize; }
+	int32 Num() const { return Entries.Num(); }
+	int32 GetNumCells() const { return Cells.Num(); }
+	bool Contains(const ElementType& Element) const { return Entries.Contains(Element); }
+
+	void Reset()
+	{
+		Cells.Reset();
+		Entries.Reset();
+	}
+
+	// Adds an element, or moves it if it is already present
+	void Add(const ElementType& Element, const FVector& Location)
+	{
+		if (Entries.Contains(Element))
+		{
+			Update(Element, Location);
+			return;
+		}
+
+		const FIntPoint Cell = GetCell(Location);
+		TArray<FCellItem>& Bucket = Cells.FindOrAdd(Cell);
+		const int32 SlotIndex = Bucket.Add(FCellItem{ Element, Location });
+		Entries.Add(Element, FEntry{ Cell, SlotIndex });
+	}
+
+	// Updates the stored location, changing cell only when the element crossed a cell border
+	void Update(const ElementType& Element, const FVector& Location)
+	{
+		FEntry* Entry = Entries.Find(Element);
+		if (!Entry)
+		{
+			Add(Element, Location);
+			return;
+		}
+
+		const FIntPoint NewCell = GetCell(Location);
+		if (NewCell == Entry->Cell)
+		{
+			Cells.FindChecked(Entry->Cell)[Entry->SlotIndex].Location = Location;
+			return;
+		}
+
+		RemoveFromCell(Entry->Cell, Entry->SlotIndex);
+
+		TArray<FCellItem>& Bucket = Cells.FindOrAdd(NewCell);
+		Entry->Cell = NewCell;
+		Entry->SlotIndex = Bucket.Add(FCellItem{ Element, Location });
+	}
+
+	void Remove(const ElementType& Element)
+	{
+		FEntry Entry;
+		if (Entries.RemoveAndCopyValue(Element, Entry))
+		{
+			RemoveFromCell(Entry.Cell, Entry.SlotIndex);
+		}
+	}
+
+	bool GetLocation(const ElementType& Element, FVector& OutLocation) const
+	{
+		if (const FEntry* Entry = Entries.Find(Element))
+		{
+			OutLocation = Cells.FindChecked(Entry->Cell)[Entry->SlotIndex].Location;
+			return true;
+		}
+		return false;
+	}
+
+	// Calls Func(Element, Location) for every element
+	template<typename FuncType>
+	void ForEach(FuncType&& Func) const
+	{
+		for (const TPair<FIntPoint, TArray<FCellItem>>& Pair : Cells)
+		{
+			for (const FCellItem& Item : Pair.Value)
+			{
+				Func(Item.Element, Item.Location);
+			}
+		}
+	}
+
+	// Calls Func(Element, Location) for every element within Radius of Center
+	template<typename FuncType>
+	void ForEachInRadius(const FVector& Center, float Radius, FuncType&& Func) const
+	{
+		if (Radius < 0.0f || Entries.Num() == 0) return;
+
+		const double RadiusSq = static_cast<double>(Radius) * Radius;
+		const FIntPoint MinCell = GetCell(Center.X - Radius, Center.Y - Radius);
+		const FIntPoint MaxCell = GetCell(Center.X + Radius, Center.Y + Radius);
+
+		ForEachCellInRange(MinCell, MaxCell, [&](const TArray<FCellItem>& Bucket)
+		{
+			for (const FCellItem& Item : Bucket)
+			{
+				if (FVector::DistSquared(Item.Location, Center) <= RadiusSq)
+				{
+					Func(Item.Element, Item.Location);
+				}
+			}
+		});
+	}
+
+	// Calls Func(Element, Location) for every element inside (or on) Box
+	template<typename FuncType>
+	void ForEachInBox(const FBox& Box, FuncType&& Func) const
+	{
+		if (!Box.IsValid || Entries.Num() == 0) return;
+
+		const FIntPoint MinCell = GetCell(Box.Min.X, Box.Min.Y);
+		const FIntPoint MaxCell = GetCell(Box.Max.X, Box.Max.Y);
+
+		ForEachCellInRange(MinCell, MaxCell, [&](const TArray<FCellItem>& Bucket)
+		{
+			for (const FCellItem& Item : Bucket)
+			{
+				if (Box.IsInsideOrOn(Item.Location))
+				{
+					Func(Item.Element, Item.Location);
+				}
+			}
+		});
+	}
+
+	/**
+	 * Finds up to Count elements closest to Center, sorted nearest first.
+	 * Cells are visited in rings around Center and the search stops as soon as no
+	 * unvisited ring can beat the current worst candidate.
+	 * @param MaxRadius		Ignore elements further than this (<= 0 means unlimited)
+	 * @param Filter		Predicate(Element) used to skip elements (e.g. stale ones)
+	 */
+	template<typename AllocatorType, typename FilterType>
+	void FindNearest(const FVector& Center, int32 Count, float MaxRadius, TArray<ElementType, AllocatorType>& OutElements, FilterType&& Filter) const
+	{
+		OutElements.Reset();
+		if (Count <= 0 || Entries.Num() == 0) return;
+
+		const double MaxRadiusSq = MaxRadius > 0.0f ? static_cast<double>(MaxRadius) * MaxRadius : TNumericLimits<double>::Max();
+
+		typedef TPair<double, ElementType> FCandidate;
+		// Max-heap on distance so the worst candidate is always on top
+		auto HeapPredicate = [](const FCandidate& A, const FCandidate& B) { return A.Key > B.Key; };
+		TArray<FCandidate, TInlineAllocator<16>> Best;
+
+		auto Consider = [&](const FCellItem& Item)
+		{
+			if (!Filter(Item.Element)) return;
+
+			const double DistSq = FVector::DistSquared(Item.Location, Center);
+			if (DistSq > MaxRadiusSq) return;
+
+			if (Best.Num() < Count)
+			{
+				Best.HeapPush(FCandidate(DistSq, Item.Element), HeapPredicate);
+			}
+			else if (DistSq < Best.HeapTop().Key)
+			{
+				Best.HeapPopDiscard(HeapPredicate);
+				Best.HeapPush(FCandidate(DistSq, Item.Element), HeapPredicate);
+			}
+		};
+
+		const FIntPoint CenterCell = GetCell(Center.X, Center.Y);
+		int32 ItemsSeen = 0;
+		int64 CellsProbed = 0;
+
+		for (int32 Ring = 0; ItemsSeen < Entries.Num(); ++Ring)
+		{
+			// The query point lies inside the center cell, so ring R is at least (R - 1) cells away
+			const double RingMinDist = FMath::Max(0, Ring - 1) * static_cast<double>(CellSize);
+			const double RingMinDistSq = RingMinDist * RingMinDist;
+			if (RingMinDistSq > MaxRadiusSq) break;
+			if (Best.Num() == Count && RingMinDistSq > Best.HeapTop().Key) break;
+
+			// Once probing empty rings costs more than walking the occupied cells, finish with a scan
+			const int64 RingCellCount = Ring == 0 ? 1 : 8 * static_cast<int64>(Ring);
+			if (CellsProbed + RingCellCount > Cells.Num())
+			{
+				for (const TPair<FIntPoint, TArray<FCellItem>>& Pair : Cells)
+				{
+					const int32 CellRing = FMath::Max(FMath::Abs(Pair.Key.X - CenterCell.X), FMath::Abs(Pair.Key.Y - CenterCell.Y));
+					if (CellRing >= Ring)
+					{
+						for (const FCellItem& Item : Pair.Value)
+						{
+							Consider(Item);
+						}
+					}
+				}
+				break;
+			}
+			CellsProbed += RingCellCount;
+
+			auto VisitCell = [&](int32 X, int32 Y)
+			{
+				if (const TArray<FCellItem>* Bucket = Cells.Find(FIntPoint(X, Y)))
+				{
+					ItemsSeen += Bucket->Num();
+					for (const FCellItem& Item : *Bucket)
+					{
+						Consider(Item);
+					}
+				}
+			};
+
+			if (Ring == 0)
+			{
+				VisitCell(CenterCell.X, CenterCell.Y);
+				continue;
+			}
+
+			for (int32 Offset = -Ring; Offset <= Ring; ++Offset)
+			{
+				VisitCell(CenterCell.X + Offset, CenterCell.Y - Ring);
+				VisitCell(CenterCell.X + Offset, CenterCell.Y + Ring);
+			}
+			for (int32 Offset = -Ring + 1; Offset <= Ring - 1; ++Offset)
+			{
+				VisitCell(CenterCell.X - Ring, CenterCell.Y + Offset);
+				VisitCell(CenterCell.X + Ring, CenterCell.Y + Offset);
+			}
+		}
+
+		Best.Sort([](const FCandidate& A, const FCandidate& B) { return A.Key < B.Key; });
+		OutElements.Reserve(Best.Num());
+		for (const FCandidate& Candidate : Best)
+		{
+			OutElements.Add(Candidate.Value);
+		}
+	}
+
+private:
+	struct FCellItem
+	{
+		ElementType Element;
+		FVector Location;
+	};
+
+	struct FEntry
+	{
+		FIntPoint Cell;
+		int32 SlotIndex;
+	};
+
+	FIntPoint GetCell(const FVector& Location) const
+	{
+		return GetCell(Location.X, Location.Y);
+	}
+
+	FIntPoint GetCell(double X, double Y) const
+	{
+		return FIntPoint(ToCellCoord(X), ToCellCoord(Y));
+	}
+
+	int32 ToCellCoord(double Value) const
+	{
+		// Clamp so huge query extents cannot overflow the cell coordinates
+		const double Scaled = FMath::Clamp(Value * InvCellSize, -1.0e9, 1.0e9);
+		return FMath::FloorToInt32(Scaled);
+	}
+
+	void RemoveFromCell(const FIntPoint& Cell, int32 SlotIndex)
+	{
+		TArray<FCellItem>& Bucket = Cells.FindChecked(Cell);
+		Bucket.RemoveAtSwap(SlotIndex);
+
+		if (Bucket.Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+		else if (SlotIndex < Bucket.Num())
+		{
+			// The last item was swapped into the freed slot
+			Entries.FindChecked(Bucket[SlotIndex].Element).SlotIndex = SlotIndex;
+		}
+	}
+
+	template<typename FuncType>
+	void ForEachCellInRange(const FIntPoint& MinCell, const FIntPoint& MaxCell, FuncType&& Func) const
+	{
+		const int64 RangeCellCount = (static_cast<int64>(MaxCell.X) - MinCell.X + 1) * (static_cast<int64>(MaxCell.Y) - MinCell.Y + 1);
+
+		// Large queries are cheaper to answer by walking the occupied cells
+		if (RangeCellCount > Cells.Num())
+		{
+			for (const TPair<FIntPoint, TArray<FCellItem>>& Pair : Cells)
+			{
+				if (Pair.Key.X >= MinCell.X && Pair.Key.X <= MaxCell.X &&
+					Pair.Key.Y >= MinCell.Y && Pair.Key.Y <= MaxCell.Y)
+				{
+					Func(Pair.Value);
+				}
+			}
+			return;
+		}
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				if (const TArray<FCellItem>* Bucket = Cells.Find(FIntPoint(X, Y)))
+				{
+					Func(*Bucket);
+				}
+			}
+		}
+	}
+
+	TMap<FIntPoint, TArray<FCellItem>> Cells;
+	TMap<ElementType, FEntry> Entries;
+	float CellSize = 2000.0f;
+	double InvCellSize = 1.0 / 2000.0;
+};
@@ -0,0 +1,111 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Core/LyraNPCTypes.h"
+#include "Systems/LyraNPCSpatialHash.h"
+#include "Tasks/LyraNPCTaskActor.h"
+
+/**
+ * Index of registered task components, bucketed by exact TaskType and then by spatial cell.
+ * A query for a tag only visits the buckets whose type matches it (the tag itself or one of
+ * its children) and, inside those, only the cells overlapping the query radius.
+ */
+class LYRANPC_API FLyraNPCTaskIndex
+{
+public:
+	void SetCellSize(float InCellSize);
+	void Reset();
+
+	void Add(ULyraNPCTaskActor* Task);
+	void Remove(const TWeakObjectPtr<ULyraNPCTaskActor>& Task);
+
+	// Re-files a task after its TaskType or scoring data changed
+	void Update(ULyraNPCTaskActor* Task);
+
+	// Cheap path for moving tasks: only the location is refreshed
+	void UpdateLocation(ULyraNPCTaskActor* Task);
+
+	int32 Num() const { return IndexedTypes.Num(); }
+
+	/**
+	 * Calls Func(Task) for every live task whose TaskType matches TaskType (any type if the tag is
+	 * invalid) within Radius of Center. A negative Radius means unlimited.
+	 * Every task handed to Func is counted as an examined candidate.
+	 * Game thread only: queries fill the bucket cache and the stats, so gather on the game thread
+	 * before handing results to workers.
+	 */
+	template<typename FuncType>
+	void ForEachTask(const FGameplayTag& TaskType, const FVector& Center, float Radius, FuncType&& Func) const
+	{
+		check(IsInGameThread());
+
+		int32 Candidates = 0;
+		auto Visit = [&](const TWeakObjectPtr<ULyraNPCTaskActor>& TaskPtr, const FVector&)
+		{
+			ULyraNPCTaskActor* Task = TaskPtr.Get();
+
+			// TaskType is writable from Blueprint, so guard against a bucket that has gone stale
+			if (Task && (!TaskType.IsValid() || Task->TaskType.MatchesTag(TaskType)))
+			{
+				++Candidates;
+				Func(Task);
+			}
+		};
+
+		const TArray<FGameplayTag, TInlineAllocator<8>> BucketTypes(GetMatchingBuckets(TaskType));
+		for (const FGameplayTag& BucketType : BucketTypes)
+		{
+			const FBucket& Bucket = Buckets.FindChecked(BucketType);
+			if (Radius < 0.0f)
+			{
+				Bucket.Grid.ForEach(Visit);
+			}
+			else
+			{
+				Bucket.Grid.ForEachInRadius(Center, Radius, Visit);
+			}
+		}
+
+		RecordQuery(Candidates);
+	}
+
+	// Highest score (before the distance penalty) any task matching TaskType can give. Game thread only
+	float GetMaxScoreBound(const FGameplayTag& TaskType) const;
+
+	// Upper bound of ULyraNPCTaskActor::GetScoreForNPC for a task at zero distance
+	static float ComputeScoreBound(const ULyraNPCTaskActor* Task);
+
+	const FLyraNPCTaskQueryStats& GetStats() const { return Stats; }
+	void ResetStats() { Stats = FLyraNPCTaskQueryStats(); }
+
+private:
+	struct FBucket
+	{
+		TLyraNPCSpatialHash<TWeakObjectPtr<ULyraNPCTaskActor>> Grid;
+
+		// Per-task bounds, so the max can be recomputed when its holder leaves or drops
+		TMap<TWeakObjectPtr<ULyraNPCTaskActor>, float> ScoreBounds;
+		float MaxScoreBound = 0.0f;
+
+		void SetScoreBound(const TWeakObjectPtr<ULyraNPCTaskActor>& Task, float Bound);
+		void RemoveScoreBound(const TWeakObjectPtr<ULyraNPCTaskActor>& Task);
+		void RecomputeMaxScoreBound();
+	};
+
+	const TArray<FGameplayTag>& GetMatchingBuckets(const FGameplayTag& TaskType) const;
+	void RecordQuery(int32 Candidates) const;
+
+	TMap<FGameplayTag, FBucket> Buckets;
+	TMap<TWeakObjectPtr<ULyraNPCTaskActor>, FGameplayTag> IndexedTypes;
+
+	// Query tag -> bucket types matching it, rebuilt whenever a bucket is added or removed. Filled lazily
+	// by const queries, which is why they are restricted to the game thread
+	mutable TMap<FGameplayTag, TArray<FGameplayTag>> MatchingBucketCache;
+
+	// Written by every const query; game thread only, like the cache above
+	mutable FLyraNPCTaskQueryStats Stats;
+	float CellSize = 2000.0f;
+};
@@ -0,0 +1,100 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Core/LyraNPCTypes.h"
+
+class ALyraNPCCharacter;
+class ULyraNPCTaskActor;
+class FLyraNPCTaskIndex;
+
+/**
+ * Finds the best task of one type for many NPCs in a single pass. NPC and task data is copied once
+ * on the game thread into flat snapshots, so the scoring loop touches no UObjects and can run on
+ * worker threads. Scores match ULyraNPCTaskActor::GetScoreForNPC.
+ */
+class LYRANPC_API FLyraNPCTaskSearch
+{
+public:
+	// What task scoring reads from an NPC
+	struct FSearcher
+	{
+		FVector Location = FVector::ZeroVector;
+		FGuid UniqueId;
+
+		// Points into the identity component, which cannot change while a search runs
+		const FGameplayTagContainer* CharacterTags = nullptr;
+
+		ELyraNPCArchetype Archetype = ELyraNPCArchetype::Villager;
+		bool bValid = false;
+		bool bHasIdentity = false;
+		bool bHasNeeds = false;
+
+		// Batch group whose candidate list the NPC is scored against
+		int32 Group = INDEX_NONE;
+
+		// Same defaults as ULyraNPCNeedsComponent::GetNeedValue for needs the NPC lacks
+		float NeedValues[static_cast<int32>(ELyraNPCNeedType::MAX)];
+	};
+
+	// What task scoring reads from a task
+	struct FCandidate
+	{
+		ULyraNPCTaskActor* Task = nullptr;
+		FVector Location = FVector::ZeroVector;
+		float Priority = 0.0f;
+		FGuid OwnerNPCId;
+		bool bIsPrivate = false;
+
+		// One bit per allowed ELyraNPCArchetype
+		uint32 ArchetypeMask = 0;
+
+		const FGameplayTagContainer* RequiredTags = nullptr;
+		const FGameplayTagContainer* BlockingTags = nullptr;
+
+		// Users the task can still take
+		int32 FreeSlots = 0;
+
+		// Satisfaction per need type, zero where the task gives none
+		float NeedsSatisfaction[static_cast<int32>(ELyraNPCNeedType::MAX)];
+	};
+
+	static void Gather(const ALyraNPCCharacter* NPC, FSearcher& OutSearcher);
+	static void Gather(const ULyraNPCTaskActor* Task, FCandidate& OutCandidate);
+
+	static bool CanUse(const FCandidate& Candidate, const FSearcher& Searcher);
+
+	// Score before clamping at zero; only meaningful when CanUse passes
+	static float Score(const FCandidate& Candidate, const FSearcher& Searcher);
+
+	/**
+	 * Writes the best available task matching TaskType for NPCs[i] to OutBestTasks[i] (null if none
+	 * scores above zero), limited to MaxDistance when positive. Both views must be the same length.
+	 * Batches of at least MinParallelBatch NPCs are scored across worker threads.
+	 */
+	static void FindBestTasks(const FLyraNPCTaskIndex& TaskIndex, TArrayView<ALyraNPCCharacter* const> NPCs, const FGameplayTag& TaskType,
+		float MaxDistance, TArrayView<ULyraNPCTaskActor*> OutBestTasks, int32 MinParallelBatch);
+
+	/**
+	 * Like FindBestTasks, but solves the batch jointly: (NPC, task) pairs are taken greedily from the
+	 * highest score down, and no task is handed to more NPCs than it has free slots. Only each NPC's
+	 * NPCs.Num() best tasks are kept. Returns how many NPCs' independent best pick would have been
+	 * over-subscribed.
+	 */
+	static int32 AssignTasks(const FLyraNPCTaskIndex& TaskIndex, TArrayView<ALyraNPCCharacter* const> NPCs, const FGameplayTag& TaskType,
+		float MaxDistance, TArrayView<ULyraNPCTaskActor*> OutTasks, int32 MinParallelBatch);
+
+private:
+	using FSearcherArray = TArray<FSearcher, TInlineAllocator<16>>;
+	using FCandidateArray = TArray<FCandidate, TInlineAllocator<32>>;
+
+	// Candidate indices reachable from each group of nearby NPCs
+	using FGroupArray = TArray<TArray<int32>, TInlineAllocator<16>>;
+
+	// Snapshots the batch and the available tasks near each group of its NPCs. Returns the squared search radius.
+	// Runs on the calling (game) thread; workers only ever see the snapshot, never the index.
+	static double GatherBatch(const FLyraNPCTaskIndex& TaskIndex, TArrayView<ALyraNPCCharacter* const> NPCs, const FGameplayTag& TaskType,
+		float MaxDistance, FSearcherArray& OutSearchers, FCandidateArray& OutCandidates, FGroupArray& OutGroups);
+};
@@ -0,0 +1,46 @@
+// Copyright LyraNPC Framework. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/LyraNPCTypes.h"
+#include "Systems/LyraNPCSpatialHash.h"
+
+/**
+ * NPCs that currently exist only as FLyraNPCVirtualRecord data. Records are keyed by the NPC's
+ * unique id and bucketed by location, so finding the ones near a viewer does not touch the rest.
+ */
+class LYRANPC_API FLyraNPCVirtualPopulation
+{
+public:
+	// Adds a record, replacing any record with the same unique id. The id must be valid.
+	void Add(FLyraNPCVirtualRecord&& Record);
+
+	// Moves the record out of the population
+	bool Remove(const FGuid& UniqueId, FLyraNPCVirtualRecord& OutRecord);
+
+	const FLyraNPCVirtualRecord* Find(const FGuid& UniqueId) const;
+	bool Contains(const FGuid& UniqueId) const { return IdToSlot.Contains(UniqueId); }
+
+	int32 Num() const { return Records.Num(); }
+	void Reset();
+	void SetCellSize(float InCellSize) { Locations.SetCellSize(InCellSize); }
+
+	// Appends the ids of records within Radius of Center
+	void FindInRadius(const FVector& Center, float Radius, TArray<FGuid>& OutIds) const;
+
+	// Calls Func(const FLyraNPCVirtualRecord&) for every record
+	template<typename FuncType>
+	void ForEach(FuncType&& Func) const
+	{
+		for (const FLyraNPCVirtualRecord& Record : Records)
+		{
+			Func(Record);
+		}
+	}
+
+private:
+	TSparseArray<FLyraNPCVirtualRecord> Records;
+	TMap<FGuid, int32> IdToSlot;
+	TLyraNPCSpatialHash<int32> Locations;
+};
@@ -4,18 +4,94 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/WorldSubsystem.h"
+#include "Components/SceneComponent.h"
 #include "Core/LyraNPCTypes.h"
+#include "Systems/LyraNPCRegistry.h"
+#include "Systems/LyraNPCNameIndex.h"
+#include "Systems/LyraNPCSpatialHash.h"
+#include "Systems/LyraNPCTaskIndex.h"
+#include "Systems/LyraNPCTaskSearch.h"
+#include "Systems/LyraNPCLODManager.h"
+#include "Systems/LyraNPCFrameGovernor.h"
+#include "Systems/LyraNPCNeedsEventQueue.h"
+#include "Systems/LyraNPCNeedsBatch.h"
+#include "Systems/LyraNPCVirtualPopulation.h"
 #include "LyraNPCWorldSubsystem.generated.h"
 
 class ALyraNPCCharacter;
+class ALyraNPCAIController;
 class ULyraNPCTaskActor;
+class ULyraNPCNeedsComponent;
+
+DECLARE_DELEGATE_OneParam(FLyraNPCTaskSearchDelegate, ULyraNPCTaskActor* /*BestTask*/);
+
+/** Subsystem bookkeeping for a registered NPC */
+struct FLyraNPCRegistryEntry
+{
+	TWeakObjectPtr<ALyraNPCCharacter> NPC;
+
+	// Slot in the subsystem's dense NPC list
+	int32 DenseIndex = INDEX_NONE;
+
+	// Identity the NPC is currently filed under in the id index
+	FGuid IndexedId;
+
+	// State last counted in the population statistics and membership lists (MAX = not counted)
+	TWeakObjectPtr<ALyraNPCAIController> BoundController;
+	ELyraNPCAILOD CountedLOD = ELyraNPCAILOD::MAX;
+	ELyraNPCAlertLevel CountedAlertLevel = ELyraNPCAlertLevel::MAX;
+	ELyraNPCLifeState CountedLifeState = ELyraNPCLifeState::MAX;
+	ELyraNPCArchetype CountedArchetype = ELyraNPCArchetype::MAX;
+	// Wellbeing counted as a line: its value at CountedWellbeingTime (world seconds) and
+	// CountedWellbeingGameHours, and its change per world second and per game hour from there
+	float CountedWellbeing = 0.0f;
+	float CountedWellbeingRate = 0.0f;
+	float CountedWellbeingHourRate = 0.0f;
+	double CountedWellbeingTime = 0.0;
+	double CountedWellbeingGameHours = 0.0;
+
+	// Slots in the per-life-state and per-archetype lists
+	int32 LifeStateSlot = INDEX_NONE;
+	int32 ArchetypeSlot = INDEX_NONE;
+
+	// Task reserved for the NPC by the assignment phase and the world time it was reserved. Released
+	// when a new one replaces it, the consumer gives up, or it times out unused.
+	TWeakObjectPtr<ULyraNPCTaskActor> AssignedTask;
+	double AssignedTaskTime = 0.0;
+};
+
+/** Subsystem bookkeeping for a registered task component */
+struct FLyraNPCTaskRegistryEntry
+{
+	TWeakObjectPtr<ULyraNPCTaskActor> Task;
+
+	// Slot in the subsystem's dense task list
+	int32 DenseIndex = INDEX_NONE;
+};
+
+/** A task search queued with RequestBestTaskForNPC */
+struct FLyraNPCPendingTaskSearch
+{
+	uint32 RequestId = 0;
+	TWeakObjectPtr<ALyraNPCCharacter> NPC;
+	FGameplayTag TaskType;
+	float MaxDistance = 0.0f;
+	FLyraNPCTaskSearchDelegate OnComplete;
+};
+
+/** A reservation made by the assignment phase, queued in reservation order for the timeout sweep */
+struct FLyraNPCTaskReservation
+{
+	TWeakObjectPtr<ALyraNPCCharacter> NPC;
+	double ReservedAt = 0.0;
+};
 
 /**
  * World subsystem that manages all LyraNPC characters globally.
  * Provides optimized queries, task pooling, and global time management.
  */
 UCLASS()
-class LYRANPC_API ULyraNPCWorldSubsystem : public UWorldSubsystem
+class LYRANPC_API ULyraNPCWorldSubsystem : public UTickableWorldSubsystem
 {
 	GENERATED_BODY()
 
@@ -29,12 +105,14 @@ public:
 	virtual bool ShouldCreateSubsystem(UObject* Outer) const override { return true; }
 
 	// ===== GLOBAL TIME =====
+	// The one authoritative clock. Schedule and needs components read it directly, so changing
+	// the hour or scale costs the same regardless of population.
 
 	// Current game hour (shared across all NPCs)
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Time")
 	float GlobalGameHour = 6.0f;
 
-	// Time scale (1 real second = TimeScale game seconds)
+	// Time scale (1 real second = TimeScale game seconds), used by every NPC without an override
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Time")
 	float GlobalTimeScale = 24.0f;
 
@@ -42,8 +120,180 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Time")
 	bool bAutoAdvanceTime = true;
 
+	// ===== SPATIAL =====
+
+	// Cell size of the spatial hash used for proximity queries (roughly the most common query radius)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "LyraNPC|Spatial")
+	float SpatialCellSize = 2000.0f;
+
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Spatial")
+	void SetSpatialCellSize(float NewCellSize);
+
+	// ===== AI LOD =====
+
+	// Compute every NPC's AI LOD here in one time-sliced pass instead of in each controller
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|LOD")
+	bool bCentralizedLOD = true;
+
+	// Seconds for the LOD manager to evaluate the whole population once
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|LOD", meta = (ClampMin = "0.05"))
+	float LODUpdatePeriod = 1.0f;
+
+	// Most AI LOD changes applied per frame (0 = unlimited); the rest are queued nearest-first
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|LOD", meta = (ClampMin = "0"))
+	int32 MaxLODTransitionsPerFrame = 32;
+
+	// LOD changes waiting for a frame with budget left
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|LOD")
+	int32 GetPendingLODTransitionCount() const { return LODManager.GetNumPendingTransitions(); }
+
+	// AI LOD changes, and the OnAILODChanged broadcasts with listeners they fired, over the last full second
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|LOD")
+	float GetAILODChangesPerSecond() const { return LODChangesPerSecond; }
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|LOD")
+	float GetAILODBroadcastsPerSecond() const { return LODBroadcastsPerSecond; }
+
+	// Called by ALyraNPCAIController::SetAILOD for every change
+	void NotifyAILODChanged(bool bBroadcast);
+
+	// Measure LOD from every player controller's view point, which covers spectators and detached
+	// cameras and, on a dedicated server, every connection
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|LOD")
+	bool bUsePlayerViewPoints = true;
+
+	// Weight of player view points; an NPC D away from a view point of weight W counts as D / W away
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|LOD", meta = (ClampMin = "0.01"))
+	float PlayerViewPointWeight = 1.0f;
+
+	// Extra points LOD is measured from, e.g. cinematic or replay cameras. Returns an id for Update/Remove.
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|LOD")
+	int32 AddLODViewPoint(FVector Location, float Weight = 1.0f);
+
+	// View point that follows Actor until it is destroyed or removed
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|LOD")
+	int32 AddLODViewPointActor(AActor* Actor, float Weight = 1.0f);
+
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|LOD")
+	void UpdateLODViewPoint(int32 ViewPointId, FVector Location, float Weight = 1.0f);
+
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|LOD")
+	void RemoveLODViewPoint(int32 ViewPointId);
+
+	const FLyraNPCLODManager& GetLODManager() const { return LODManager; }
+
+	// ===== FRAME GOVERNOR =====
+	// Measures LyraNPC's own game-thread cost each frame. Over budget it shrinks LOD distances, stretches
+	// tick intervals and defers non-critical work one level at a time, and undoes it once there is headroom.
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Governor")
+	bool bUseFrameGovernor = true;
+
+	// Milliseconds per frame LyraNPC work (controllers, components, BT nodes, EQS, this subsystem) may take
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Governor", meta = (ClampMin = "0.1", EditCondition = "bUseFrameGovernor"))
+	float FrameBudgetMs = 4.0f;
+
+	// Highest pressure level. Each level shrinks LOD distances by 15% and adds half of every tick interval;
+	// from level 2 task searches are halved and only Full NPCs refresh their blackboard every tick.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Governor", meta = (ClampMin = "0", ClampMax = "6", EditCondition = "bUseFrameGovernor"))
+	int32 MaxGovernorLevel = 4;
+
+	// NPCs whose tick rates are re-applied per frame after a level change
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Governor", meta = (ClampMin = "1", EditCondition = "bUseFrameGovernor"))
+	int32 GovernorRefreshesPerFrame = 64;
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Governor")
+	int32 GetGovernorLevel() const { return FrameGovernor.GetLevel(); }
+
+	// Smoothed LyraNPC cost per frame in milliseconds
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Governor")
+	float GetFrameCostMs() const { return FrameGovernor.GetSmoothedCostMs(); }
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Governor")
+	bool IsDeferringNonCriticalWork() const { return FrameGovernor.ShouldDeferNonCriticalWork(); }
+
+	const FLyraNPCFrameGovernor& GetFrameGovernor() const { return FrameGovernor; }
+	FLyraNPCFrameGovernor& GetFrameGovernor() { return FrameGovernor; }
+
+	// ===== NEEDS =====
+	// Needs are evaluated on read against the game clock; the only per-NPC work is a callback when a
+	// need is predicted to cross a threshold, taken from queues ordered by time. Crossings of needs that
+	// only decay are kept in game hours, so a time scale change does not touch them.
+
+	// Called by needs components with their next crossing, in game hours or world seconds; a newer serial
+	// from the same component supersedes it
+	void ScheduleNeedsEvent(ULyraNPCNeedsComponent* Needs, double Time, uint32 Serial, bool bGameClock);
+
+	// Needs whose line mixes game-clock decay with world-time modifiers, re-based when the time scale changes
+	void SetNeedsScaleSensitive(ULyraNPCNeedsComponent* Needs, bool bSensitive);
+
+	// Queued crossings, including superseded ones not swept yet
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Needs")
+	int32 GetQueuedNeedsEventCount() const { return NeedsEvents.Num() + GameClockNeedsEvents.Num(); }
+
+	// Keep every registered NPC's stored need values in per-type arrays owned by the subsystem instead of
+	// one array per component; needs components then evaluate their values from the batch
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Needs")
+	bool bBatchNeedsSimulation = false;
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Needs")
+	int32 GetBatchedNeedsCount() const { return NeedsBatch.Num(); }
+
+	const FLyraNPCNeedsBatch& GetNeedsBatch() const { return NeedsBatch; }
+
+	// ===== VIRTUALIZATION =====
+	// Dormant NPCs far from every viewer are stored as FLyraNPCVirtualRecord data and their actors
+	// destroyed or pooled; they get an actor back when a viewer comes within RehydrationDistance.
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Virtualization")
+	bool bVirtualizeDormantNPCs = false;
+
+	// Dormant NPCs with no viewer this close are virtualized. Keep it above RehydrationDistance so
+	// NPCs near the boundary do not flip back and forth.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Virtualization", meta = (ClampMin = "0.0"))
+	float VirtualizationDistance = 11000.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Virtualization", meta = (ClampMin = "0.0"))
+	float RehydrationDistance = 9000.0f;
+
+	// Seconds between virtualization passes
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Virtualization", meta = (ClampMin = "0.0"))
+	float VirtualizationInterval = 0.25f;
+
+	// Most NPCs virtualized, and most rehydrated, per pass
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Virtualization", meta = (ClampMin = "1"))
+	int32 MaxVirtualizationsPerPass = 16;
+
+	// Spare actors kept hidden for rehydration instead of being destroyed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Virtualization", meta = (ClampMin = "0"))
+	int32 MaxPooledNPCActors = 32;
+
+	// Stores the NPC as a record and destroys or pools its actor
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Virtualization")
+	bool VirtualizeNPC(ALyraNPCCharacter* NPC);
+
+	// Gives a virtual NPC an actor again; returns null if there is no such record
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Virtualization")
+	ALyraNPCCharacter* RehydrateNPC(const FGuid& NPCId);
+
+	// Adds an NPC that starts out virtual, e.g. when populating a world. Returns its id.
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Virtualization")
+	FGuid AddVirtualNPC(const FLyraNPCVirtualRecord& Record);
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Virtualization")
+	bool GetVirtualNPCRecord(const FGuid& NPCId, FLyraNPCVirtualRecord& OutRecord) const;
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Virtualization")
+	int32 GetVirtualNPCCount() const { return VirtualPopulation.Num(); }
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Virtualization")
+	int32 GetPooledNPCActorCount() const { return NPCActorPool.Num(); }
+
+	const FLyraNPCVirtualPopulation& GetVirtualPopulation() const { return VirtualPopulation; }
+
 	// ===== NPC MANAGEMENT =====
 
+	// NPCs register themselves on BeginPlay and unregister on EndPlay
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Management")
 	void RegisterNPC(ALyraNPCCharacter* NPC);
 
@@ -51,7 +301,16 @@ public:
 	void UnregisterNPC(ALyraNPCCharacter* NPC);
 
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
-	int32 GetTotalNPCCount() const { return RegisteredNPCs.Num(); }
+	bool IsNPCRegistered(const ALyraNPCCharacter* NPC) const;
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
+	bool IsNPCHandleValid(FLyraNPCHandle Handle) const { return NPCRegistry.IsValid(Handle); }
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
+	ALyraNPCCharacter* ResolveNPCHandle(FLyraNPCHandle Handle) const;
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
+	int32 GetTotalNPCCount() const { return NPCRegistry.Num(); }
 
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
 	TArray<ALyraNPCCharacter*> GetAllNPCs() const;
@@ -59,23 +318,127 @@ public:
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
 	TArray<ALyraNPCCharacter*> GetNPCsByArchetype(ELyraNPCArchetype Archetype) const;
 
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
+	TArray<ALyraNPCCharacter*> GetNPCsByLifeState(ELyraNPCLifeState LifeState) const;
+
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
 	TArray<ALyraNPCCharacter*> GetNPCsInRadius(FVector Location, float Radius) const;
 
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
+	TArray<ALyraNPCCharacter*> GetNPCsInBox(const FBox& Box) const;
+
+	// Returns up to Count NPCs sorted nearest first (MaxRadius <= 0 means unlimited)
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
+	TArray<ALyraNPCCharacter*> GetNearestNPCs(FVector Location, int32 Count, float MaxRadius = 0.0f) const;
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
+	ALyraNPCCharacter* FindNearestNPC(FVector Location, float MaxRadius = 0.0f) const;
+
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
 	ALyraNPCCharacter* FindNPCById(const FGuid& NPCId) const;
 
+	// Case-insensitive; an exact name match wins over a partial one
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
 	ALyraNPCCharacter* FindNPCByName(const FString& Name) const;
 
+	// NPCs whose name starts with Prefix, in name order (MaxResults <= 0 means unlimited)
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
+	TArray<ALyraNPCCharacter*> FindNPCsByNamePrefix(const FString& Prefix, int32 MaxResults = 0) const;
+
+	// NPCs whose name contains Substring (MaxResults <= 0 means unlimited)
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Management")
+	TArray<ALyraNPCCharacter*> FindNPCsByNameSubstring(const FString& Substring, int32 MaxResults = 0) const;
+
+	// Re-files an NPC in the id and name indices. The identity component calls this itself;
+	// call it after editing the Biography directly.
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Management")
+	void RefreshNPCIdentity(ALyraNPCCharacter* NPC);
+
+	// ===== NATIVE NPC QUERIES =====
+	// Allocation-free forms of the queries above. Buffer overloads reset and fill the caller's array
+	// (pass one with an inline allocator to stay off the heap) and visitors call Func once per result.
+
+	// Every registered NPC. The view aliases internal storage and is invalidated by (un)registration.
+	TArrayView<ALyraNPCCharacter* const> GetNPCView() const { return RegisteredNPCs; }
+
+	void ForEachNPC(TFunctionRef<void(ALyraNPCCharacter*)> Func) const;
+	void ForEachNPCOfArchetype(ELyraNPCArchetype Archetype, TFunctionRef<void(ALyraNPCCharacter*)> Func) const;
+	void ForEachNPCInLifeState(ELyraNPCLifeState LifeState, TFunctionRef<void(ALyraNPCCharacter*)> Func) const;
+
+	// Members of one archetype or life state, in no particular order. Invalidated like GetNPCView.
+	TArrayView<ALyraNPCCharacter* const> GetArchetypeView(ELyraNPCArchetype Archetype) const;
+	TArrayView<ALyraNPCCharacter* const> GetLifeStateView(ELyraNPCLifeState LifeState) const;
+	void ForEachNPCInRadius(const FVector& Location, float Radius, TFunctionRef<void(ALyraNPCCharacter*)> Func) const;
+	void ForEachNPCInBox(const FBox& Box, TFunctionRef<void(ALyraNPCCharacter*)> Func) const;
+
+	// Visits up to Count NPCs nearest first (MaxRadius <= 0 means unlimited)
+	void ForEachNearestNPC(const FVector& Location, int32 Count, float MaxRadius, TFunctionRef<void(ALyraNPCCharacter*)> Func) const;
+
+	template<typename AllocatorType>
+	void GetAllNPCs(TArray<ALyraNPCCharacter*, AllocatorType>& OutNPCs) const
+	{
+		OutNPCs.Reset();
+		OutNPCs.Append(RegisteredNPCs.GetData(), RegisteredNPCs.Num());
+	}
+
+	template<typename AllocatorType>
+	void GetNPCsByArchetype(ELyraNPCArchetype Archetype, TArray<ALyraNPCCharacter*, AllocatorType>& OutNPCs) const
+	{
+		const TArrayView<ALyraNPCCharacter* const> Members = GetArchetypeView(Archetype);
+		OutNPCs.Reset();
+		OutNPCs.Append(Members.GetData(), Members.Num());
+	}
+
+	template<typename AllocatorType>
+	void GetNPCsByLifeState(ELyraNPCLifeState LifeState, TArray<ALyraNPCCharacter*, AllocatorType>& OutNPCs) const
+	{
+		const TArrayView<ALyraNPCCharacter* const> Members = GetLifeStateView(LifeState);
+		OutNPCs.Reset();
+		OutNPCs.Append(Members.GetData(), Members.Num());
+	}
+
+	template<typename AllocatorType>
+	void GetNPCsInRadius(const FVector& Location, float Radius, TArray<ALyraNPCCharacter*, AllocatorType>& OutNPCs) const
+	{
+		OutNPCs.Reset();
+		ForEachNPCInRadius(Location, Radius, [&OutNPCs](ALyraNPCCharacter* NPC) { OutNPCs.Add(NPC); });
+	}
+
+	template<typename AllocatorType>
+	void GetNPCsInBox(const FBox& Box, TArray<ALyraNPCCharacter*, AllocatorType>& OutNPCs) const
+	{
+		OutNPCs.Reset();
+		ForEachNPCInBox(Box, [&OutNPCs](ALyraNPCCharacter* NPC) { OutNPCs.Add(NPC); });
+	}
+
+	template<typename AllocatorType>
+	void GetNearestNPCs(const FVector& Location, int32 Count, float MaxRadius, TArray<ALyraNPCCharacter*, AllocatorType>& OutNPCs) const
+	{
+		OutNPCs.Reset();
+		ForEachNearestNPC(Location, Count, MaxRadius, [&OutNPCs](ALyraNPCCharacter* NPC) { OutNPCs.Add(NPC); });
+	}
+
 	// ===== TASK MANAGEMENT =====
 
+	// Task components register themselves on BeginPlay and unregister on EndPlay
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Tasks")
 	void RegisterTaskActor(ULyraNPCTaskActor* Task);
 
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Tasks")
 	void UnregisterTaskActor(ULyraNPCTaskActor* Task);
 
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Tasks")
+	bool IsTaskRegistered(const ULyraNPCTaskActor* Task) const;
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Tasks")
+	bool IsTaskHandleValid(FLyraNPCTaskHandle Handle) const { return TaskRegistry.IsValid(Handle); }
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Tasks")
+	ULyraNPCTaskActor* ResolveTaskHandle(FLyraNPCTaskHandle Handle) const;
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Tasks")
+	int32 GetTotalTaskCount() const { return TaskRegistry.Num(); }
+
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Tasks")
 	TArray<ULyraNPCTaskActor*> GetAllTasks() const;
 
@@ -85,23 +448,148 @@ public:
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Tasks")
 	TArray<ULyraNPCTaskActor*> GetAvailableTasksForNPC(ALyraNPCCharacter* NPC) const;
 
+	// Best scoring available task, optionally limited to MaxDistance (<= 0 means no limit)
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Tasks")
-	ULyraNPCTaskActor* FindBestTaskForNPC(ALyraNPCCharacter* NPC, FGameplayTag TaskType = FGameplayTag()) const;
+	ULyraNPCTaskActor* FindBestTaskForNPC(ALyraNPCCharacter* NPC, FGameplayTag TaskType = FGameplayTag(), float MaxDistance = 0.0f) const;
 
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Tasks")
 	TArray<ULyraNPCTaskActor*> GetTasksInRadius(FVector Location, float Radius) const;
 
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Tasks")
+	TArray<ULyraNPCTaskActor*> GetTasksOfTypeInRadius(FGameplayTag TaskType, FVector Location, float Radius) const;
+
+	// Re-files a task in the index after its type, priority or needs satisfaction changed at runtime
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Tasks")
+	void RefreshTaskIndex(ULyraNPCTaskActor* Task);
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Stats")
+	FLyraNPCTaskQueryStats GetTaskQueryStats() const { return TaskIndex.GetStats(); }
+
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Stats")
+	void ResetTaskQueryStats() { TaskIndex.ResetStats(); }
+
+	// ===== BATCHED TASK SEARCH =====
+
+	// Queued searches resolved per frame; the rest carry over to the next frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Tasks", meta = (ClampMin = "1"))
+	int32 MaxTaskSearchesPerFrame = 128;
+
+	// Batches of at least this many NPCs are scored on worker threads
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Tasks", meta = (ClampMin = "1"))
+	int32 MinParallelTaskSearchBatch = 16;
+
+	// FindBestTaskForNPC for many NPCs at once: entry i of the result belongs to NPCs[i] (null if nothing suitable)
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Tasks")
+	TArray<ULyraNPCTaskActor*> FindBestTasksForNPCs(const TArray<ALyraNPCCharacter*>& NPCs, FGameplayTag TaskType, float MaxDistance = 0.0f) const;
+
+	// Native form writing into the caller's buffer, which is resized to NPCs.Num()
+	template<typename AllocatorType>
+	void FindBestTasksForNPCs(TArrayView<ALyraNPCCharacter* const> NPCs, const FGameplayTag& TaskType, float MaxDistance, TArray<ULyraNPCTaskActor*, AllocatorType>& OutTasks) const
+	{
+		OutTasks.SetNumUninitialized(NPCs.Num());
+		FLyraNPCTaskSearch::FindBestTasks(TaskIndex, NPCs, TaskType, MaxDistance, OutTasks, MinParallelTaskSearchBatch);
+	}
+
+	// Resolve FindTask searches, queued or immediate, by assignment: each NPC is handed a task already
+	// reserved for it, and no task is given to more NPCs than it has free slots
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Tasks")
+	bool bAssignQueuedTaskSearches = false;
+
+	// Seconds an assigned reservation is held for an NPC that has not started using the task
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "LyraNPC|Tasks", meta = (ClampMin = "0.1"))
+	float TaskReservationTimeout = 30.0f;
+
+	// Solves the batch jointly and reserves each NPC's task (see bAssignQueuedTaskSearches).
+	// Entry i belongs to NPCs[i] and is null if nothing suitable was left.
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Tasks")
+	TArray<ULyraNPCTaskActor*> AssignTasksToNPCs(const TArray<ALyraNPCCharacter*>& NPCs, FGameplayTag TaskType, float MaxDistance = 0.0f);
+
+	// AssignTasksToNPCs for a single NPC: the best task it can still reserve, already reserved for it
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Tasks")
+	ULyraNPCTaskActor* AssignTaskToNPC(ALyraNPCCharacter* NPC, FGameplayTag TaskType, float MaxDistance = 0.0f);
+
+	// Frees the task assigned to NPC if it has not started using it yet
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Tasks")
+	void ReleaseTaskReservation(ALyraNPCCharacter* NPC);
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Stats")
+	FLyraNPCTaskAssignmentStats GetTaskAssignmentStats() const { return AssignmentStats; }
+
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Stats")
+	void ResetTaskAssignmentStats() { AssignmentStats = FLyraNPCTaskAssignmentStats(); }
+
+	// Queues a search that is batched with others of the same type and radius and resolved within the
+	// next few frames. OnComplete runs on the game thread. Returns an id for CancelTaskSearch.
+	uint32 RequestBestTaskForNPC(ALyraNPCCharacter* NPC, const FGameplayTag& TaskType, float MaxDistance, FLyraNPCTaskSearchDelegate OnComplete);
+
+	// Drops a queued search; its callback will not run
+	void CancelTaskSearch(uint32 RequestId);
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Tasks")
+	int32 GetPendingTaskSearchCount() const { return PendingTaskSearches.Num(); }
+
+	// Native access to the task index for callers that want to visit candidates without building arrays
+	const FLyraNPCTaskIndex& GetTaskIndex() const { return TaskIndex; }
+
+	// ===== NATIVE TASK QUERIES =====
+
+	// Every registered task. The view aliases internal storage and is invalidated by (un)registration.
+	TArrayView<ULyraNPCTaskActor* const> GetTaskView() const { return RegisteredTasks; }
+
+	void ForEachTask(TFunctionRef<void(ULyraNPCTaskActor*)> Func) const;
+
+	// Tasks matching TaskType (any type if invalid) within Radius of Location (negative means unlimited)
+	void ForEachTaskOfType(const FGameplayTag& TaskType, const FVector& Location, float Radius, TFunctionRef<void(ULyraNPCTaskActor*)> Func) const;
+
+	void ForEachAvailableTaskForNPC(ALyraNPCCharacter* NPC, TFunctionRef<void(ULyraNPCTaskActor*)> Func) const;
+
+	template<typename AllocatorType>
+	void GetAllTasks(TArray<ULyraNPCTaskActor*, AllocatorType>& OutTasks) const
+	{
+		OutTasks.Reset();
+		OutTasks.Append(RegisteredTasks.GetData(), RegisteredTasks.Num());
+	}
+
+	template<typename AllocatorType>
+	void GetTasksByType(const FGameplayTag& TaskType, TArray<ULyraNPCTaskActor*, AllocatorType>& OutTasks) const
+	{
+		OutTasks.Reset();
+		if (TaskType.IsValid())
+		{
+			ForEachTaskOfType(TaskType, FVector::ZeroVector, -1.0f, [&OutTasks](ULyraNPCTaskActor* Task) { OutTasks.Add(Task); });
+		}
+	}
+
+	template<typename AllocatorType>
+	void GetAvailableTasksForNPC(ALyraNPCCharacter* NPC, TArray<ULyraNPCTaskActor*, AllocatorType>& OutTasks) const
+	{
+		OutTasks.Reset();
+		ForEachAvailableTaskForNPC(NPC, [&OutTasks](ULyraNPCTaskActor* Task) { OutTasks.Add(Task); });
+	}
+
+	template<typename AllocatorType>
+	void GetTasksOfTypeInRadius(const FGameplayTag& TaskType, const FVector& Location, float Radius, TArray<ULyraNPCTaskActor*, AllocatorType>& OutTasks) const
+	{
+		OutTasks.Reset();
+		ForEachTaskOfType(TaskType, Location, FMath::Max(Radius, 0.0f), [&OutTasks](ULyraNPCTaskActor* Task) { OutTasks.Add(Task); });
+	}
+
 	// ===== GLOBAL TIME CONTROL =====
 
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Time")
 	void SetGlobalGameHour(float NewHour);
 
+	// Skips ahead by Hours; the game clock only runs forward, so negative values are ignored
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Time")
 	void AdvanceGlobalTime(float Hours);
 
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Time")
 	void SetTimeScale(float NewScale);
 
+	// Game hours advanced since the world started, ignoring wrap-around and SetGlobalGameHour jumps
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Time")
+	double GetElapsedGameHours() const { return ElapsedGameHours; }
+
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Time")
 	bool IsGlobalNightTime() const;
 
@@ -112,7 +600,9 @@ public:
 	FString GetTimeString() const;
 
 	// ===== STATISTICS =====
+	// Maintained incrementally from the NPCs' change events, so every read is O(1)
 
+	// NPCs controlled by a LyraNPC AI controller at this LOD
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Stats")
 	int32 GetNPCCountByLOD(ELyraNPCAILOD LOD) const;
 
@@ -122,8 +612,26 @@ public:
 	UFUNCTION(BlueprintPure, Category = "LyraNPC|Stats")
 	int32 GetNPCsInCombatCount() const;
 
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Stats")
+	int32 GetNPCCountByAlertLevel(ELyraNPCAlertLevel AlertLevel) const;
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Stats")
+	int32 GetNPCCountByLifeState(ELyraNPCLifeState LifeState) const;
+
+	UFUNCTION(BlueprintPure, Category = "LyraNPC|Stats")
+	int32 GetNPCCountByArchetype(ELyraNPCArchetype Archetype) const;
+
+	// Recounts every statistic from scratch, logs any drift and resyncs the counters. Returns true if nothing drifted.
+	// Also available as the LyraNPC.VerifyStats console command.
+	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Stats")
+	bool VerifyPopulationStats();
+
+	// Rebinds the NPC's LOD statistics to its current controller; called on possession changes
+	void RefreshNPCController(ALyraNPCCharacter* NPC);
+
 	// ===== BATCH OPERATIONS =====
 
+	// Sets the global time scale and clears every NPC's needs time scale override
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Batch")
 	void SetAllNPCsTimeScale(float NewTimeScale);
 
@@ -133,6 +641,7 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Batch")
 	void ResumeAllNPCs();
 
+	// Puts every schedule back on the global clock with no offset
 	UFUNCTION(BlueprintCallable, Category = "LyraNPC|Batch")
 	void SyncAllNPCSchedulesToGlobalTime();
 
@@ -141,15 +650,124 @@ protected:
 	virtual TStatId GetStatId() const override;
 
 private:
-	UPROPERTY()
-	TArray<TWeakObjectPtr<ALyraNPCCharacter>> RegisteredNPCs;
-
-	UPROPERTY()
-	TArray<TWeakObjectPtr<ULyraNPCTaskActor>> RegisteredTasks;
+	// Registries are kept exact by BeginPlay/EndPlay, so no periodic cleanup sweep is needed
+	TLyraNPCRegistry<FLyraNPCHandle, FLyraNPCRegistryEntry> NPCRegistry;
+	TLyraNPCRegistry<FLyraNPCTaskHandle, FLyraNPCTaskRegistryEntry> TaskRegistry;
+
+	// Dense copies of the registries for cache-friendly iteration and views. Raw pointers are safe
+	// because NPCs and tasks always unregister in EndPlay before they are destroyed.
+	TArray<ALyraNPCCharacter*> RegisteredNPCs;
+	TArray<ULyraNPCTaskActor*> RegisteredTasks;
+
+	// Registered NPCs bucketed by location, kept current through their root component's TransformUpdated
+	TLyraNPCSpatialHash<TWeakObjectPtr<ALyraNPCCharacter>> NPCSpatialHash;
+
+	// Registered tasks bucketed by TaskType and location
+	FLyraNPCTaskIndex TaskIndex;
+
+	// Identity lookups, kept current through RefreshNPCIdentity
+	TMap<FGuid, FLyraNPCHandle> NPCIdIndex;
+	FLyraNPCNameIndex NPCNameIndex;
+
+	// Searches waiting for a batch, oldest first, and the slice being resolved this frame
+	TArray<FLyraNPCPendingTaskSearch> PendingTaskSearches;
+	TArray<FLyraNPCPendingTaskSearch> ActiveTaskSearches;
+	uint32 NextTaskSearchId = 1;
+	FLyraNPCTaskAssignmentStats AssignmentStats;
+
+	// Assigned reservations oldest first; entries whose NPC was re-assigned or released since are skipped
+	TArray<FLyraNPCTaskReservation> TaskReservations;
+
+	double ElapsedGameHours = 0.0;
+
+	FLyraNPCLODManager LODManager;
+
+	// LOD changes and broadcasts counted in the current one-second window, and the last window's rates
+	int32 LODChangesInWindow = 0;
+	int32 LODBroadcastsInWindow = 0;
+	float LODRateWindowTime = 0.0f;
+	float LODChangesPerSecond = 0.0f;
+	float LODBroadcastsPerSecond = 0.0f;
+
+	// Scales LyraNPC's work to the per-frame budget
+	FLyraNPCFrameGovernor FrameGovernor;
+
+	// Next NPC to refresh after a governor level change, INDEX_NONE when none is due
+	int32 GovernorRefreshCursor = INDEX_NONE;
+
+	// Predicted need threshold crossings in world seconds and in game hours, the needs tied to the current
+	// time scale, and the scale they were last based on
+	FLyraNPCNeedsEventQueue NeedsEvents;
+	FLyraNPCNeedsEventQueue GameClockNeedsEvents;
+	TSet<TWeakObjectPtr<ULyraNPCNeedsComponent>> ScaleSensitiveNeeds;
+	float NeedsTimeScale = -1.0f;
+
+	// Stored need lines of every registered NPC while bBatchNeedsSimulation is on
+	FLyraNPCNeedsBatch NeedsBatch;
+	bool bNeedsBatchActive = false;
+
+	// NPCs without actors, hidden actors waiting for reuse, and time until the next pass
+	FLyraNPCVirtualPopulation VirtualPopulation;
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<ALyraNPCCharacter>> NPCActorPool;
+	float VirtualizationTimer = 0.0f;
+
+	// Population statistics
+	int32 NPCCountByLOD[static_cast<int32>(ELyraNPCAILOD::MAX)] = {};
+	int32 NPCCountByAlertLevel[static_cast<int32>(ELyraNPCAlertLevel::MAX)] = {};
+	// Sum of every counted wellbeing line's value at time zero and of their rates per world second and
+	// per game hour, so the average at any time is O(1)
+	double WellbeingSum = 0.0;
+	double WellbeingRateSum = 0.0;
+	double WellbeingHourRateSum = 0.0;
+
+	// Membership lists, swap-removed like RegisteredNPCs
+	TArray<ALyraNPCCharacter*> NPCsByLifeState[static_cast<int32>(ELyraNPCLifeState::MAX)];
+	TArray<ALyraNPCCharacter*> NPCsByArchetype[static_cast<int32>(ELyraNPCArchetype::MAX)];
+
+	void UpdateFrameGovernor(float DeltaTime);
+	void ProcessNeedsEvents();
+	void SyncNeedsTimeScale();
+	void RebaseScaleSensitiveNeeds();
+	void SetNeedsBatchActive(bool bActive);
+	void ProcessVirtualization(float DeltaTime);
+	void ReleaseNPCActor(ALyraNPCCharacter* NPC);
+	ALyraNPCCharacter* AcquireNPCActor(const FLyraNPCVirtualRecord& Record);
+
+	void TrackNPCStats(const FLyraNPCHandle& Handle, FLyraNPCRegistryEntry& Entry, ALyraNPCCharacter* NPC);
+	void UntrackNPCStats(FLyraNPCRegistryEntry& Entry, ALyraNPCCharacter* NPC);
+	void BindNPCController(FLyraNPCRegistryEntry& Entry, ALyraNPCCharacter* NPC);
+	void SetCountedLOD(FLyraNPCRegistryEntry& Entry, ELyraNPCAILOD NewLOD);
+	void SetCountedAlertLevel(FLyraNPCRegistryEntry& Entry, ELyraNPCAlertLevel NewAlertLevel);
+	void SetCountedLifeState(FLyraNPCRegistryEntry& Entry, ELyraNPCLifeState NewLifeState);
+	void SetCountedArchetype(FLyraNPCRegistryEntry& Entry, ELyraNPCArchetype NewArchetype);
+	void SetCountedWellbeing(FLyraNPCRegistryEntry& Entry, float NewWellbeing, float NewRate, float NewHourRate);
+
+	// Swap-removes List[Slot] and fixes up the slot of the NPC moved into its place
+	void RemoveFromNPCList(TArray<ALyraNPCCharacter*>& List, int32 FLyraNPCRegistryEntry::* SlotMember, int32& Slot);
+	FLyraNPCRegistryEntry* FindNPCEntry(const ALyraNPCCharacter* NPC);
+
+	UFUNCTION()
+	void HandleNPCAILODChanged(ALyraNPCCharacter* NPC, ELyraNPCAILOD NewLOD);
+
+	UFUNCTION()
+	void HandleNPCAlertLevelChanged(ALyraNPCCharacter* NPC, ELyraNPCAlertLevel NewAlertLevel);
+
+	UFUNCTION()
+	void HandleNPCLifeStateChanged(ALyraNPCCharacter* NPC, ELyraNPCLifeState NewState);
+
+	void HandleNPCWellbeingChanged(float NewWellbeing, float WellbeingPerSecond, float WellbeingPerGameHour, FLyraNPCHandle Handle);
+
+	void IndexNPCIdentity(const FLyraNPCHandle& Handle, FLyraNPCRegistryEntry& Entry, const ALyraNPCCharacter* NPC);
+	void UnindexNPCIdentity(const FLyraNPCHandle& Handle, FLyraNPCRegistryEntry& Entry);
+	TArray<ALyraNPCCharacter*> ResolveNPCHandles(const TArray<FLyraNPCHandle>& Handles) const;
+
+	void OnNPCTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+	void OnTaskTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
 
 	void UpdateGlobalTime(float DeltaTime);
-	void CleanupInvalidReferences();
-
-	float TimeSinceLastCleanup = 0.0f;
-	float CleanupInterval = 10.0f;
+	void ProcessTaskSearches();
+	void AssignAndReserveTasks(TArrayView<ALyraNPCCharacter* const> NPCs, const FGameplayTag& TaskType, float MaxDistance, TArrayView<ULyraNPCTaskActor*> OutTasks);
+	void ReleaseAssignedTask(FLyraNPCRegistryEntry& Entry, ALyraNPCCharacter* NPC);
+	void ExpireTaskReservations();
 };
@@ -23,9 +23,15 @@ class LYRANPC_API ULyraNPCTaskActor : public USceneComponent
 public:
 	ULyraNPCTaskActor();
 
+	// Score bonus per point of need satisfaction at full deficit
+	static constexpr float NeedScoreScale = 0.1f;
+
+	// Distance that costs one point of score
+	static constexpr float DistancePenaltyScale = 10000.0f;
+
 	// ===== TASK CONFIGURATION =====
 
-	// Unique identifier for this task type
+	// Unique identifier for this task type (use SetTaskType at runtime to keep the task index in sync)
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Task|Identity")
 	FGameplayTag TaskType;
 
@@ -75,8 +81,8 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Task|Behavior")
 	float MaxDuration = 300.0f;
 
-	// Priority of this task (higher = more likely to be chosen)
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Task|Behavior")
+	// Priority of this task (higher = more likely to be chosen; use SetTaskPriority at runtime to keep the task index in sync)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Task|Behavior")
 	float TaskPriority = 1.0f;
 
 	// Can task be interrupted?
@@ -85,8 +91,9 @@ public:
 
 	// ===== NEEDS SATISFACTION =====
 
-	// Which needs this task satisfies and by how much (per minute of use)
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Task|Effects")
+	// Which needs this task satisfies and by how much (per minute of use; use SetNeedSatisfaction at
+	// runtime to keep the task index in sync)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Task|Effects")
 	TMap<ELyraNPCNeedType, float> NeedsSatisfaction;
 
 	// ===== POSITIONING =====
@@ -199,12 +206,37 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Task|Utility")
 	void SetOwner(const FGuid& NPCId);
 
+	UFUNCTION(BlueprintCallable, Category = "Task|Utility")
+	void SetTaskType(FGameplayTag NewTaskType);
+
+	UFUNCTION(BlueprintCallable, Category = "Task|Utility")
+	void SetTaskPriority(float NewPriority);
+
+	// Sets how much of a need the task satisfies per minute of use; 0 removes the need
+	UFUNCTION(BlueprintCallable, Category = "Task|Utility")
+	void SetNeedSatisfaction(ELyraNPCNeedType NeedType, float ValuePerMinute);
+
+	// Handle into the world subsystem's task registry (unset while unregistered)
+	UFUNCTION(BlueprintPure, Category = "Task|Utility")
+	FLyraNPCTaskHandle GetTaskHandle() const { return RegistryHandle; }
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 private:
+	friend class ULyraNPCWorldSubsystem;
+
+	// Assigned by ULyraNPCWorldSubsystem on registration
+	UPROPERTY(VisibleInstanceOnly, Transient, Category = "Task|State")
+	FLyraNPCTaskHandle RegistryHandle;
+
 	void UpdateAvailability();
+
+	// Re-files the task in the world subsystem's task index after its type or scoring data changed
+	void RefreshTaskIndex();
+
 	bool CheckArchetypeAccess(ELyraNPCArchetype Archetype) const;
 	bool CheckTagAccess(const FGameplayTagContainer& NPCTags) const;
 };